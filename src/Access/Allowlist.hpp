@@ -0,0 +1,97 @@
+#ifndef ACCESS_ALLOWLIST_INCLUDED_HPP
+#define ACCESS_ALLOWLIST_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include "KeySet.hpp"
+
+namespace dps { namespace access {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// In-RAM set of card UIDs (see KeySet for the key layout and the lookup).
+// Loading: add() appends unsorted, commit() sorts and removes duplicates. Until then lookups only see the previously committed entries.
+// @tparam ShortCapacity  max. number of 4 byte UIDs
+// @tparam LongCapacity   max. number of 7/10 byte UIDs
+template <size_t ShortCapacity, size_t LongCapacity>
+class Allowlist
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  bool contains(uint8_t const* uid, size_t size) const
+  {
+    return keys().contains(uid, size);
+  }
+
+  // view of the committed entries
+  KeySet keys() const
+  {
+    return {Short, ShortSize, Long, LongSize};
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // stages a UID; returns false if it has an invalid size or the list is full
+  bool add(uint8_t const* uid, size_t size)
+  {
+    if (KeySet::isShort(size))
+    {
+      return (ShortFill < ShortCapacity) && ((Short[ShortFill++] = KeySet::shortKey(uid)), true);
+    }
+    if (KeySet::isValid(size))
+    {
+      return (LongFill < LongCapacity) && ((Long[LongFill++] = KeySet::longKey(uid, size)), true);
+    }
+    return false;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // makes the staged UIDs visible to lookups
+  void commit()
+  {
+    ShortSize = ShortFill = sortUnique(Short, ShortFill);
+    LongSize  = LongFill  = sortUnique(Long,  LongFill);
+  }
+
+  void clear()
+  {
+    ShortSize = ShortFill = 0;
+    LongSize  = LongFill  = 0;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  size_t size() const      { return ShortSize + LongSize; }
+  bool   empty() const     { return !size();              }
+  size_t shortSize() const { return ShortSize;            }
+  size_t longSize() const  { return LongSize;             }
+  size_t pending() const   { return (ShortFill - ShortSize) + (LongFill - LongSize); }
+
+  static constexpr size_t capacity() { return ShortCapacity + LongCapacity; }
+  static constexpr size_t bytes()    { return sizeof(uint32_t) * ShortCapacity + sizeof(uint64_t) * LongCapacity; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  template <typename TKey>
+  static size_t sortUnique(TKey* keys, size_t size)
+  {
+    std::sort(keys, keys + size);
+    return std::unique(keys, keys + size) - keys;
+  }
+
+  uint32_t Short[ShortCapacity];
+  uint64_t Long[LongCapacity];
+  size_t   ShortSize = 0;   // committed
+  size_t   ShortFill = 0;   // committed + staged
+  size_t   LongSize  = 0;
+  size_t   LongFill  = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::access
+
+#endif // ACCESS_ALLOWLIST_INCLUDED_HPP
@@ -0,0 +1,170 @@
+#ifndef ACCESS_FLASH_REGION_INCLUDED_HPP
+#define ACCESS_FLASH_REGION_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+#include <esp_task_wdt.h>
+#else
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// label of the data partition holding the credential snapshot (see partitions.csv)
+#ifndef DPS_CREDENTIALS_PARTITION
+#define DPS_CREDENTIALS_PARTITION "creds"
+#endif
+
+// host builds: file standing in for the partition and its size
+#ifndef DPS_CREDENTIALS_FILE
+#define DPS_CREDENTIALS_FILE "credentials.bin"
+#endif
+
+#ifndef DPS_CREDENTIALS_FILE_SIZE
+#define DPS_CREDENTIALS_FILE_SIZE 0x20000
+#endif
+
+namespace dps { namespace access {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Flash storage that is read through a memory mapping and written with erase/program.
+// Target: a data partition, mapped with esp_partition_mmap (the IDF flushes the cache of mapped ranges after writes, so the mapping stays valid).
+// Host:   a file of the same layout, mapped with mmap.
+class FlashRegion
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : size_t
+  {
+    SectorSize = 0x1000,   // erase granularity
+  };
+
+  FlashRegion()                              = default;
+  FlashRegion(FlashRegion const&)            = delete;
+  FlashRegion& operator=(FlashRegion const&) = delete;
+
+  ~FlashRegion()
+  {
+#ifdef ESP_PLATFORM
+    if (Data)
+    {
+      esp_partition_munmap(Mapping);
+    }
+#else
+    if (Data)
+    {
+      munmap(const_cast<uint8_t*>(Data), Size);
+    }
+    if (File >= 0)
+    {
+      ::close(File);
+    }
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool open()
+  {
+#ifdef ESP_PLATFORM
+    Partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, DPS_CREDENTIALS_PARTITION);
+    if (!Partition)
+    {
+      return false;
+    }
+
+    void const* data = nullptr;
+    if (esp_partition_mmap(Partition, 0, Partition->size, SPI_FLASH_MMAP_DATA, &data, &Mapping) != ESP_OK)
+    {
+      return false;
+    }
+    Data = static_cast<uint8_t const*>(data);
+    Size = Partition->size;
+#else
+    File = ::open(DPS_CREDENTIALS_FILE, O_RDWR | O_CREAT, 0644);
+    struct stat info;
+    if ((File < 0) || (fstat(File, &info) != 0))
+    {
+      return false;
+    }
+    if ((info.st_size < DPS_CREDENTIALS_FILE_SIZE) && (ftruncate(File, DPS_CREDENTIALS_FILE_SIZE) != 0))
+    {
+      return false;
+    }
+
+    void* data = mmap(nullptr, DPS_CREDENTIALS_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+    if (data == MAP_FAILED)
+    {
+      return false;
+    }
+    Data = static_cast<uint8_t const*>(data);
+    Size = DPS_CREDENTIALS_FILE_SIZE;
+#endif
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // offset and size have to be multiples of SectorSize.
+  // Erased sector by sector (typ. 45 ms, up to ~400 ms each, the flash cache and with it every task is stalled meanwhile): the other tasks get
+  // to run and the calling task feeds its watchdog in between.
+  bool erase(size_t offset, size_t size)
+  {
+#ifdef ESP_PLATFORM
+    for (size_t sector = offset; sector < offset + size; sector += SectorSize)
+    {
+      if (esp_partition_erase_range(Partition, sector, SectorSize) != ESP_OK)
+      {
+        return false;
+      }
+      esp_task_wdt_reset();
+    }
+    return true;
+#else
+    memset(const_cast<uint8_t*>(Data) + offset, 0xFF, size);
+    return msync(const_cast<uint8_t*>(Data), Size, MS_SYNC) == 0;
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // programs previously erased bytes
+  bool write(size_t offset, void const* data, size_t size)
+  {
+#ifdef ESP_PLATFORM
+    return esp_partition_write(Partition, offset, data, size) == ESP_OK;
+#else
+    memcpy(const_cast<uint8_t*>(Data) + offset, data, size);
+    return msync(const_cast<uint8_t*>(Data), Size, MS_SYNC) == 0;
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint8_t const* data() const   { return Data;            }
+  size_t         size() const   { return Size;            }
+  bool           isOpen() const { return Data != nullptr; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  uint8_t const*             Data      = nullptr;
+  size_t                     Size      = 0;
+#ifdef ESP_PLATFORM
+  esp_partition_t const*     Partition = nullptr;
+  spi_flash_mmap_handle_t    Mapping   = 0;
+#else
+  int                        File      = -1;
+#endif
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::access
+
+#endif // ACCESS_FLASH_REGION_INCLUDED_HPP
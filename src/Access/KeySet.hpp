@@ -0,0 +1,89 @@
+#ifndef ACCESS_KEY_SET_INCLUDED_HPP
+#define ACCESS_KEY_SET_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace dps { namespace access {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Read-only view of a set of card UIDs stored as two sorted key arrays, wherever they live (RAM or memory mapped flash).
+// 4 byte UIDs (the common case) are uint32 keys, 7 and 10 byte UIDs uint64 keys with the UID size in the top byte; 10 byte UIDs are folded into
+// 56 bits by a hash, so two of them could in theory collide (2^-56).
+// Lookup is a branch-free binary search (the loop body compiles to a conditional move), ~log2(n) iterations with no mispredictions.
+struct KeySet
+{
+  uint32_t const* Short     = nullptr;
+  size_t          ShortSize = 0;
+  uint64_t const* Long      = nullptr;
+  size_t          LongSize  = 0;
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool contains(uint8_t const* uid, size_t size) const
+  {
+    return isShort(size) ? search(Short, ShortSize, shortKey(uid))
+                         : search(Long,  LongSize,  longKey(uid, size));
+  }
+
+  size_t size() const  { return ShortSize + LongSize; }
+  bool   empty() const { return !size();              }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  static bool isValid(size_t size) { return (size == 4) || (size == 7) || (size == 10); }
+  static bool isShort(size_t size) { return size == 4; }
+
+  static uint32_t shortKey(uint8_t const* uid)
+  {
+    return (uint32_t(uid[0]) << 24) | (uint32_t(uid[1]) << 16) | (uint32_t(uid[2]) << 8) | uid[3];
+  }
+
+  // size in the top byte keeps 7 and 10 byte UIDs apart
+  static uint64_t longKey(uint8_t const* uid, size_t size)
+  {
+    uint64_t key = 0;
+    if (size <= 7)
+    {
+      for (size_t i = 0; i < size; ++i)
+      {
+        key = (key << 8) | uid[i];
+      }
+    }
+    else
+    {
+      key = 14695981039346656037ull;   // FNV-1a 64
+      for (size_t i = 0; i < size; ++i)
+      {
+        key = (key ^ uid[i]) * 1099511628211ull;
+      }
+    }
+    return (uint64_t(size) << 56) | (key & 0x00FFFFFFFFFFFFFFull);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  template <typename TKey>
+  static bool search(TKey const* keys, size_t size, TKey key)
+  {
+    if (!size)
+    {
+      return false;
+    }
+
+    TKey const* base = keys;
+    while (size > 1)
+    {
+      size_t half = size / 2;
+      base        = (base[half] <= key) ? (base + half) : base;
+      size       -= half;
+    }
+    return *base == key;
+  }
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::access
+
+#endif // ACCESS_KEY_SET_INCLUDED_HPP
@@ -0,0 +1,295 @@
+#ifndef ACCESS_SNAPSHOT_INCLUDED_HPP
+#define ACCESS_SNAPSHOT_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "KeySet.hpp"
+#include "FlashRegion.hpp"
+#include "Protocol/Crc32.hpp"
+
+namespace dps { namespace access {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Persistent credential set in flash, used in place through the memory mapping (nothing is copied into RAM).
+// The region is split into two slots. Each holds one generation:
+//
+//   [Header][uint32 short keys, sorted][padding to 8][uint64 long keys, sorted]
+//   0       HeaderSpace                              LongOffset
+//
+// A slot is valid if magic, version and both CRCs match; the valid slot with the highest generation is the active one.
+// Updates are written to the other slot: erase (only the sectors the new generation occupies), keys, header last. The header is the commit point, so a crash or power loss at any time
+// leaves either the old generation (new header missing or not matching) or the new one.
+class Snapshot
+{
+  struct Header
+  {
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t Size;          // sizeof(Header)
+    uint32_t Generation;
+    uint32_t ShortCount;
+    uint32_t LongCount;
+    uint32_t LongOffset;    // from the slot start
+    uint32_t PayloadCrc;    // HeaderSpace .. end of the long keys
+    uint32_t HeaderCrc;     // everything above
+  };
+
+  enum : uint32_t
+  {
+    Magic       = 0x43535044,   // "DPSC"
+    Version     = 1,
+    HeaderSpace = 64,
+    Chunk       = 256,          // write buffer
+  };
+
+  static_assert(sizeof(Header) <= HeaderSpace, "header does not fit");
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  // maps the flash region and selects the newest valid generation; false if there is none (or no region)
+  bool open()
+  {
+    if (!Region.open())
+    {
+      return false;
+    }
+    SlotSize = (Region.size() / 2) & ~(FlashRegion::SectorSize - 1);
+
+    Header a, b;
+    bool   validA = load(0, a);
+    bool   validB = load(1, b);
+    if (validA && (!validB || (a.Generation > b.Generation)))
+    {
+      select(0, a);
+    }
+    else if (validB)
+    {
+      select(1, b);
+    }
+    return valid();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // stores (base + add) - remove as 'generation' and makes it the active one. All sets have to be sorted and free of duplicates;
+  // base may be keys() itself. Blocks for the flash erase/write: one sector erase (typ. 45 ms, up to ~400 ms) per 4 KiB of payload, e.g.
+  // ~0.5 s typ. for 10000 short keys, see FlashRegion::erase().
+  // Returns false if the region is not available, 'generation' is not newer than the active one (open() would go back to the higher one
+  // after a reboot), the result does not fit or writing failed - the active generation is unchanged then.
+  bool write(uint32_t generation, KeySet const& base, KeySet const& add, KeySet const& remove)
+  {
+    if (!Region.isOpen() || (valid() && (generation <= Generation)))
+    {
+      return false;
+    }
+
+    size_t slot   = (Active == 0) ? 1 : 0;
+    size_t offset = slot * SlotSize;
+
+    Header header   = {};
+    header.Magic      = Magic;
+    header.Version    = Version;
+    header.Size       = sizeof(Header);
+    header.Generation = generation;
+    header.ShortCount = merge(base.Short, base.ShortSize, add.Short, add.ShortSize, remove.Short, remove.ShortSize, [](uint32_t) {});
+    header.LongCount  = merge(base.Long,  base.LongSize,  add.Long,  add.LongSize,  remove.Long,  remove.LongSize,  [](uint64_t) {});
+    header.LongOffset = align(HeaderSpace + header.ShortCount * sizeof(uint32_t));
+    size_t end = header.LongOffset + header.LongCount * sizeof(uint64_t);
+    if (end > SlotSize)
+    {
+      return false;
+    }
+
+    // the rest of the slot may hold stale data, it is not covered by the payload CRC
+    if (!Region.erase(offset, (end + FlashRegion::SectorSize - 1) & ~size_t(FlashRegion::SectorSize - 1)))
+    {
+      return false;
+    }
+
+    Writer writer(Region, offset + HeaderSpace);
+    merge(base.Short, base.ShortSize, add.Short, add.ShortSize, remove.Short, remove.ShortSize, [&](uint32_t key) { writer.put(key); });
+    writer.pad(offset + header.LongOffset);
+    merge(base.Long,  base.LongSize,  add.Long,  add.LongSize,  remove.Long,  remove.LongSize,  [&](uint64_t key) { writer.put(key); });
+    if (!writer.flush())
+    {
+      return false;
+    }
+
+    header.PayloadCrc = writer.crc();
+    header.HeaderCrc  = protocol::Crc32::compute(&header, offsetof(Header, HeaderCrc));
+    if (!Region.write(offset, &header, sizeof(header)))
+    {
+      return false;
+    }
+
+    // read back through the mapping, i.e. exactly what the next boot will see
+    Header stored;
+    if (!load(slot, stored))
+    {
+      return false;
+    }
+    select(slot, stored);
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool          valid() const      { return Active >= 0; }
+  // 0 without a valid generation
+  uint32_t      generation() const { return Generation;  }
+  KeySet const& keys() const       { return Keys;        }
+  int           slot() const       { return Active;      }
+
+  // max. payload per slot, 4 bytes per short and 8 per long key
+  size_t        capacity() const   { return SlotSize ? (SlotSize - HeaderSpace) : 0; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // buffered, CRC'ing sequential writer
+  class Writer
+  {
+  public:
+    Writer(FlashRegion& region, size_t offset) : Region(region), Offset(offset) {}
+
+    template <typename TKey>
+    void put(TKey key)
+    {
+      append(&key, sizeof(key));
+    }
+
+    // zero fill up to 'offset'
+    void pad(size_t offset)
+    {
+      static uint8_t const Zero[8] = {};
+      while (Offset + Fill < offset)
+      {
+        size_t n = offset - (Offset + Fill);
+        append(Zero, (n < sizeof(Zero)) ? n : sizeof(Zero));
+      }
+    }
+
+    bool flush()
+    {
+      if (Fill)
+      {
+        Ok      = Ok && Region.write(Offset, Buffer, Fill);
+        Crc     = protocol::Crc32::compute(Buffer, Fill, Crc);
+        Offset += Fill;
+        Fill    = 0;
+      }
+      return Ok;
+    }
+
+    uint32_t crc() const { return Crc; }
+
+  private:
+    void append(void const* data, size_t size)
+    {
+      if (Fill + size > sizeof(Buffer))
+      {
+        flush();
+      }
+      memcpy(Buffer + Fill, data, size);
+      Fill += size;
+    }
+
+    FlashRegion& Region;
+    size_t       Offset;
+    size_t       Fill   = 0;
+    uint32_t     Crc    = 0;
+    bool         Ok     = true;
+    uint8_t      Buffer[Chunk];
+  };
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // emits the sorted union of a and b without the keys in r; returns the number of keys emitted
+  template <typename TKey, typename TOut>
+  static size_t merge(TKey const* a, size_t na, TKey const* b, size_t nb, TKey const* r, size_t nr, TOut&& out)
+  {
+    size_t i = 0, j = 0, k = 0, n = 0;
+    while ((i < na) || (j < nb))
+    {
+      TKey key;
+      if ((j == nb) || ((i < na) && (a[i] < b[j])))
+      {
+        key = a[i++];
+      }
+      else if ((i == na) || (b[j] < a[i]))
+      {
+        key = b[j++];
+      }
+      else
+      {
+        key = a[i++];
+        ++j;
+      }
+
+      while ((k < nr) && (r[k] < key))
+      {
+        ++k;
+      }
+      if ((k < nr) && (r[k] == key))
+      {
+        continue;
+      }
+      out(key);
+      ++n;
+    }
+    return n;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool load(size_t slot, Header& header) const
+  {
+    uint8_t const* base = Region.data() + slot * SlotSize;
+    memcpy(&header, base, sizeof(header));
+
+    if ((header.Magic != Magic) || (header.Version != Version) || (header.Size != sizeof(Header)) ||
+        (protocol::Crc32::compute(&header, offsetof(Header, HeaderCrc)) != header.HeaderCrc))
+    {
+      return false;
+    }
+
+    // bounds before touching the payload, counts are checked against the slot size to rule out overflows
+    if ((header.ShortCount > SlotSize / sizeof(uint32_t)) || (header.LongCount > SlotSize / sizeof(uint64_t)) ||
+        (header.LongOffset != align(HeaderSpace + header.ShortCount * sizeof(uint32_t))) ||
+        (header.LongOffset + header.LongCount * sizeof(uint64_t) > SlotSize))
+    {
+      return false;
+    }
+
+    size_t end = header.LongOffset + header.LongCount * sizeof(uint64_t);
+    return protocol::Crc32::compute(base + HeaderSpace, end - HeaderSpace) == header.PayloadCrc;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void select(size_t slot, Header const& header)
+  {
+    uint8_t const* base = Region.data() + slot * SlotSize;
+
+    Keys.Short     = reinterpret_cast<uint32_t const*>(base + HeaderSpace);
+    Keys.ShortSize = header.ShortCount;
+    Keys.Long      = reinterpret_cast<uint64_t const*>(base + header.LongOffset);
+    Keys.LongSize  = header.LongCount;
+    Generation     = header.Generation;
+    Active         = static_cast<int>(slot);
+  }
+
+  static constexpr size_t align(size_t offset) { return (offset + 7) & ~size_t(7); }
+
+  FlashRegion Region;
+  size_t      SlotSize   = 0;
+  int         Active     = -1;
+  uint32_t    Generation = 0;
+  KeySet      Keys;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::access
+
+#endif // ACCESS_SNAPSHOT_INCLUDED_HPP
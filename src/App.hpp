@@ -2,10 +2,28 @@
 #define APP_INCLUDED_HPP
 
 #include <ArduinoJson.hpp>
+#include <esp_task_wdt.h>
 #include "LedRing/LedRing.hpp"
-#include "Rfid/Reader.hpp"
-#include <sstream>
-#include <iomanip>
+#include "Rfid/ReaderSet.hpp"
+#include "Rfid/PollPolicy.hpp"
+#include "Input/Pir.hpp"
+#include "Input/InputScanner.hpp"
+#include "Access/Allowlist.hpp"
+#include "Access/Snapshot.hpp"
+#include "Rtos/Wakeup.hpp"
+#include "Rtos/SpscQueue.hpp"
+#include "Rtos/Task.hpp"
+#include "Stats/LoopStats.hpp"
+#include "Trace/Trace.hpp"
+#include "Delta/Deadline.hpp"
+#include "Protocol/LineReader.hpp"
+#include "Protocol/Frame.hpp"
+#include "Protocol/Hex.hpp"
+#include "Protocol/TxBuffer.hpp"
+#include "Protocol/NameMap.hpp"
+#include "Protocol/ClockSync.hpp"
+#include "Stats/Histogram.hpp"
+#include <string_view>
 
 namespace dps {
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
@@ -20,52 +38,191 @@ class App
     S1_Pin      = 34,
     S2_Pin      = 35,
     S3_Pin      = 32,
+
+    Spi_Sck     = 14,
+    Spi_Miso    = 12,
+    Spi_Mosi    = 13,
+    Inside_Ss   = 25,
+    Inside_Rst  = 26,
+    Inside_Irq  = 27,
+    Outside_Ss  = 5,
+    Outside_Rst = 17,
+    Outside_Irq = 4,
+  };
+
+  enum
+  {
+    RfidCore    = 0,
+    RenderCore  = 1,
+    QueueDepth  = 8,
+    LineLength  = 512,
+    AllowShort  = 10240,  // 4 byte UIDs (40 KiB)
+    AllowLong   = 1024,   // 7/10 byte UIDs (8 KiB)
+    DeltaSize   = 64,     // UIDs per add/remove list of a delta batch
+    TxCapacity  = 2048,
+  };
+
+  // wire format of all messages; JSON lines by default, switched with {"action":"mode","mode":"binary"|"json"}
+  enum class Mode : uint8_t
+  {
+    Json,
+    Binary,   // MessagePack bodies in COBS frames with CRC16, see Protocol/Frame.hpp
+  };
+
+  // outcome of a command, reported in the ack/nack of commands carrying a "seq"
+  enum class Result : uint8_t
+  {
+    Ok,
+    Unknown,   // no such action
+    Invalid,   // bad or missing arguments, not available in this mode
+    Busy,      // queue full, retry later
+    Full,      // no space left
+  };
+
+  enum
+  {
+    NrResults = 5,
   };
 
-  using JsonDoc = ArduinoJson::StaticJsonDocument<512>;
+  static char const* name(Result result)
+  {
+    static char const* const Names[NrResults] = { "ok", "unknown", "invalid", "busy", "full" };
+    return Names[static_cast<size_t>(result)];
+  }
+
+  // tag arrival/removal, stamped by the RFID task
+  using TagEvent = rfid::TagEvent;
+
+  // both MFRC522 on one SPI bus, index 0 = inside
+  using TReaders = rfid::ReaderSet<rfid::SpiBus<Spi_Sck, Spi_Miso, Spi_Mosi>,
+                                   rfid::Reader<Inside_Ss,  Inside_Rst,  Inside_Irq>,
+                                   rfid::Reader<Outside_Ss, Outside_Rst, Outside_Irq>>;
+
+  static char const* readerName(size_t reader)
+  {
+    static char const* const Names[TReaders::Count] = { "inside", "outside" };
+    return Names[reader];
+  }
+
+  // S1..S3, bit i of the scanner state is input i
+  using TInputs = input::InputScanner<input::GpioInputs<S1_Pin, S2_Pin, S3_Pin>>;
+
+  static char const* inputName(size_t input)
+  {
+    static char const* const Names[] = { "door", "exit", "tamper" };
+    return Names[input];
+  }
+
+  using JsonDoc  = ArduinoJson::StaticJsonDocument<512>;
+  using StatsDoc = ArduinoJson::StaticJsonDocument<1024>;
+  using THandler = Result (App::*)(JsonDoc const& msg);
 
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
   enum
   {
-    Polling_ms = 10,
+    MaxSleep_ms  = 100,
+    UartRxBuffer = 1024,  // driver side RX ring (set before Serial.begin())
+    TxPoll_ms    = 2,     // sleep while output is waiting for UART buffer space
+    UartTxBuffer = 1024,  // driver side TX ring, emptied by the UART interrupt (set before Serial.begin())
+    TraceChunk   = 512,   // trace dump bytes between watchdog feeds (~45 ms at 115200 baud)
   };
 
-  App() : Ring(Led_DIn)
+  App() : Ring(Led_DIn), Readers(RfidWake), Presence(PIR_Pin, Wake), Inputs(Wake)
   {
     Ring.setBrightness(100);
     delay(500);
 
-    pinMode(PIR_Pin, INPUT);
+    Serial.onReceive([this] { Wake.notify(); });
+
+    // newest stored generation, decisions use it right away
+    Credentials.open();
+
+    // nobody there until the PIR says so
+    Readers.setRearm(Polling.interval());
+
+    RfidTask  .start("rfid",   RfidCore,   rfidTask,   this);
+    RenderTask.start("render", RenderCore, renderTask, this);
   }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // protocol task: serial commands, PIR, tag events
   void operator()()
   {
-    common::delta::TimeDelta<>::tick(Polling_ms);
+    {
+      trace::Span span(trace::Id::Protocol);
 
-    handleUsart();
+      {
+        auto        probe = Stats.measure(stats::Stage::Usart);
+        trace::Span span(trace::Id::Usart);
+        handleUsart();
+      }
 
-    {
-      auto pir = digitalRead(PIR_Pin);
-      if (pir != PirActive)
       {
-        Serial.print(pir);
-        PirActive = pir;
-        Ring = pir ? "activate" : "deactivate";
+        auto              probe = Stats.measure(stats::Stage::Pir);
+        trace::Span       span(trace::Id::Pir);
+        input::Pir::Event presence;
+        if (Presence(presence))
+        {
+          auto doc      = createDoc("pir");
+          doc["active"] = presence.Active;
+          stamp(doc, presence.Time_us);
+          send(doc);
+          show(presence.Active ? led::LedRing::Effect::Activate : led::LedRing::Effect::Deactivate);
+
+          if (Polling.presence(presence.Active))
+          {
+            applyPolling();
+          }
+        }
+        if (Polling())
+        {
+          applyPolling();
+        }
+      }
+
+      {
+        auto            probe = Stats.measure(stats::Stage::Inputs);
+        trace::Span     span(trace::Id::Inputs);
+        TInputs::Change change;
+        if (Inputs(change))
+        {
+          handleInputs(change);
+        }
+      }
+
+      TagEvent tag;
+      while (Tags.pop(tag))
+      {
+        auto        probe = Stats.measure(stats::Stage::Uid);
+        trace::Span span(trace::Id::Uid);
+        handleUid(tag);
+      }
+
+      rfid::Inventory inventory;
+      while (Inventories.pop(inventory))
+      {
+        auto        probe = Stats.measure(stats::Stage::Uid);
+        trace::Span span(trace::Id::Uid);
+        handleInventory(inventory);
+      }
+
+      rfid::Report report;
+      while (ReaderReports.pop(report))
+      {
+        reportReader(report);
       }
     }
-    
-    auto uid = Reader();
-    if (uid)
-    {
-      handleUid(*uid);
-      Ring = "pass";
-    }
 
-    Ring();
-    delay(Polling_ms);
+    Tx.drain(Serial);
+
+    // sleep until an event (UART RX, PIR edge, tag from the RFID task) or a pending PIR/polling decision, poll while output is pending
+    common::delta::Deadline next(Tx.empty() ? MaxSleep_ms : TxPoll_ms);
+    next.at(Presence.due());
+    next.at(Polling.due());
+    next.at(Inputs.due());
+    Wake.wait(next.remaining());
   }
 
 //==============================================================================================================================================================
@@ -73,78 +230,870 @@ private:
 //==============================================================================================================================================================
   void handleUsart()
   {
-    while (Serial.available()) 
+    // the echo of a line is a message of its own, so a full buffer costs either the echo or the reply, each counted
+    InputBuffer.poll(Serial, Tx,
+                     [this](char* line, size_t length) { Tx.commit(); handleLine(line, length); },
+                     [this]
+                     {
+                       auto doc     = createDoc("error");
+                       doc["error"] = "overlong";
+                       send(doc);
+                     });
+    Tx.commit();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // parses one command line (JSON) or frame (binary) in place; string fields of msg point into the line buffer
+  // commands with a "seq" are answered by {"action":"ack"|"nack","seq":..,"result":..,"us":..,"credit":..}, see acknowledge()
+  void handleLine(char* line, size_t length)
+  {
+    Received_us = now();
+
+    JsonDoc                           msg;
+    ArduinoJson::DeserializationError error;
+
+    if (Format == Mode::Binary)
+    {
+      if (!length)
+      {
+        return;
+      }
+      length = protocol::unframe(reinterpret_cast<uint8_t*>(line), length);
+      if (!length)
+      {
+        auto doc     = createDoc("error");
+        doc["error"] = "frame";
+        send(doc);
+        return;
+      }
+      error = deserializeMsgPack(msg, line, length);
+    }
+    else
     {
-      auto c = Serial.read();
-      Serial.write(c);
+      error = deserializeJson(msg, line, length);
+    }
 
-      if (c != '\n')
+    if (error == ArduinoJson::DeserializationError::Ok) 
+    {          
+      // to add an action, add a handler and register it here
+      static constexpr auto Actions = protocol::makeNameMap<THandler>({
+        { "set",    &App::setFromJson },
+        { "mode",   &App::setMode     },
+        { "reboot", &App::reboot      },
+        { "stats",  &App::reportStats },
+        { "trace",  &App::dumpTrace   },
+        { "ping",   &App::ping        },
+        { "sync",   &App::sync        },
+        { "rtt",    &App::reportRtt   },
+        { "allow",  &App::allow       },
+        { "delta",  &App::delta       },
+      });
+
+      THandler handler;
+      Result   result = Actions.find(msg["action"] | "", handler) ? (this->*handler)(msg) : Result::Unknown;
+
+      if (msg.containsKey("seq"))
       {
-        // Zeichen hinzufügen
-        InputBuffer += c;
+        acknowledge(msg["seq"], result);
       }
-      else
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Commands are processed and acknowledged strictly in order. 'credit' is the number of bytes the host may send beyond the end of the
+  // acknowledged command without overrunning the receive path, so it can pipeline commands up to that window. Only the UART driver buffer
+  // counts: the line buffer takes bytes only while this task polls, a busy task leaves everything else to the driver.
+  void acknowledge(uint32_t seq, Result result)
+  {
+    auto doc      = createDoc((result == Result::Ok) ? "ack" : "nack");
+    doc["seq"]    = seq;
+    doc["result"] = name(result);
+    doc["us"]     = static_cast<uint32_t>(now() - Received_us);
+    doc["credit"] = UartRxBuffer;
+    send(doc);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // first half of a clock exchange: {"action":"ping","t0":host_us} -> {"action":"pong","t0":..,"t1":..,"t2":..}
+  Result ping(JsonDoc const& msg)
+  {
+    auto doc  = createDoc("pong");
+    doc["t0"] = msg["t0"].as<uint64_t>();
+    doc["t1"] = Received_us;
+    doc["t2"] = now();
+    send(doc);
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // second half: the host returns all four timestamps ("t3": arrival of the pong in host time)
+  Result sync(JsonDoc const& msg)
+  {
+    uint64_t t0 = msg["t0"];
+    uint64_t t1 = msg["t1"];
+    uint64_t t2 = msg["t2"];
+    uint64_t t3 = msg["t3"];
+    if (!t3)
+    {
+      return Result::Invalid;
+    }
+
+    bool     used = Clock.sample(t0, t1, t2, t3);
+    uint32_t rtt;
+    bool     valid = protocol::ClockSync::roundTrip(t0, t1, t2, t3, rtt);
+    if (valid)
+    {
+      Rtt.record(rtt);
+    }
+
+    auto doc      = createDoc("sync");
+    doc["used"]   = used;
+    if (valid)
+    {
+      doc["rtt"]  = rtt;
+    }
+    doc["skew"]     = Clock.skew();
+    doc["offset"]   = static_cast<int64_t>(Clock.toHost(Received_us) - Received_us);
+    doc["restarts"] = Clock.restarts();
+    send(doc);
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // round trip times of all clock exchanges (us)
+  Result reportRtt(JsonDoc const& msg)
+  {
+    bool reset  = msg["reset"];
+    auto doc    = createDoc("rtt");
+    doc["n"]    = Rtt.count();
+    doc["min"]  = Rtt.min();
+    doc["max"]  = Rtt.max();
+    doc["p50"]  = Rtt.percentile(500);
+    doc["p99"]  = Rtt.percentile(990);
+    doc["best"] = Clock.bestRtt();
+
+    auto hist = doc.createNestedArray("log2");
+    for (size_t b = 0, n = Rtt.used(); b < n; ++b)
+    {
+      hist.add(Rtt.bucketCount(b));
+    }
+    send(doc);
+
+    if (reset)
+    {
+      Rtt.requestReset();
+    }
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // full allowlist load in several messages:
+  // {"action":"allow","clear":true,"add":["04a1b2c3",...],"commit":true,"gen":7} - all optional, applied in this order
+  // commit stores the list as a new credential generation ("gen", default current + 1) and frees the RAM list; if storing fails
+  // the RAM list stays in effect until a later generation is stored (full load or delta) or the next reboot.
+  // A "gen" that is not newer than the stored one is nacked and nothing is committed (the next boot would go back to the higher one)
+  Result allow(JsonDoc const& msg)
+  {
+    bool clear = msg["clear"];
+    if (clear)
+    {
+      Allowed.clear();
+    }
+
+    Result result = stage(msg["add"], Allowed);
+
+    bool     commit     = msg["commit"];
+    bool     stored     = false;
+    uint32_t generation = msg["gen"] | (Credentials.generation() + 1);
+    bool     stale      = Credentials.valid() && (generation <= Credentials.generation());
+    if (commit && stale)
+    {
+      result = Result::Invalid;
+    }
+    else if (commit)
+    {
+      Allowed.commit();
+
+      stored = Credentials.write(generation, access::KeySet(), Allowed.keys(), access::KeySet());
+      if (stored)
       {
-        // Nachricht komplett -> parsen
-        JsonDoc msg;
-        if (deserializeJson(msg, InputBuffer) == ArduinoJson::DeserializationError::Ok) 
-        {          
-          std::string action = msg["action"];
+        Allowed.clear();
+      }
+    }
 
-          if      (action == "set")
-          {
-            setFromJson(msg);
-          }
-          else if (action == "reboot")
-          {
-            while(true) {};
-          }        
+    auto doc        = createDoc("allow");
+    doc["size"]     = Allowed.size();
+    doc["pending"]  = Allowed.pending();
+    doc["capacity"] = Allowed.capacity();
+    doc["gen"]      = Credentials.generation();
+    if (commit)
+    {
+      doc["stored"] = stored;
+    }
+    send(doc);
+    return result;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // incremental update of the stored credentials:
+  // {"action":"delta","base":6,"gen":7,"add":["04a1b2c3",...],"remove":[...]}
+  // only applied if "base" is the current generation (0 = nothing stored), otherwise the host has to resync (reply carries the current one)
+  Result delta(JsonDoc const& msg)
+  {
+    uint32_t base       = msg["base"] | 0u;
+    uint32_t generation = msg["gen"] | (base + 1);
+
+    Result result = Result::Invalid;
+    if ((base == Credentials.generation()) && (generation > base))
+    {
+      DeltaAdd.clear();
+      DeltaRemove.clear();
+      result = stage(msg["add"], DeltaAdd);
+      if (result == Result::Ok)
+      {
+        result = stage(msg["remove"], DeltaRemove);
+      }
+
+      if (result == Result::Ok)
+      {
+        DeltaAdd.commit();
+        DeltaRemove.commit();
+        if (!Credentials.write(generation, Credentials.keys(), DeltaAdd.keys(), DeltaRemove.keys()))
+        {
+          result = Result::Full;
+        }
+        else if (!Allowed.empty())
+        {
+          Allowed.clear();   // the stored generation is newer than a RAM list left by a failed store
         }
+      }
+    }
+
+    auto doc    = createDoc("delta");
+    doc["gen"]  = Credentials.generation();
+    doc["size"] = Credentials.keys().size();
+    send(doc);
+    return result;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // adds hex UIDs to a list (uncommitted)
+  template <typename TList>
+  static Result stage(ArduinoJson::JsonVariantConst uids, TList& list)
+  {
+    Result result = Result::Ok;
+    for (auto entry : uids.as<ArduinoJson::JsonArrayConst>())
+    {
+      uint8_t uid[sizeof(MFRC522::Uid::uidByte)];
+      size_t  size = protocol::hex::decode(entry | "", uid, sizeof(uid));
+      if (!size)
+      {
+        result = Result::Invalid;
+      }
+      else if (!list.add(uid, size))
+      {
+        result = access::KeySet::isValid(size) ? Result::Full : Result::Invalid;
+      }
+    }
+    return result;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  Result reboot(JsonDoc const&)
+  {
+    while(true) {};
+  }
 
-        InputBuffer.clear();
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // one event per changed input: {"action":"input","name":..,"level":..,"dt":..,"t":..}
+  void handleInputs(TInputs::Change const& change)
+  {
+    for (size_t i = 0; i < TInputs::Count; ++i)
+    {
+      if (change.Toggled & (1u << i))
+      {
+        auto doc     = createDoc("input");
+        doc["name"]  = inputName(i);
+        doc["level"] = static_cast<bool>(change.State & (1u << i));
+        stamp(doc, change.Time_us);
+        send(doc);
       }
     }
   }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-  void handleUid(MFRC522::Uid& uid)
+  // arrival: decides locally if credentials are loaded (otherwise every tag passes, the host decides), shows the result, then reports the tag
+  // {"action":"event","state":"arrived","decision":..,"tag":{..}} / {"action":"event","state":"removed","dwell":us,"tag":{..}}
+  void handleUid(TagEvent const& tag)
   {
     auto doc = createDoc("event");
 
+    if (tag.Kind == rfid::Presence::Arrived)
+    {
+      auto const& uid  = tag.Uid;
+      auto const  keys = credentials();
+
+      char const* decision = "none";
+      bool        allowed  = true;
+      if (!keys.empty())
+      {
+        allowed  = keys.contains(uid.uidByte, uid.size);
+        decision = allowed ? "pass" : "fail";
+      }
+      show(allowed ? led::LedRing::Effect::Pass : led::LedRing::Effect::Fail);
+
+      doc["state"]    = "arrived";
+      doc["decision"] = decision;
+    }
+    else
+    {
+      doc["state"] = "removed";
+      doc["dwell"] = tag.Dwell_us;
+    }
+    doc["reader"] = readerName(tag.Source);
+    stamp(doc, tag.Time_us);
     auto rfid = doc.createNestedObject("tag");
+    addTag(rfid, tag.Uid);
+    if (tag.Memory.Size)
+    {
+      addBytes(rfid, "data", tag.Memory.Data, tag.Memory.Size);
+      rfid["us"] = tag.Memory.Read_us;
+    }
+    send(doc);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // all tags in the field, reported when an inventory found a new one (the arrivals are reported as events as well):
+  // {"action":"inventory","reader":..,"complete":..,"us":..,"tags":[{"sak":..,"uid":..,"us":..},..],"dt":..,"t":..}
+  void handleInventory(rfid::Inventory const& inventory)
+  {
+    StatsDoc doc;
+    doc["action"]   = "inventory";
+    doc["reader"]   = readerName(inventory.Source);
+    doc["complete"] = inventory.Complete;
+    doc["us"]       = inventory.Duration_us;
+    stamp(doc, inventory.Time_us);
+
+    auto tags = doc.createNestedArray("tags");
+    for (size_t i = 0; i < inventory.Count; ++i)
+    {
+      auto tag = tags.createNestedObject();
+      addTag(tag, inventory.Tags[i].Uid);
+      tag["us"] = inventory.Tags[i].Select_us;
+    }
+    send(doc);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // {"sak":..,"uid":..} - hex strings in JSON mode, sak as number and uid as bin8 in binary mode
+  void addTag(ArduinoJson::JsonObject rfid, MFRC522::Uid const& uid)
+  {
+    if (Format == Mode::Binary)
+    {
+      rfid["sak"] = uid.sak;
+    }
+    else
+    {
+      char sak[protocol::hex::encodedSize(sizeof(uid.sak))];
+      protocol::hex::encode(&uid.sak, sizeof(uid.sak), sak);
+      rfid["sak"] = static_cast<char*>(sak);
+    }
+    addBytes(rfid, "uid", uid.uidByte, uid.size);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // up to rfid::MaxPayload bytes as hex string in JSON mode, as MessagePack bin8 in binary mode
+  void addBytes(ArduinoJson::JsonObject object, char const* key, uint8_t const* data, size_t size)
+  {
+    static_assert(sizeof(MFRC522::Uid::uidByte) <= rfid::MaxPayload, "UIDs go through the same buffer");
+
+    if (Format == Mode::Binary)
+    {
+      // raw bytes instead of a hex string
+      char bin[2 + rfid::MaxPayload] = { static_cast<char>(0xC4), static_cast<char>(size) };
+      memcpy(bin + 2, data, size);
+      object[key] = ArduinoJson::serialized(bin, 2 + size);
+      return;
+    }
+
+    // char* (not char const*): copied into the document
+    char text[protocol::hex::encodedSize(rfid::MaxPayload)];
+    protocol::hex::encode(data, size, text);
+    object[key] = static_cast<char*>(text);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // one line per stage, optionally restarting the measurement afterwards; the reader lines follow once the RFID task copied the statistics
+  // (see reportReader()), so the protocol task never reads counters the RFID task is updating
+  Result reportStats(JsonDoc const& msg)
+  {
+    bool reset = msg["reset"];
+
+    if (!StatsRequests.push(reset))
+    {
+      return Result::Busy;
+    }
+    RfidWake.notify();
+
+    {
+      auto doc         = createDoc("stats");
+      doc["stage"]     = "tx";
+      doc["capacity"]  = Tx.capacity();
+      doc["peak"]      = Tx.peak();
+      doc["dropped"]   = Tx.dropped();
+      doc["oversized"] = Tx.oversized();
+      send(doc);
+    }
+
+    if (!Stats.IsEnabled)
+    {
+      auto doc       = createDoc("stats");
+      doc["enabled"] = false;
+      send(doc);
+      return Result::Ok;
+    }
+
+    for (size_t s = 0; s < stats::NrStages; ++s)
+    {
+      StatsDoc doc;
+      doc["action"] = "stats";
+      Stats.report(static_cast<stats::Stage>(s), doc);
+      send(doc);
+    }
+
+    if (reset)
     {
-      std::stringstream ss;
-      ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(uid.sak);
-      rfid["sak"] = ss.str();
+      Stats.reset();
     }
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // statistics of one reader as copied by the RFID task
+  void reportReader(rfid::Report const& report)
+  {
+    StatsDoc doc;
+    doc["action"]     = "stats";
+    doc["stage"]      = "rfid";
+    doc["reader"]     = readerName(report.Source);
+    doc["available"]  = report.Available;
+    doc["state"]      = report.State;
+    doc["reads"]      = report.Reads;
+    doc["duplicates"] = report.Duplicates;
+    doc["tracked"]    = report.Tracked;
+    doc["rearm"]      = report.Rearm_ms;
+
+    auto spi            = doc.createNestedObject("spi");
+    spi["clock"]        = report.SpiClock;
+    spi["transactions"] = report.SpiTransactions;
+    spi["frames"]       = report.SpiFrames;
+    spi["bytes"]        = report.SpiBytes;
+
+    auto irq         = doc.createNestedObject("irq");
+    irq["n"]         = report.Irqs;
+    irq["coalesced"] = report.Coalesced;
+    irq["dropped"]   = report.Dropped;
+    irq["p50"]       = report.Latency50_us;
+    irq["p99"]       = report.Latency99_us;
+    irq["max"]       = report.LatencyMax_us;
+
+    auto mem      = doc.createNestedObject("memory");
+    mem["reads"]  = report.MemoryReads;
+    mem["failed"] = report.MemoryFailed;
+
+    auto errors = doc.createNestedObject("errors");
+    for (size_t f = 0; f < rfid::NrFaults; ++f)
     {
-      std::stringstream ss;
-      for (byte i = 0; i <  uid.size; i++)
+      errors[rfid::name(static_cast<rfid::Fault>(f))] = report.Faults[f];
+    }
+    doc["reinits"] = report.Reinits;
+    doc["backoff"] = report.Backoff_ms;
+
+    doc["rounds"] = report.Rounds;
+    doc["last"]   = report.Last_us;
+    doc["max"]    = report.Max_us;
+    doc["wait"]   = report.Wait_us;
+    send(doc);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // JSON header line announcing the record count and id names, followed by the raw 8 byte records (see tools/trace2chrome.py)
+  Result dumpTrace(JsonDoc const& msg)
+  {
+    bool reset = msg["reset"];
+
+    // the raw dump would be taken for frames, so it is JSON mode only (the NAK of Invalid is the reply)
+    if (Format != Mode::Json)
+    {
+      return Result::Invalid;
+    }
+
+    auto doc       = createDoc("trace");
+    doc["enabled"] = trace::Trace::IsEnabled;
+    doc["n"]       = trace::Trace::freeze();
+    doc["size"]    = sizeof(trace::Record);
+
+    auto ids = doc.createNestedArray("ids");
+    for (size_t i = 0; i < trace::NrIds; ++i)
+    {
+      ids.add(trace::name(static_cast<trace::Id>(i)));
+    }
+    auto tasks = doc.createNestedArray("tasks");
+    for (size_t i = 0; (i < trace::MaxTasks) && trace::Trace::taskName(i); ++i)
+    {
+      tasks.add(trace::Trace::taskName(i));
+    }
+    send(doc);
+
+    // bulk dump, bypasses the TX buffer: 8 KiB take ~0.7 s at 115200 baud, so the watchdog is fed after every chunk
+    Tx.flush(Serial);
+    esp_task_wdt_reset();
+    trace::Trace::dump([](uint8_t const* data, size_t size)
+                       {
+                         for (size_t done = 0; done < size; done += TraceChunk)
+                         {
+                           Serial.write(data + done, ((size - done) < TraceChunk) ? (size - done) : size_t(TraceChunk));
+                           esp_task_wdt_reset();
+                         }
+                       }, reset);
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  template <typename TDoc>
+  void send(TDoc const& doc)
+  {
+    if (Format == Mode::Binary)
+    {
+      if (measureMsgPack(doc) > Frames.capacity())
       {
-        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(uid.uidByte[i]);
+        Tx.reject();
+        return;
       }
-      rfid["uid"] = ss.str();
+      Frames.send(serializeMsgPack(doc, Frames.payload(), Frames.capacity()), Tx);
+    }
+    else
+    {
+      serializeJson(doc, Tx);
+      Tx.write('\n');
     }
+    Tx.commit();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  Result setMode(JsonDoc const& msg)
+  {
+    static constexpr auto Modes = protocol::makeNameMap<Mode>({
+      { "json",   Mode::Json   },
+      { "binary", Mode::Binary },
+    });
+
+    Mode mode;
+    if (!Modes.find(msg["mode"] | "", mode))
+    {
+      return Result::Invalid;
+    }
+
+    setMode(mode);
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // acknowledges in the current format, then switches; echo is suspended while in binary mode
+  void setMode(Mode mode)
+  {
+    auto doc    = createDoc("mode");
+    doc["mode"] = (mode == Mode::Binary) ? "binary" : "json";
+    send(doc);
 
-    serializeJson(doc, Serial);
-    Serial.write('\n');
+    if (mode == Format)
+    {
+      return;
+    }
+
+    Format = mode;
+    if (mode == Mode::Binary)
+    {
+      JsonEcho = InputBuffer.echo();
+      InputBuffer.setEcho(false);
+      InputBuffer.setDelimiter(protocol::Delimiter);
+    }
+    else
+    {
+      InputBuffer.setEcho(JsonEcho);
+      InputBuffer.setDelimiter('\n');
+    }
   }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-  void setFromJson(JsonDoc const& doc)
+  Result setFromJson(JsonDoc const& doc)
   {
+    Result result = Result::Ok;
+
+    if (doc.containsKey("echo") && (Format == Mode::Json))
+    {
+      InputBuffer.setEcho(doc["echo"]);
+    }
+    if (doc.containsKey("pir"))
+    {
+      // {"debounce":ms,"hold":ms}, missing values keep the defaults
+      uint32_t debounce = doc["pir"]["debounce"] | uint32_t(input::Pir::Debounce_ms);
+      uint32_t hold     = doc["pir"]["hold"]     | uint32_t(input::Pir::Hold_ms);
+      Presence.configure(debounce, hold);
+    }
+    if (doc.containsKey("poll"))
+    {
+      // {"active":ms,"idle":ms,"hold":ms} re-arm intervals with and without presence, hold after presence ended; missing values keep the defaults
+      uint32_t active = doc["poll"]["active"] | uint32_t(rfid::PollPolicy::Active_ms);
+      uint32_t idle   = doc["poll"]["idle"]   | uint32_t(rfid::PollPolicy::Idle_ms);
+      uint32_t hold   = doc["poll"]["hold"]   | uint32_t(rfid::PollPolicy::Hold_ms);
+      if (!active || !idle)
+      {
+        result = Result::Invalid;
+      }
+      else
+      {
+        Polling.configure(active, idle, hold);
+        applyPolling();
+      }
+    }
+    if (doc.containsKey("memory"))
+    {
+      Result memory = configureMemory(doc["memory"]);
+      result        = (memory != Result::Ok) ? memory : result;
+    }
+    if (doc.containsKey("layer"))
+    {
+      Result layer = configureLayer(doc["layer"]);
+      result       = (layer != Result::Ok) ? layer : result;
+    }
     if (doc.containsKey("bright"))
     {
       uint32_t brightness = doc["bright"];
-      Ring                = brightness;
+      if (!post({led::LedRing::Command::Kinds::Brightness, brightness}))
+      {
+        result = Result::Busy;
+      }
     }
     if (doc.containsKey("fx"))
     {
-      std::string fx = doc["fx"];
-      Ring           = fx;
+      std::string_view     fx = doc["fx"] | "";
+      led::LedRing::Effect effect;
+      if (!led::LedRing::lookup(fx, effect))
+      {
+        result = Result::Invalid;
+      }
+      else if (!show(effect))
+      {
+        result = Result::Busy;
+      }
+    }
+
+    return result;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // composition of an LED layer: {"name":"status","opacity":0..255,"blend":"replace"|"add"|"alpha","priority":n}; missing values are left as they are
+  Result configureLayer(ArduinoJson::JsonVariantConst config)
+  {
+    std::string_view    name = config["name"] | "";
+    led::LedRing::Layer layer;
+    if (!led::LedRing::lookup(name, layer))
+    {
+      return Result::Invalid;
+    }
+
+    led::Blend mode = led::Blend::Replace;
+    if (config.containsKey("blend") && !led::LedRing::lookup(config["blend"] | "", mode))
+    {
+      return Result::Invalid;
+    }
+
+    bool posted = true;
+    if (config.containsKey("opacity"))
+    {
+      posted &= post({led::LedRing::Command::Kinds::Opacity, config["opacity"] | 0xFFu, layer});
+    }
+    if (config.containsKey("blend"))
+    {
+      posted &= post({led::LedRing::Command::Kinds::Blend, static_cast<uint32_t>(mode), layer});
+    }
+    if (config.containsKey("priority"))
+    {
+      posted &= post({led::LedRing::Command::Kinds::Priority, config["priority"] | 0u, layer});
+    }
+    return posted ? Result::Ok : Result::Busy;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // tag memory read on arrival, handed to the RFID task for all readers:
+  // {"first":page,"pages":n,"sector":s,"keys":["ffffffffffff",..]} - NTAG/Ultralight pages, MIFARE Classic sector with key A candidates;
+  // a missing "pages" or "sector" switches that read off
+  Result configureMemory(ArduinoJson::JsonVariantConst memory)
+  {
+    unsigned first  = memory["first"]  | 0u;
+    unsigned pages  = memory["pages"]  | 0u;
+    unsigned sector = memory["sector"] | unsigned(rfid::MemoryConfig::NoSector);
+    if ((pages > rfid::MemoryConfig::MaxPages) || (first + pages > 0x100)
+        || ((sector > rfid::MemoryConfig::MaxSector) && (sector != rfid::MemoryConfig::NoSector)))
+    {
+      return Result::Invalid;
+    }
+
+    rfid::MemoryConfig config = {};
+    config.FirstPage = static_cast<uint8_t>(first);
+    config.Pages     = static_cast<uint8_t>(pages);
+    config.Sector    = static_cast<uint8_t>(sector);
+
+    for (auto key : memory["keys"].as<ArduinoJson::JsonArrayConst>())
+    {
+      if ((config.NrKeys == rfid::MaxKeys)
+          || (protocol::hex::decode(key | "", config.Keys[config.NrKeys].keyByte, sizeof(MFRC522::MIFARE_Key::keyByte)) != sizeof(MFRC522::MIFARE_Key::keyByte)))
+      {
+        return Result::Invalid;
+      }
+      ++config.NrKeys;
+    }
+
+    if (!MemoryConfigs.push(config))
+    {
+      return Result::Busy;
+    }
+    RfidWake.notify();
+    return Result::Ok;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // hands the current re-arm interval to the RFID task, which applies it with its next round
+  void applyPolling()
+  {
+    Readers.setRearm(Polling.interval());
+    RfidWake.notify();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool show(led::LedRing::Effect effect)
+  {
+    return post({led::LedRing::Command::Kinds::Effect, static_cast<uint32_t>(effect)});
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool post(led::LedRing::Command const& command)
+  {
+    if (!RingCommands.push(command))
+    {
+      return false;
+    }
+
+    RenderWake.notify();
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // RFID task: polls the reader and hands detected tags to the protocol task
+  static void rfidTask(void* self)
+  {
+    auto& app = *static_cast<App*>(self);
+    app.RfidWake.attach();
+
+    while (true)
+    {
+      rfid::MemoryConfig config;
+      while (app.MemoryConfigs.pop(config))
+      {
+        for (size_t r = 0; r < TReaders::Count; ++r)
+        {
+          app.Readers.visit(r, [&](auto& reader) { reader.memory().configure(config); });
+        }
+      }
+
+      // statistics are copied here, where they are updated; a reset is carried out by the next round
+      bool queued = false;
+      bool reset;
+      while (app.StatsRequests.pop(reset))
+      {
+        for (size_t r = 0; r < TReaders::Count; ++r)
+        {
+          rfid::Report report;
+          app.Readers.report(r, report);
+          queued |= app.ReaderReports.push(report);
+        }
+        if (reset)
+        {
+          app.Readers.requestReset();
+        }
+      }
+
+      {
+        auto        probe = app.Stats.measure(stats::Stage::Reader);
+        trace::Span span(trace::Id::Reader);
+        app.Readers([&](TagEvent const& event)              { queued |= app.Tags.push(event);            },
+                    [&](rfid::Inventory const& inventory)   { queued |= app.Inventories.push(inventory); });
+      }
+      if (queued)
+      {
+        app.Wake.notify();
+      }
+
+      common::delta::Deadline next(MaxSleep_ms);
+      next.at(app.Readers.due());
+      app.RfidWake.wait(next.remaining());
     }
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // LED render task: applies queued commands and renders the current effect
+  static void renderTask(void* self)
+  {
+    auto& app = *static_cast<App*>(self);
+    app.RenderWake.attach();
+
+    while (true)
+    {
+      led::LedRing::Command command;
+      while (app.RingCommands.pop(command))
+      {
+        app.Ring = command;
+      }
+
+      {
+        auto        probe = app.Stats.measure(stats::Stage::Ring);
+        trace::Span span(trace::Id::Render);
+        app.Ring();
+      }
+
+      common::delta::Deadline next(MaxSleep_ms);
+      next.at(app.Ring.due());
+      app.RenderWake.wait(next.remaining());
+    }
+  }
+
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // credentials in effect: a RAM list that could not be stored wins over the stored generation, until a newer one is stored
+  access::KeySet credentials() const
+  {
+    return Allowed.empty() ? Credentials.keys() : Allowed.keys();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // device clock (us) all event times are taken from; same source as the TimeDelta base
+  static uint64_t now()
+  {
+    return common::delta::MonotonicSource<1>::micros64();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // event time in device time ("dt") and, once synchronized, in host time ("t")
+  template <typename TDoc>
+  void stamp(TDoc& doc, uint64_t device_us)
+  {
+    doc["dt"] = device_us;
+    if (Clock.synced())
+    {
+      doc["t"] = Clock.toHost(device_us);
+    }
+  }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   JsonDoc createDoc(char const* action)
@@ -154,11 +1103,41 @@ private:
 
     return doc;
   }
-  led::LedRing Ring;
-  rfid::Reader Reader;
-  std::string  InputBuffer;
+  rtos::Wakeup Wake;        // protocol task
+  rtos::Wakeup RfidWake;
+  rtos::Wakeup RenderWake;
+  led::LedRing Ring;         // owned by the render task
+  TReaders     Readers;      // owned by the RFID task
+  input::Pir   Presence;     // owned by the protocol task
+  rfid::PollPolicy Polling;  // owned by the protocol task
+  TInputs      Inputs;       // owned by the protocol task
+  protocol::LineReader<LineLength>  InputBuffer;
+  protocol::FrameWriter<LineLength> Frames;
+  protocol::TxBuffer<TxCapacity>    Tx;
+  Mode                              Format   = Mode::Json;
+  bool                              JsonEcho = true;
+
+  rtos::SpscQueue<TagEvent,              QueueDepth> Tags;          // RFID task -> protocol task
+  rtos::SpscQueue<rfid::Inventory,       2>          Inventories;   // RFID task -> protocol task
+  rtos::SpscQueue<led::LedRing::Command, QueueDepth> RingCommands;  // protocol task -> render task
+  rtos::SpscQueue<rfid::MemoryConfig,    2>          MemoryConfigs; // protocol task -> RFID task
+  rtos::SpscQueue<bool,                  2>          StatsRequests; // protocol task -> RFID task: reader statistics wanted (true: then reset)
+  rtos::SpscQueue<rfid::Report, 2 * TReaders::Count> ReaderReports; // RFID task -> protocol task
+
+  rtos::Task   RfidTask;
+  rtos::Task   RenderTask;
+
+  stats::LoopStats<> Stats;
+
+
+  access::Allowlist<AllowShort, AllowLong> Allowed;       // RAM staging for full loads, only used for decisions if it could not be stored
+  access::Allowlist<DeltaSize, DeltaSize>  DeltaAdd;
+  access::Allowlist<DeltaSize, DeltaSize>  DeltaRemove;
+  access::Snapshot                         Credentials;   // stored generation, searched in place in flash
 
-  bool PirActive = false;
+  protocol::ClockSync Clock;
+  stats::Histogram    Rtt;               // us
+  uint64_t            Received_us = 0;   // arrival of the command being handled
 
 };
 
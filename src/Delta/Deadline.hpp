@@ -0,0 +1,89 @@
+#ifndef common_DELTA_DEADLINE_INCLUDED
+#define common_DELTA_DEADLINE_INCLUDED
+///#############################################################################################################################################################
+///
+/// @file
+///
+/// @brief Ermittlung des nächsten fälligen Zeitpunkts mehrerer Timer.
+///
+/// Projekt: common Standard
+///
+///#############################################################################################################################################################
+///
+/// (C) 2019 Magnet Schultz GmbH & Co. KG
+///
+///#############################################################################################################################################################
+
+
+#include <stdint.h>
+
+
+namespace common { namespace delta {
+// = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
+
+
+//==============================================================================================================================================================
+/// Sammelt die Restlaufzeiten beliebig vieler Timer und liefert die kürzeste davon.
+///
+/// Typische Anwendung: Nach einem Schleifendurchlauf melden alle aktiven Timer, Zustandsautomaten und Effekte per at() an, wann sie frühestens wieder
+/// bearbeitet werden müssen. Die Hauptschleife kann anschließend bis zu diesem Zeitpunkt schlafen, statt in einem festen Raster zu pollen.
+class Deadline
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Never = UINT32_MAX, ///< Restlaufzeit eines Timers, der keinen Folgeaufruf benötigt
+  };
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// Konstruktor.
+  /// @param limit  maximale Restlaufzeit, die unabhängig von den angemeldeten Timern geliefert wird
+  explicit inline constexpr Deadline(uint32_t limit = Never)
+    : Remaining(limit)
+  {
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// meldet die Restlaufzeit eines Timers an.
+  /// @param remaining  Zeit bis zur nächsten Fälligkeit (0 = sofort, Never = keine)
+  inline void at(uint32_t remaining)
+  {
+    if (remaining < Remaining)
+    {
+      Remaining = remaining;
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// liefert die kürzeste angemeldete Restlaufzeit.
+  /// @return Zeit bis zur nächsten Fälligkeit
+  inline uint32_t remaining() const
+  {
+    return Remaining;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// berechnet die Restlaufzeit bis zum Ablauf einer Zeitspanne.
+  /// @param elapsed   bereits vergangene Zeit
+  /// @param interval  Soll-Zeitspanne
+  /// @return Restlaufzeit, 0 falls bereits abgelaufen
+  static inline constexpr uint32_t until(uint32_t elapsed, uint32_t interval)
+  {
+    return (elapsed < interval) ? (interval - elapsed) : 0;
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  uint32_t Remaining; ///< kürzeste bisher angemeldete Restlaufzeit
+};
+//==============================================================================================================================================================
+
+
+// = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
+} } // namespace common::delta
+
+
+#endif // common_DELTA_DEADLINE_INCLUDED
@@ -14,6 +14,7 @@
 
 
 #include "TimeDelta.hpp"
+#include "Deadline.hpp"
 
 namespace common { namespace delta {
 // = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
@@ -56,6 +57,15 @@ public:
   {
     return TTimer::get() >= CycleTime;
   }
+
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// liefert die Restlaufzeit bis zum Ablauf der aktuellen Zykluszeit.
+  /// @return Restlaufzeit, 0 falls bereits abgelaufen
+  inline uint32_t remaining() const
+  {
+    return Deadline::until(TTimer::get(), CycleTime);
+  }
   
   
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
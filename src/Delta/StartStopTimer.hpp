@@ -73,7 +73,7 @@ public:
   inline void start(uint32_t cycleTime)
   {
     reset();
-    setCycleTime(cycleTime);
+    TTimer::setCycleTime(cycleTime);
     Mode = Modes::Started;
   }
 
@@ -88,7 +88,7 @@ public:
   inline void startCyclical(uint32_t cycleTime, uint32_t offsetTime = 0)
   {
     reset(offsetTime);
-    setCycleTime(cycleTime);
+    TTimer::setCycleTime(cycleTime);
     Mode = Modes::Cyclical;
   }
   
@@ -98,6 +98,14 @@ public:
   {
     return (Mode != Modes::Stopped) && (Mode != Modes::Expired);
   }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// liefert die Restlaufzeit bis zum nächsten Ablauf.
+  /// @return Restlaufzeit, Deadline::Never falls der Timer nicht läuft
+  inline uint32_t remaining() const
+  {
+    return running() ? TTimer::remaining() : static_cast<uint32_t>(Deadline::Never);
+  }
   
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   /// Arbeitet den periodischen Timer ab.
@@ -120,7 +128,7 @@ public:
     default:
       if (Mode == Modes::Started)
       {
-        if (elapsed())
+        if (TTimer::elapsed())
         {
           Mode = Modes::Expired;
           return true;
@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 #include <type_traits>
+#include "TimeSource.hpp"
 
 
 namespace common { namespace delta {
@@ -25,13 +26,15 @@ namespace common { namespace delta {
 
 /// Klasse zur Messung von Zeitdifferenzen.
 ///
-/// Alle TimeDelta-Instanzen einer spezifischen, auf einem periodisch inkrementierten und ggf. überlaufenden Zähler beruhender Zeitbasis erlauben die
+/// Alle TimeDelta-Instanzen einer spezifischen, auf einem fortlaufenden und ggf. überlaufenden Zähler beruhender Zeitbasis erlauben die
 /// voneinander unabhängig Messung von Zeitdifferenzen gegenüber einem triggerbaren Referenzpunkt (reset()).
 ///
-/// Die Zeitbasis muss zentral durch Aufruf der statischen tick()-Methode aktualisiert werden.
+/// Die Zeitbasis wird durch eine Zeitquelle (@see TimeBase) bereitgestellt. Tick-basierte Zeitquellen müssen zentral durch Aufruf der statischen
+/// tick()-Methode aktualisiert werden, hardwarebasierte Zeitquellen (MonotonicSource) laufen selbstständig.
 ///
 /// @tparam TimeBaseIndex  Index der gemeinsamen Zeitbasis
-template <size_t TimeBaseIndex = 0>
+/// @tparam TSource        Zeitquelle der Zeitbasis
+template <size_t TimeBaseIndex = 0, typename TSource = typename TimeBase<TimeBaseIndex>::TSource>
 class TimeDelta
 {
 
@@ -53,7 +56,7 @@ public:
   /// @param offset  verschiebt die Referenzzeitmake um diesen Offset in die Vergangenheit
   inline void reset(uint32_t offset = 0)
   {
-    Capture = Counter - offset;
+    Capture = counter() - offset;
   }
 
 
@@ -62,7 +65,7 @@ public:
   /// @return Zeitdifferenz.
   inline uint32_t get() const
   {
-    return Counter - Capture;
+    return counter() - Capture;
   }
 
 
@@ -76,10 +79,19 @@ public:
 
 
   //===== gemeinsame Zeitbasis =================================================================================================================================
+  /// liefert den vollen, nicht überlaufenden Stand der gemeinsamen Zeitbasis.
+  /// @return Zeit seit Systemstart in Zeiteinheiten der Zeitbasis
+  static inline uint64_t now()
+  {
+    return TSource::now();
+  }
+
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   /// Inkrementiert die gemeinsame Zeitbasis um eine Bestimmte Anzahl von Zeiteinheiten.
   ///
-  /// @attention Jede Zeitbasis, die durch eine Instanz von TimeDelta oder seinen Derivaten zum Einatz kommt, muss an zentraler Stelle fortlaufend
-  ///            durch Aufruf dieser Methode aktualisiert werden.
+  /// @attention Jede tick-basierte Zeitbasis, die durch eine Instanz von TimeDelta oder seinen Derivaten zum Einatz kommt, muss an zentraler Stelle
+  ///            fortlaufend durch Aufruf dieser Methode aktualisiert werden. Für hardwarebasierte Zeitquellen steht die Methode nicht zur Verfügung.
   ///
   /// Der Aufruf kann streng periodisch unter Angabe einer konstanten Zeitdifferenz erfolgen (z.B. tick(100) für eine Mikrosekunden-Zeitbasis,
   /// aufgerufen durch einen 100µs Hardware-Timerinterrupt), oder durch hinreichend häufige Aufrufe unter Angabe einer variablen Zahl von Zeiteinheiten,
@@ -89,19 +101,21 @@ public:
   /// @param timeUnitsPassed  Anzahl der Zeiteinheiten, die seit dem letzten Tick vergangen sind.
   static void inline tick(uint32_t timeUnitsPassed = 1)
   {
-    Counter += timeUnitsPassed;
+    TSource::tick(timeUnitsPassed);
   }
 
 //==============================================================================================================================================================
 private:
 //==============================================================================================================================================================
-  static uint32_t          Counter; ///< gemeinsamer Systemzeitzähler für die Zeitbasis \p TimeBaseIndex
+  /// liefert die unteren 32 Bit der Zeitbasis; Differenzen bleiben dank Modulo-Arithmetik über den Überlauf hinweg korrekt.
+  static inline uint32_t counter()
+  {
+    return static_cast<uint32_t>(TSource::now());
+  }
+
   uint32_t                 Capture; ///< Referenzzeitmarke (@see reset())
 };
 
-template <size_t TimeBaseIndex>
-uint32_t TimeDelta<TimeBaseIndex>::Counter = 0;
-
 
 // = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 } } // namespace common::delta
@@ -0,0 +1,138 @@
+#ifndef common_TIME_SOURCE_INCLUDED
+#define common_TIME_SOURCE_INCLUDED
+///#############################################################################################################################################################
+///
+/// @file
+///
+/// @brief Zeitquellen für die gemeinsamen Zeitbasen von TimeDelta.
+///
+/// Projekt: common Standard
+///
+///#############################################################################################################################################################
+///
+/// (C) 2019 Magnet Schultz GmbH & Co. KG
+///
+///#############################################################################################################################################################
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+
+namespace common { namespace delta {
+// = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
+
+
+//==============================================================================================================================================================
+/// Zeitquelle, die ausschließlich durch explizite tick()-Aufrufe fortgeschaltet wird.
+///
+/// Der Zähler ist 64 Bit breit und wird atomar inkrementiert, so dass tick() und now() gefahrlos aus ISRs und von beiden Kernen aus aufgerufen werden
+/// können.
+///
+/// @tparam TimeBaseIndex  Index der gemeinsamen Zeitbasis
+template <size_t TimeBaseIndex>
+class TickSource
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  /// liefert den aktuellen Zählerstand.
+  /// @return Zählerstand in Zeiteinheiten
+  static inline uint64_t now()
+  {
+    return Counter.load(std::memory_order_relaxed);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// schaltet den Zähler um die angegebene Anzahl von Zeiteinheiten weiter.
+  /// @param timeUnitsPassed  Anzahl der Zeiteinheiten, die seit dem letzten Tick vergangen sind.
+  static inline void tick(uint32_t timeUnitsPassed)
+  {
+    Counter.fetch_add(timeUnitsPassed, std::memory_order_relaxed);
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static std::atomic<uint64_t> Counter; ///< gemeinsamer Zeitzähler für die Zeitbasis \p TimeBaseIndex
+};
+
+template <size_t TimeBaseIndex>
+std::atomic<uint64_t> TickSource<TimeBaseIndex>::Counter{0};
+
+
+
+//==============================================================================================================================================================
+/// Zeitquelle auf Basis der monotonen Hardware-Uhr.
+///
+/// Auf dem ESP32 wird der 64 Bit breite Mikrosekundenzähler des esp_timer verwendet, der von der Plattform überlauffrei, ISR-fest und über beide Kerne
+/// konsistent geführt wird. Im Host-Build dient std::chrono::steady_clock als Quelle.
+///
+/// Da die Zeit direkt aus der Hardware gelesen wird, ist kein tick() erforderlich; Zeitabweichungen durch unterschiedlich lange Schleifendurchläufe
+/// können sich nicht aufsummieren.
+///
+/// @tparam Resolution_us  Zeiteinheit in Mikrosekunden (z.B. 1000 für eine Millisekunden-Zeitbasis)
+template <uint32_t Resolution_us>
+class MonotonicSource
+{
+  static_assert(Resolution_us > 0, "Zeiteinheit muss mindestens 1µs betragen!");
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  /// liefert die aktuelle Zeit.
+  /// @return Zeit seit Systemstart in Zeiteinheiten
+  static inline uint64_t now()
+  {
+    return micros64() / Resolution_us;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// liefert die Rohzeit der Hardware-Uhr.
+  /// @return Zeit seit Systemstart in Mikrosekunden
+  static inline uint64_t micros64()
+  {
+#ifdef ESP_PLATFORM
+    return static_cast<uint64_t>(esp_timer_get_time());
+#else
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+};
+
+
+
+//==============================================================================================================================================================
+/// Zuordnung der Zeitbasis-Indizes zu ihren Zeitquellen.
+///
+/// Zeitbasis 0 läuft in Millisekunden auf der monotonen Hardware-Uhr, alle weiteren Zeitbasen werden klassisch per TimeDelta::tick() fortgeschaltet.
+/// Durch Spezialisierung kann jeder Index auf eine beliebige Zeitquelle gelegt werden. Eine Zeitquelle muss lediglich eine statische Methode now()
+/// mit einem vorzeichenlosen, fortlaufenden Zählerstand bereitstellen (tick() nur, sofern die Zeitbasis getickt wird).
+///
+/// @tparam TimeBaseIndex  Index der gemeinsamen Zeitbasis
+template <size_t TimeBaseIndex>
+struct TimeBase
+{
+  using TSource = TickSource<TimeBaseIndex>;
+};
+
+template <>
+struct TimeBase<0>
+{
+  using TSource = MonotonicSource<1000>;
+};
+
+
+// = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
+} } // namespace common::delta
+
+
+#endif // common_TIME_SOURCE_INCLUDED
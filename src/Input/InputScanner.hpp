@@ -0,0 +1,201 @@
+#ifndef INPUT_INPUT_SCANNER_INCLUDED_HPP
+#define INPUT_INPUT_SCANNER_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+#include <Arduino.h>
+#include "Delta/PeriodicTimer.hpp"
+#include "Delta/Deadline.hpp"
+#include "Delta/TimeSource.hpp"
+#include "Rtos/Wakeup.hpp"
+
+#ifdef ESP_PLATFORM
+#include <soc/gpio_reg.h>
+#endif
+
+namespace dps { namespace input {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Debounces up to 32 inputs in parallel with 2 bit vertical counters: bit i of Count0/Count1 is the counter of input i.
+// An input changes its debounced state after it has differed from it in 4 consecutive samples; any sample agreeing with the state restarts its
+// counter. The cost per sample is a handful of word operations, independent of the number of inputs.
+class VerticalDebouncer
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum
+  {
+    Samples = 4,
+  };
+
+  explicit VerticalDebouncer(uint32_t initial = 0) : State(initial) {}
+
+  // feeds one sample of all inputs, returns the inputs whose debounced state toggled
+  uint32_t operator()(uint32_t sample)
+  {
+    uint32_t delta   = sample ^ State;
+    Count1           = (Count1 ^ Count0) & delta;
+    Count0           = ~Count0 & delta;
+
+    uint32_t toggled = delta & ~(Count0 | Count1);
+    State           ^= toggled;
+    return toggled;
+  }
+
+  uint32_t state() const   { return State;             }
+
+  // true while any input is between two states
+  bool     settling() const { return (Count0 | Count1) != 0; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  uint32_t State;
+  uint32_t Count0 = 0;
+  uint32_t Count1 = 0;
+};
+
+
+//==============================================================================================================================================================
+// Input source reading a fixed set of GPIOs into a bit mask (bit i = Pins[i]).
+// On the target both GPIO input registers are read once per sample, so sampling costs two register reads plus bit gathering.
+template <uint8_t... Pins>
+class GpioInputs
+{
+  static_assert(sizeof...(Pins) <= 32, "at most 32 inputs per source");
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : size_t
+  {
+    Count = sizeof...(Pins),
+  };
+
+  explicit GpioInputs(uint8_t mode = INPUT)
+  {
+    (pinMode(Pins, mode), ...);
+  }
+
+  uint32_t read() const
+  {
+#ifdef ESP_PLATFORM
+    uint64_t levels = REG_READ(GPIO_IN_REG) | (static_cast<uint64_t>(REG_READ(GPIO_IN1_REG)) << 32);
+    auto     level  = [levels](uint8_t pin) { return static_cast<uint32_t>(levels >> pin) & 1; };
+#else
+    auto     level  = [](uint8_t pin) { return static_cast<uint32_t>(digitalRead(pin) != 0); };
+#endif
+    uint32_t bits   = 0;
+    uint32_t bit    = 0;
+    ((bits |= level(Pins) << bit++), ...);
+    return bits;
+  }
+
+  // calls isr(arg) on every edge of any input; returns false if the source cannot signal edges (then it is polled continuously)
+  bool attach(void (*isr)(void*), void* arg)
+  {
+    (attachInterruptArg(digitalPinToInterrupt(Pins), isr, arg, CHANGE), ...);
+    return true;
+  }
+};
+
+
+//==============================================================================================================================================================
+// Input scan stage: samples all inputs of a source every Scan_ms and debounces them with a VerticalDebouncer.
+// Sources that signal edges are only sampled while something is going on (an edge was seen or an input is still settling), so idle inputs
+// cost nothing.
+// @tparam TSource  provides 'Count', 'uint32_t read()' and 'bool attach(void (*isr)(void*), void* arg)', e.g. GpioInputs or an I/O expander
+template <typename TSource>
+class InputScanner
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Count   = TSource::Count,
+    Scan_ms = 5,   // debounce time = Scan_ms * VerticalDebouncer::Samples
+  };
+
+  struct Change
+  {
+    uint32_t Toggled;   // inputs that changed
+    uint32_t State;     // debounced state of all inputs
+    uint64_t Time_us;
+  };
+
+  template <typename... TArgs>
+  explicit InputScanner(rtos::Wakeup& wakeup, TArgs&&... args)
+    : Source(std::forward<TArgs>(args)...), Waker(wakeup), Debouncer(Source.read()), Scan(Scan_ms)
+  {
+    Interrupts = Source.attach(isr, this);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // samples the inputs if a scan is due; returns true and fills 'change' if any debounced state changed
+  bool operator()(Change& change)
+  {
+    if (!Scan())
+    {
+      return false;
+    }
+
+    if (!active())
+    {
+      return false;
+    }
+    Edge.store(false, std::memory_order_relaxed);
+
+    uint32_t toggled = Debouncer(Source.read());
+    if (!toggled)
+    {
+      return false;
+    }
+
+    change = {toggled, Debouncer.state(), common::delta::MonotonicSource<1>::micros64()};
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // time until the next scan, Deadline::Never while idle
+  uint32_t due() const
+  {
+    return active() ? Scan.remaining() : static_cast<uint32_t>(common::delta::Deadline::Never);
+  }
+
+  uint32_t state() const { return Debouncer.state(); }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  bool active() const
+  {
+    return !Interrupts || Edge.load(std::memory_order_relaxed) || Debouncer.settling();
+  }
+
+  static void IRAM_ATTR isr(void* self)
+  {
+    auto& scanner = *static_cast<InputScanner*>(self);
+    scanner.Edge.store(true, std::memory_order_relaxed);
+    scanner.Waker.notifyFromIsr();
+  }
+
+  TSource                          Source;
+  rtos::Wakeup&                    Waker;
+  VerticalDebouncer                Debouncer;
+  common::delta::PeriodicTimer<>   Scan;
+  std::atomic<bool>                Edge{false};
+  bool                             Interrupts = false;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::input
+
+#endif // INPUT_INPUT_SCANNER_INCLUDED_HPP
@@ -0,0 +1,189 @@
+#ifndef INPUT_PIR_INCLUDED_HPP
+#define INPUT_PIR_INCLUDED_HPP
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "Delta/StartStopTimer.hpp"
+#include "Delta/TimeSource.hpp"
+#include "Rtos/SpscQueue.hpp"
+#include "Rtos/Wakeup.hpp"
+#include "Trace/Trace.hpp"
+
+namespace dps { namespace input {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Interrupt driven PIR (presence) input.
+// The GPIO interrupt timestamps every edge into a lock-free queue and wakes the consuming task, which turns the raw edges into clean presence
+// events:
+//  - debounce: a level has to be stable for Debounce_ms before it counts; shorter pulses are rejected as glitches
+//  - hold:     presence is only released after the input has been inactive for Hold_ms, so a person moving in front of the sensor does not
+//              toggle it
+// Events carry the time of the edge that started them, not the time they were confirmed.
+class Pir
+{
+  enum
+  {
+    QueueDepth = 16,
+  };
+
+  struct Edge
+  {
+    uint64_t Time_us;
+    bool     Level;
+  };
+
+  using TTimer = common::delta::StartStopTimer<>;
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Debounce_ms = 50,
+    Hold_ms     = 2000,
+  };
+
+  struct Event
+  {
+    uint64_t Time_us;
+    bool     Active;
+  };
+
+  Pir(uint8_t pin, rtos::Wakeup& wakeup) : Pin(pin), Waker(wakeup)
+  {
+    pinMode(Pin, INPUT);
+    Raw      = digitalRead(Pin);
+    Since_us = now();
+    Settle.start(Debounce);   // reports presence at startup if the input is already active
+    attachInterruptArg(digitalPinToInterrupt(Pin), isr, this, CHANGE);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void configure(uint32_t debounce_ms, uint32_t hold_ms)
+  {
+    Debounce = debounce_ms;
+    Hold     = hold_ms;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // consumes the queued edges; returns true and fills 'event' when the presence state changed
+  bool operator()(Event& event)
+  {
+    Edge edge;
+    while (Edges.pop(edge))
+    {
+      if (edge.Level == Raw)
+      {
+        continue;   // repeated level (edges lost or merged)
+      }
+      Raw = edge.Level;
+
+      if (Settle.running())
+      {
+        ++Glitches; // the previous level did not last long enough
+      }
+
+      Since_us = edge.Time_us;
+      Settle.start(Debounce);
+    }
+
+    // edges were lost: the pin itself is the truth
+    if (Edges.overflows() != Lost)
+    {
+      Lost = Edges.overflows();
+      Raw  = digitalRead(Pin);
+      Settle.start(Debounce);
+    }
+
+    if (Settle())
+    {
+      Settle.stop();
+
+      if (Raw)
+      {
+        Release.stop();
+        if (!Active)
+        {
+          return report(event, Since_us, true);
+        }
+      }
+      else if (Active)
+      {
+        Released_us = Since_us;
+        Release.start(Hold);
+      }
+    }
+
+    if (Release())
+    {
+      Release.stop();
+      return report(event, Released_us, false);
+    }
+
+    return false;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // time until the next pending decision (debounce or hold), Deadline::Never if there is none
+  uint32_t due() const
+  {
+    uint32_t settle  = Settle.remaining();
+    uint32_t release = Release.remaining();
+    return (settle < release) ? settle : release;
+  }
+
+  bool     active() const    { return Active;            }
+  uint32_t glitches() const  { return Glitches;          }
+  uint32_t lost() const      { return Edges.overflows(); }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static void IRAM_ATTR isr(void* self)
+  {
+    auto& pir = *static_cast<Pir*>(self);
+    bool  level = digitalRead(pir.Pin);
+
+    trace::Trace::instant(trace::Id::Pir, level);
+    pir.Edges.push({now(), level});
+    pir.Waker.notifyFromIsr();
+  }
+
+  static uint64_t IRAM_ATTR now()
+  {
+    return common::delta::MonotonicSource<1>::micros64();
+  }
+
+  bool report(Event& event, uint64_t time_us, bool active)
+  {
+    Active = active;
+    event  = {time_us, active};
+    return true;
+  }
+
+  uint8_t       Pin;
+  rtos::Wakeup& Waker;
+
+  rtos::SpscQueue<Edge, QueueDepth> Edges;   // ISR -> task
+  uint32_t      Lost        = 0;
+
+  uint32_t      Debounce    = Debounce_ms;
+  uint32_t      Hold        = Hold_ms;
+  TTimer        Settle;
+  TTimer        Release;
+
+  bool          Raw         = false;         // level after the last edge
+  bool          Active      = false;         // reported presence
+  uint64_t      Since_us    = 0;             // time of the last edge
+  uint64_t      Released_us = 0;             // time presence ended (before the hold)
+  uint32_t      Glitches    = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::input
+
+#endif // INPUT_PIR_INCLUDED_HPP
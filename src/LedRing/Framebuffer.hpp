@@ -0,0 +1,134 @@
+#ifndef LED_FRAMEBUFFER_INCLUDED_HPP
+#define LED_FRAMEBUFFER_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace dps { namespace led {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+struct Pixel
+{
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+  uint8_t A;   // coverage, 0: transparent
+};
+
+// how a layer is combined with the layers beneath it
+enum class Blend : uint8_t
+{
+  Replace,   // covered pixels replace what is beneath (faded by opacity only, not by coverage)
+  Add,       // added, saturating (weighted by coverage and opacity)
+  Alpha,     // mixed by coverage and opacity
+};
+
+
+//==============================================================================================================================================================
+// Pixels an effect draws into; the same drawing calls as Adafruit_NeoPixel, so effects do not care whether they paint the strip or a layer.
+// A drawn pixel is opaque, cleared pixels are transparent and let the layers beneath show through.
+class Framebuffer
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  Framebuffer(Pixel* pixels, uint16_t size) : Pixels(pixels), Size(size) {}
+
+  Framebuffer(Framebuffer const&)            = delete;
+  Framebuffer& operator=(Framebuffer const&) = delete;
+
+  void setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b)
+  {
+    Pixels[i] = { r, g, b, 0xFF };
+  }
+
+  void fill(Pixel pixel)
+  {
+    for (uint16_t i = 0; i < Size; ++i)
+    {
+      Pixels[i] = pixel;
+    }
+  }
+
+  void clear()                               { fill({ 0, 0, 0, 0 }); }
+
+  uint16_t     numPixels() const             { return Size;      }
+  Pixel const& operator[](uint16_t i) const  { return Pixels[i]; }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // combines 'layer' (same size) onto this buffer; opacity 0..255 scales the layer's coverage
+  void blend(Framebuffer const& layer, Blend mode, uint8_t opacity)
+  {
+    for (uint16_t i = 0; i < Size; ++i)
+    {
+      Pixel const& src = layer.Pixels[i];
+      Pixel&       dst = Pixels[i];
+      uint32_t     a   = src.A ? (((src.A + 1u) * (opacity + 1u)) >> 8) : 0;   // 0..256, 256 = fully covered
+
+      switch (mode)
+      {
+      case Blend::Replace:
+        if (src.A)
+        {
+          uint32_t o = opacity + (opacity >> 7);   // 0..256
+          dst        = Pixel{ mix(dst.R, src.R, o), mix(dst.G, src.G, o), mix(dst.B, src.B, o), 0xFF };
+        }
+        break;
+
+      case Blend::Add:
+        dst.R = add(dst.R, src.R, a);
+        dst.G = add(dst.G, src.G, a);
+        dst.B = add(dst.B, src.B, a);
+        break;
+
+      case Blend::Alpha:
+        dst.R = mix(dst.R, src.R, a);
+        dst.G = mix(dst.G, src.G, a);
+        dst.B = mix(dst.B, src.B, a);
+        break;
+      }
+    }
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static uint8_t add(uint32_t dst, uint32_t src, uint32_t a)
+  {
+    uint32_t sum = dst + ((src * a) >> 8);
+    return (sum < 0xFF) ? sum : 0xFF;
+  }
+
+  static uint8_t mix(int32_t dst, int32_t src, int32_t a)
+  {
+    return dst + (((src - dst) * a) >> 8);
+  }
+
+  Pixel*   Pixels;
+  uint16_t Size;
+};
+
+
+//==============================================================================================================================================================
+// Framebuffer with its own pixels
+template <uint16_t NrPixels>
+class FramebufferN : public Framebuffer
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  FramebufferN() : Framebuffer(Storage, NrPixels) {}
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  Pixel Storage[NrPixels] = {};
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::led
+
+#endif // LED_FRAMEBUFFER_INCLUDED_HPP
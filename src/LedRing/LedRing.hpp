@@ -1,9 +1,14 @@
 #ifndef LED_RING_INCLUDED_HPP
 #define LED_RING_INCLUDED_HPP
 
-#include <memory> 
+#include <variant>
+#include <string_view>
 #include <Adafruit_NeoPixel.h>
 #include "Delta/TimeDelta.hpp"
+#include "Delta/Deadline.hpp"
+#include "Trace/Trace.hpp"
+#include "Protocol/NameMap.hpp"
+#include "Framebuffer.hpp"
 #include "fx/ILedFx.hpp"
 #include "fx/Activate.hpp"
 #include "fx/Deactivate.hpp"
@@ -13,6 +18,10 @@ namespace dps { namespace led {
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
 
 //==============================================================================================================================================================
+// LED ring as a compositor of effect layers.
+// Every layer runs its own effect into its own framebuffer; whenever one of them rendered a frame, the layers are blended bottom-up by
+// priority (see Framebuffer::blend()) and the result is shown. An effect that finishes clears its layer (unless it keeps its last frame,
+// see ILedFX::keepsFrame()), which reveals the layers beneath it instead of leaving its last frame on the ring.
 class LedRing : public Adafruit_NeoPixel
 {
   enum
@@ -20,18 +29,70 @@ class LedRing : public Adafruit_NeoPixel
     NrPixels = 12
   };
 
-  using TFx = std::unique_ptr<fx::ILedFX>;
+  // every effect in place, switching effects does not touch the heap
+  using TFx    = std::variant<std::monostate, fx::Activate, fx::Deactivate, fx::Status>;
+  using TFrame = FramebufferN<NrPixels>;
 
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
+  enum class Effect : uint8_t
+  {
+    Activate,
+    Deactivate,
+    Pass,
+    Fail,
+  };
+
+  // bottom to top by default
+  enum class Layer : uint8_t
+  {
+    Idle,
+    Presence,
+    Status,
+    Alert,
+  };
+
+  enum
+  {
+    NrLayers = 4
+  };
+
+  // fixed-size command that can be handed to the render task through a queue
+  struct Command
+  {
+    enum class Kinds : uint8_t
+    {
+      Effect,
+      Brightness,
+      Opacity,     // of Layer, 0..255
+      Blend,       // of Layer, see led::Blend
+      Priority,    // of Layer, higher is on top
+    };
+
+    Kinds    Kind;
+    uint32_t Value;
+    Layer    Target = Layer::Idle;
+  };
+
   LedRing(uint8_t pin) : Adafruit_NeoPixel(NrPixels, pin, NEO_GRB + NEO_KHZ800)
   {
     begin();
     setBrightness(50);
     show(); // Initialize all pixels to 'off'
+
+    for (size_t i = 0; i < NrLayers; ++i)
+    {
+      Layers[i].Priority = static_cast<uint8_t>(i);
+      Order[i]           = static_cast<uint8_t>(i);
+    }
+    Layers[static_cast<size_t>(Layer::Status)].Mode = Blend::Alpha;
+    Layers[static_cast<size_t>(Layer::Alert)].Mode  = Blend::Alpha;
   }
 
+  LedRing(LedRing const&)            = delete;   // the layers' effects point into the object
+  LedRing& operator=(LedRing const&) = delete;
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   bool operator=(uint32_t brightness)
   {
@@ -40,58 +101,237 @@ public:
   }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-  bool operator=(std::string const& fx)
+  // starts the effect on its layer: presence effects below status flashes
+  bool operator=(Effect effect)
   {
-    if      (fx == "activate")
+    switch (effect)
     {
-      CurrentFx = TFx(new fx::Activate(*this, Brightness));
-    }
-    else if (fx == "deactivate")
-    {
-      CurrentFx = TFx(new fx::Deactivate(*this, Brightness));
+    case Effect::Activate:
+      start<fx::Activate>(Layer::Presence, Brightness);
+      break;
+
+    case Effect::Deactivate:
+      start<fx::Deactivate>(Layer::Presence, Brightness);
+      break;
+
+    case Effect::Pass:
+      start<fx::Status>(Layer::Status, 0, Brightness, 0);
+      break;
+
+    case Effect::Fail:
+      start<fx::Status>(Layer::Status, Brightness, 0, 0);
+      break;
+
+    default:
+      return false;
     }
-    else if (fx == "pass")
+
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool operator=(std::string_view fx)
+  {
+    Effect effect;
+    return lookup(fx, effect) && (*this = effect);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool operator=(Command const& command)
+  {
+    auto& layer = Layers[static_cast<size_t>(command.Target)];
+
+    switch (command.Kind)
     {
-      CurrentFx = TFx(new fx::Status(*this, 0, Brightness, 0));
+    case Command::Kinds::Effect:
+      return *this = static_cast<Effect>(command.Value);
+
+    case Command::Kinds::Brightness:
+      return *this = command.Value;
+
+    case Command::Kinds::Opacity:
+      layer.Opacity = static_cast<uint8_t>(command.Value);
+      Dirty         = true;
+      return true;
+
+    case Command::Kinds::Blend:
+      layer.Mode = static_cast<Blend>(command.Value);
+      Dirty      = true;
+      return true;
+
+    case Command::Kinds::Priority:
+      layer.Priority = static_cast<uint8_t>(command.Value);
+      sort();
+      return true;
     }
-    else if (fx == "fail")
+    return false;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  static bool lookup(std::string_view fx, Effect& effect)
+  {
+    static constexpr auto Effects = protocol::makeNameMap<Effect>({
+      { "activate",   Effect::Activate   },
+      { "deactivate", Effect::Deactivate },
+      { "pass",       Effect::Pass       },
+      { "fail",       Effect::Fail       },
+    });
+
+    return Effects.find(fx, effect);
+  }
+
+  static bool lookup(std::string_view name, Layer& layer)
+  {
+    static constexpr auto Names = protocol::makeNameMap<Layer>({
+      { "idle",     Layer::Idle     },
+      { "presence", Layer::Presence },
+      { "status",   Layer::Status   },
+      { "alert",    Layer::Alert    },
+    });
+
+    return Names.find(name, layer);
+  }
+
+  static bool lookup(std::string_view name, Blend& mode)
+  {
+    static constexpr auto Modes = protocol::makeNameMap<Blend>({
+      { "replace", Blend::Replace },
+      { "add",     Blend::Add     },
+      { "alpha",   Blend::Alpha   },
+    });
+
+    return Modes.find(name, mode);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // renders every due layer and shows the composite if anything changed; returns true if no effect is running
+  bool operator()()
+  {
+    bool running = false;
+
+    for (auto& layer : Layers)
     {
-      CurrentFx = TFx(new fx::Status(*this, Brightness, 0, 0));
+      if (!layer.Fx)
+      {
+        continue;
+      }
+
+      if (layer.SinceFrame.get() >= layer.NextFrame_ms)
+      {
+        layer.SinceFrame.reset();
+        Dirty = true;
+
+        trace::Span span(trace::Id::Fx);
+        if ((*layer.Fx)())
+        {
+          // Effekt fertig ausgeführt
+          stop(layer);
+          continue;
+        }
+        layer.NextFrame_ms = layer.Fx->due();
+      }
+      running = true;
     }
-    else
+
+    if (Dirty)
     {
-      return false;
+      Dirty = false;
+      compose();
     }
 
-    return true;
+    return !running;
   }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-  bool operator()()
+  // time [ms] until the next frame has to be rendered
+  uint32_t due() const
   {
-    if (CurrentFx)
+    common::delta::Deadline next(Dirty ? 0 : uint32_t(common::delta::Deadline::Never));
+    for (auto const& layer : Layers)
     {
-      if ((*CurrentFx)())
+      if (layer.Fx)
       {
-        // Effekt fertig ausgeführt
-        CurrentFx.release();
+        next.at(common::delta::Deadline::until(layer.SinceFrame.get(), layer.NextFrame_ms));
       }
-      return false;
     }
-
-    return true;
+    return next.remaining();
   }
 
-
-
 //==============================================================================================================================================================
 private:
 //==============================================================================================================================================================
-  // Input a value 0 to 255 to get a color value.
-  // The colours are a transition r - g - b - back to r.
-  TFx      CurrentFx;
-  uint32_t Brightness = 100;
+  struct Slot
+  {
+    TFx                        Current;
+    fx::ILedFX*                Fx           = nullptr;   // running alternative of Current
+    TFrame                     Frame;
+    bool                       Visible      = false;
+    uint8_t                    Priority     = 0;
+    uint8_t                    Opacity      = 0xFF;
+    Blend                      Mode         = Blend::Replace;
+    common::delta::TimeDelta<> SinceFrame;
+    uint32_t                   NextFrame_ms = 0;
+  };
+
+  // replaces the running effect of the layer (destroyed in place) by a new one, drawing on a clear layer
+  template <typename TEffect, typename... TArgs>
+  void start(Layer target, TArgs... args)
+  {
+    auto& layer = Layers[static_cast<size_t>(target)];
+    layer.Frame.clear();
+    layer.Fx           = &layer.Current.template emplace<TEffect>(layer.Frame, args...);
+    layer.Visible      = true;
+    layer.NextFrame_ms = 0;
+  }
+
+  void stop(Slot& layer)
+  {
+    layer.Visible = layer.Fx->keepsFrame();
+    layer.Fx      = nullptr;
+    layer.Current.template emplace<std::monostate>();
+  }
 
+  // layer indices bottom-up by priority, stable for equal ones
+  void sort()
+  {
+    for (size_t i = 1; i < NrLayers; ++i)
+    {
+      uint8_t index = Order[i];
+      size_t  k     = i;
+      for (; k && (Layers[Order[k - 1]].Priority > Layers[index].Priority); --k)
+      {
+        Order[k] = Order[k - 1];
+      }
+      Order[k] = index;
+    }
+    Dirty = true;
+  }
+
+  void compose()
+  {
+    Composite.fill({ 0, 0, 0, 0xFF });
+    for (auto index : Order)
+    {
+      auto const& layer = Layers[index];
+      if (layer.Visible)
+      {
+        Composite.blend(layer.Frame, layer.Mode, layer.Opacity);
+      }
+    }
+
+    for (uint16_t i = 0; i < NrPixels; ++i)
+    {
+      setPixelColor(i, Composite[i].R, Composite[i].G, Composite[i].B);
+    }
+    trace::Span span(trace::Id::Show);
+    show();
+  }
+
+  Slot     Layers[NrLayers];
+  uint8_t  Order[NrLayers];       // bottom-up
+  TFrame   Composite;
+  bool     Dirty      = false;    // composite out of date
+  uint32_t Brightness = 100;
 };
 
 
@@ -3,8 +3,9 @@
 
 #include <algorithm>
 #include "ILedFx.hpp"
+#include "LedRing/Framebuffer.hpp"
 #include "Statemachine/TimedStatemachine.hpp"
-#include <Adafruit_NeoPixel.h>
+#include "Trace/Trace.hpp"
 
 namespace dps { namespace led { namespace fx {
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
@@ -23,7 +24,7 @@ class Activate : public ILedFX
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
-  Activate(Adafruit_NeoPixel& parent, uint32_t brightness) : Parent(parent), Brightness(brightness)
+  Activate(Framebuffer& parent, uint32_t brightness) : Parent(parent), Brightness(brightness)
   {
   }
 
@@ -31,7 +32,13 @@ public:
   bool operator()() override
   {
     do {
-      switch (Machine())
+      auto state = Machine();
+      if (Machine.stateEntry())
+      {
+        trace::Trace::instant(trace::Id::FxState, static_cast<uint8_t>(state));
+      }
+
+      switch (state)
       {
       // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
       case States::Fade:
@@ -48,7 +55,6 @@ public:
 
             t          -= BlueStep_ms;
           }
-          Parent.show();
           
           if (d >= (WhiteFade_ms + WhiteDelay_ms))
           {
@@ -66,6 +72,18 @@ public:
     return Machine.currentState() == States::Finished;
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint32_t due() const override
+  {
+    return (Machine.currentState() == States::Fade) ? uint32_t(Frame_ms) : 0;
+  }
+
+  // the light stays on until Deactivate
+  bool keepsFrame() const override
+  {
+    return true;
+  }
+
 //==============================================================================================================================================================
 private:
 //==============================================================================================================================================================
@@ -76,7 +94,7 @@ private:
   };
   common::TimedStatemachine<States> Machine;
 
-  Adafruit_NeoPixel& Parent;
+  Framebuffer&       Parent;
   int32_t            Brightness;
 };
 
@@ -3,8 +3,9 @@
 
 #include <algorithm>
 #include "ILedFx.hpp"
+#include "LedRing/Framebuffer.hpp"
 #include "Statemachine/TimedStatemachine.hpp"
-#include <Adafruit_NeoPixel.h>
+#include "Trace/Trace.hpp"
 
 namespace dps { namespace led { namespace fx {
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
@@ -23,7 +24,7 @@ class Deactivate : public ILedFX
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
-  Deactivate(Adafruit_NeoPixel& parent, uint32_t brightness) : Parent(parent), Brightness(brightness)
+  Deactivate(Framebuffer& parent, uint32_t brightness) : Parent(parent), Brightness(brightness)
   {
   }
 
@@ -31,7 +32,13 @@ public:
   bool operator()() override
   {
     do {
-      switch (Machine())
+      auto state = Machine();
+      if (Machine.stateEntry())
+      {
+        trace::Trace::instant(trace::Id::FxState, static_cast<uint8_t>(state));
+      }
+
+      switch (state)
       {
       // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
       case States::Fade:
@@ -47,7 +54,6 @@ public:
 
             t -= BlueStep_ms;
           }
-          Parent.show();
           
           if (d >= (FadeOff_ms + WhiteDelay_ms))
           {
@@ -65,6 +71,12 @@ public:
     return Machine.currentState() == States::Finished;
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint32_t due() const override
+  {
+    return (Machine.currentState() == States::Fade) ? uint32_t(Frame_ms) : 0;
+  }
+
 //==============================================================================================================================================================
 private:
 //==============================================================================================================================================================
@@ -75,7 +87,7 @@ private:
   };
   common::TimedStatemachine<States> Machine;
 
-  Adafruit_NeoPixel& Parent;
+  Framebuffer&       Parent;
   int32_t            Brightness;
 };
 
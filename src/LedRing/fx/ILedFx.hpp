@@ -1,6 +1,8 @@
 #ifndef ILEDFX_INCLUDED_HPP
 #define ILEDFX_INCLUDED_HPP
 
+#include <stdint.h>
+
 namespace dps { namespace led { namespace fx {
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
 
@@ -10,11 +12,22 @@ class ILedFX
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Frame_ms = 10,
+  };
+
   virtual ~ILedFX()
   {};
 
   virtual bool operator()() = 0;
-  
+
+  // time [ms] until the effect has to be rendered again
+  virtual uint32_t due() const = 0;
+
+  // finished effect: true keeps its last frame on its layer, false clears the layer so the ones beneath show through
+  virtual bool keepsFrame() const { return false; }
+
 };
 
 
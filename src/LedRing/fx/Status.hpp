@@ -3,8 +3,9 @@
 
 #include <algorithm>
 #include "ILedFx.hpp"
+#include "LedRing/Framebuffer.hpp"
 #include "Statemachine/TimedStatemachine.hpp"
-#include <Adafruit_NeoPixel.h>
+#include "Trace/Trace.hpp"
 
 namespace dps { namespace led { namespace fx {
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
@@ -21,7 +22,7 @@ class Status : public ILedFX
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
-  Status(Adafruit_NeoPixel& parent, uint32_t r, uint32_t g, uint32_t b, uint32_t stay_ms = 1000) : Parent(parent), R(r), G(g), B(b), Stay_ms(stay_ms)
+  Status(Framebuffer& parent, uint32_t r, uint32_t g, uint32_t b, uint32_t stay_ms = 1000) : Parent(parent), R(r), G(g), B(b), Stay_ms(stay_ms)
   {
   }
 
@@ -29,14 +30,20 @@ public:
   bool operator()() override
   {
     do {
-      switch (Machine())
+      auto state = Machine();
+      if (Machine.stateEntry())
+      {
+        trace::Trace::instant(trace::Id::FxState, static_cast<uint8_t>(state));
+      }
+
+      switch (state)
       {
       // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
       case States::FadeIn:
         {
           int t = Machine.dwell();
 
-          auto fade_pph256 = (t * 256) / Fade_ms;
+          auto fade_pph256 = (std::min(t, (int)Fade_ms) * 256) / Fade_ms;   // the last frame may come late
 
           for (auto i = 0; i < Parent.numPixels(); ++i)
           {
@@ -46,7 +53,6 @@ public:
 
             Parent.setPixelColor(i, r, g, b);
           }
-          Parent.show();
           
           if (t >= Fade_ms)
           {
@@ -69,7 +75,7 @@ public:
         {
           int t = Machine.dwell();
 
-          auto fade_pph256 = (t * 256) / Fade_ms;
+          auto fade_pph256 = (std::min(t, (int)Fade_ms) * 256) / Fade_ms;
 
           for (auto i = 0; i < Parent.numPixels(); ++i)
           {
@@ -79,7 +85,6 @@ public:
 
             Parent.setPixelColor(i, r, g, b);
           }
-          Parent.show();
           
           if (t >= Fade_ms)
           {
@@ -96,6 +101,23 @@ public:
     return Machine.currentState() == States::Finished;
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint32_t due() const override
+  {
+    switch (Machine.currentState())
+    {
+    case States::FadeIn:
+    case States::FadeOut:
+      return Frame_ms;
+
+    case States::Stay:
+      return Machine.remaining(Stay_ms);
+
+    default:
+      return 0;
+    }
+  }
+
 //==============================================================================================================================================================
 private:
 //==============================================================================================================================================================
@@ -113,7 +135,7 @@ private:
   };
   common::TimedStatemachine<States> Machine;
 
-  Adafruit_NeoPixel& Parent;
+  Framebuffer&       Parent;
 
   uint32_t R;
   uint32_t G;
@@ -0,0 +1,139 @@
+#ifndef PROTOCOL_CLOCK_SYNC_INCLUDED_HPP
+#define PROTOCOL_CLOCK_SYNC_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Estimate of the host clock in terms of the device clock (both in us), maintained from NTP style exchanges:
+//
+//   t0  host sends ping      (host clock)
+//   t1  device receives it   (device clock)
+//   t2  device replies       (device clock)
+//   t3  host receives reply  (host clock)
+//
+// Each exchange yields a round trip time and an offset sample at its midpoint. Samples with a round trip well above the best recent one are
+// assumed to be delayed asymmetrically and are not used. Offset and skew (drift) are tracked by a simple phase/frequency loop.
+// An offset error beyond MaxError_us means the host clock was stepped (or the host restarted): the estimate starts over from that sample.
+class ClockSync
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Slack_us      = 500,        // accepted round trip above the best one
+    MinSpan_us    = 1000000,    // minimum distance between samples to correct the skew
+    MaxSkew_ppb   = 500000,     // crystal tolerance plus margin (500 ppm)
+    MaxError_us   = 1000000,    // larger offset errors restart the estimate
+    Aging_us      = 16000000,   // the best round trip grows by itself within this time (device clock)
+  };
+
+  // processes one exchange; returns false if it was not used for the estimate (round trip too long or inconsistent)
+  bool sample(uint64_t t0, uint64_t t1, uint64_t t2, uint64_t t3)
+  {
+    uint32_t rtt;
+    if (!roundTrip(t0, t1, t2, t3, rtt))
+    {
+      return false;
+    }
+    LastRtt = rtt;
+
+    uint64_t host   = t0 + (t3 - t0) / 2;
+    uint64_t device = t1 + (t2 - t1) / 2;
+
+    // let the best round trip age with the time since the last exchange, so a permanently slower link is accepted again whatever the
+    // exchange rate
+    uint64_t age = Synced ? (device - LastSample) : 0;
+    LastSample   = device;
+    BestRtt      = ((LastRtt < BestRtt) || !Synced) ? LastRtt : aged(BestRtt, age);
+    if (LastRtt > BestRtt + Slack_us + BestRtt / 2)
+    {
+      return false;
+    }
+
+    int64_t error = Synced ? static_cast<int64_t>(host - toHost(device)) : 0;
+    if (!Synced || (error > int64_t(MaxError_us)) || (error < -int64_t(MaxError_us)))
+    {
+      Synced     = true;
+      RefDevice  = device;
+      RefHost    = host;
+      Skew_ppb   = 0;
+      Restarts  += (error != 0);
+      return true;
+    }
+
+    uint64_t span = device - RefDevice;
+
+    // frequency: a quarter of the observed rate error, once the samples are far enough apart to be meaningful
+    if (span >= MinSpan_us)
+    {
+      Skew_ppb += static_cast<int32_t>(error * 1000000000LL / static_cast<int64_t>(span) / 4);
+      Skew_ppb  = (Skew_ppb > int32_t(MaxSkew_ppb)) ? int32_t(MaxSkew_ppb) : ((Skew_ppb < -int32_t(MaxSkew_ppb)) ? -int32_t(MaxSkew_ppb) : Skew_ppb);
+    }
+
+    // phase: half of the error
+    RefHost   = toHost(device) + error / 2;
+    RefDevice = device;
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // round trip time of an exchange; false if the timestamps are inconsistent (e.g. a host clock coarser than the device's processing time)
+  static bool roundTrip(uint64_t t0, uint64_t t1, uint64_t t2, uint64_t t3, uint32_t& rtt)
+  {
+    int64_t span = static_cast<int64_t>(t3 - t0) - static_cast<int64_t>(t2 - t1);
+    if ((span < 0) || (t3 < t0) || (t2 < t1))
+    {
+      return false;
+    }
+    rtt = static_cast<uint32_t>(span);
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // host time corresponding to a device timestamp; only meaningful if synced()
+  uint64_t toHost(uint64_t device) const
+  {
+    int64_t elapsed = static_cast<int64_t>(device - RefDevice);
+    return RefHost + elapsed + elapsed * Skew_ppb / 1000000000LL;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool     synced() const     { return Synced;   }
+  uint32_t rtt() const        { return LastRtt;  }   // of the last exchange
+  uint32_t bestRtt() const    { return BestRtt;  }
+  int32_t  skew() const       { return Skew_ppb; }   // device clock runs slow by this many ppb
+  uint32_t restarts() const   { return Restarts; }   // estimates dropped for a too large error
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // rtt grown by 1/Aging_us per elapsed us (at least 1 us), saturating
+  static uint32_t aged(uint32_t rtt, uint64_t age_us)
+  {
+    age_us = (age_us < Aging_us) ? age_us : uint64_t(Aging_us);
+    uint64_t grown = rtt + uint64_t(rtt) * age_us / Aging_us + 1;
+    return (grown < UINT32_MAX) ? static_cast<uint32_t>(grown) : UINT32_MAX;
+  }
+
+  bool     Synced     = false;
+  uint64_t RefDevice  = 0;
+  uint64_t RefHost    = 0;
+  uint64_t LastSample = 0;   // device time of the last exchange
+  int32_t  Skew_ppb   = 0;
+  uint32_t LastRtt    = 0;
+  uint32_t BestRtt    = 0;
+  uint32_t Restarts   = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_CLOCK_SYNC_INCLUDED_HPP
@@ -0,0 +1,84 @@
+#ifndef PROTOCOL_COBS_INCLUDED_HPP
+#define PROTOCOL_COBS_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace dps { namespace protocol { namespace cobs {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+// Consistent Overhead Byte Stuffing: removes every 0x00 from a packet, so 0x00 can delimit packets on the wire.
+// The encoded form is at most one byte per started 254 bytes longer than the input.
+
+//==============================================================================================================================================================
+// worst case size of the encoded form of 'length' bytes (without delimiter)
+constexpr size_t maxEncoded(size_t length)
+{
+  return length + length / 254 + 1;
+}
+
+//==============================================================================================================================================================
+// encodes 'length' bytes of src into dst (at least maxEncoded(length) bytes), returns the encoded length
+inline size_t encode(uint8_t const* src, size_t length, uint8_t* dst)
+{
+  size_t  codePos = 0;
+  size_t  out     = 1;
+  uint8_t code    = 1;
+
+  for (size_t in = 0; in < length; ++in)
+  {
+    if (src[in] == 0)
+    {
+      dst[codePos] = code;
+      codePos      = out++;
+      code         = 1;
+    }
+    else
+    {
+      dst[out++] = src[in];
+      if (++code == 0xFF)
+      {
+        dst[codePos] = code;
+        codePos      = out++;
+        code         = 1;
+      }
+    }
+  }
+  dst[codePos] = code;
+
+  return out;
+}
+
+//==============================================================================================================================================================
+// decodes 'length' bytes of src (without delimiter) into dst; dst may equal src (in-place decoding)
+// @return decoded length, 0 for malformed input
+inline size_t decode(uint8_t const* src, size_t length, uint8_t* dst)
+{
+  size_t in  = 0;
+  size_t out = 0;
+
+  while (in < length)
+  {
+    uint8_t code = src[in++];
+    if ((code == 0) || (in + code - 1 > length))
+    {
+      return 0;
+    }
+
+    for (uint8_t i = 1; i < code; ++i)
+    {
+      dst[out++] = src[in++];
+    }
+    if ((code < 0xFF) && (in < length))
+    {
+      dst[out++] = 0;
+    }
+  }
+
+  return out;
+}
+
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}}} // namespace dps::protocol::cobs
+
+#endif // PROTOCOL_COBS_INCLUDED_HPP
@@ -0,0 +1,64 @@
+#ifndef PROTOCOL_CRC16_INCLUDED_HPP
+#define PROTOCOL_CRC16_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection), byte-wise with a table built at compile time
+class Crc16
+{
+  using TTable = std::array<uint16_t, 256>;
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint16_t
+  {
+    Poly = 0x1021,
+    Init = 0xFFFF,
+  };
+
+  static uint16_t compute(uint8_t const* data, size_t length, uint16_t crc = Init)
+  {
+    for (size_t i = 0; i < length; ++i)
+    {
+      crc = static_cast<uint16_t>((crc << 8) ^ Table[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static constexpr TTable makeTable()
+  {
+    TTable table{};
+    for (uint32_t b = 0; b < 256; ++b)
+    {
+      uint16_t crc = static_cast<uint16_t>(b << 8);
+      for (int bit = 0; bit < 8; ++bit)
+      {
+        crc = static_cast<uint16_t>((crc & 0x8000) ? ((crc << 1) ^ Poly) : (crc << 1));
+      }
+      table[b] = crc;
+    }
+    return table;
+  }
+
+  static TTable const Table;
+};
+
+inline constexpr Crc16::TTable Crc16::Table = Crc16::makeTable();
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_CRC16_INCLUDED_HPP
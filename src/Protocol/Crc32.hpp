@@ -0,0 +1,67 @@
+#ifndef PROTOCOL_CRC32_INCLUDED_HPP
+#define PROTOCOL_CRC32_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// CRC-32 (IEEE 802.3, reflected poly 0xEDB88320, as zlib), byte-wise with a table built at compile time
+// compute() can be chained: crc = compute(next, size, crc)
+class Crc32
+{
+  using TTable = std::array<uint32_t, 256>;
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Poly = 0xEDB88320,
+  };
+
+  static uint32_t compute(void const* data, size_t length, uint32_t crc = 0)
+  {
+    auto bytes = static_cast<uint8_t const*>(data);
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i)
+    {
+      crc = (crc >> 8) ^ Table[(crc ^ bytes[i]) & 0xFF];
+    }
+    return ~crc;
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static constexpr TTable makeTable()
+  {
+    TTable table{};
+    for (uint32_t b = 0; b < 256; ++b)
+    {
+      uint32_t crc = b;
+      for (int bit = 0; bit < 8; ++bit)
+      {
+        crc = (crc & 1) ? ((crc >> 1) ^ Poly) : (crc >> 1);
+      }
+      table[b] = crc;
+    }
+    return table;
+  }
+
+  static TTable const Table;
+};
+
+inline constexpr Crc32::TTable Crc32::Table = Crc32::makeTable();
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_CRC32_INCLUDED_HPP
@@ -0,0 +1,83 @@
+#ifndef PROTOCOL_FRAME_INCLUDED_HPP
+#define PROTOCOL_FRAME_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Arduino.h>
+#include "Cobs.hpp"
+#include "Crc16.hpp"
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+// Binary packet framing used in binary protocol mode:
+//
+//   COBS( payload | crc16 little endian ) 0x00
+//
+// The CRC (see Crc16) covers the payload only.
+
+enum
+{
+  Delimiter = 0x00,
+  CrcSize   = 2,
+};
+
+//==============================================================================================================================================================
+// decodes a received frame (without its delimiter) in place
+// @return payload length, 0 for malformed frames or CRC mismatch
+inline size_t unframe(uint8_t* frame, size_t length)
+{
+  size_t decoded = cobs::decode(frame, length, frame);
+  if (decoded <= CrcSize)
+  {
+    return 0;
+  }
+
+  size_t   payload = decoded - CrcSize;
+  uint16_t crc     = static_cast<uint16_t>(frame[payload] | (frame[payload + 1] << 8));
+  return (Crc16::compute(frame, payload) == crc) ? payload : 0;
+}
+
+
+//==============================================================================================================================================================
+// Builds and writes frames of up to MaxPayload bytes. Holds the scratch buffers, so nothing is allocated per packet.
+template <size_t MaxPayload>
+class FrameWriter
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : size_t
+  {
+    MaxFrame = cobs::maxEncoded(MaxPayload + CrcSize) + 1,
+  };
+
+  // buffer the payload has to be written to before calling send()
+  uint8_t* payload()                 { return Payload;    }
+  static constexpr size_t capacity() { return MaxPayload; }
+
+  // frames the first 'length' bytes of payload() and writes them to 'out'
+  void send(size_t length, Print& out)
+  {
+    uint16_t crc        = Crc16::compute(Payload, length);
+    Payload[length]     = static_cast<uint8_t>(crc);
+    Payload[length + 1] = static_cast<uint8_t>(crc >> 8);
+
+    size_t size   = cobs::encode(Payload, length + CrcSize, Frame);
+    Frame[size++] = Delimiter;
+    out.write(Frame, size);
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  uint8_t Payload[MaxPayload + CrcSize];
+  uint8_t Frame[MaxFrame];
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_FRAME_INCLUDED_HPP
@@ -0,0 +1,83 @@
+#ifndef PROTOCOL_HEX_INCLUDED_HPP
+#define PROTOCOL_HEX_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string_view>
+
+namespace dps { namespace protocol { namespace hex {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+// Table driven lower case hex encoding into caller provided buffers, and the matching decoder (either case).
+
+//==============================================================================================================================================================
+// buffer size needed to encode 'length' bytes including the terminating '\0'
+constexpr size_t encodedSize(size_t length)
+{
+  return 2 * length + 1;
+}
+
+//==============================================================================================================================================================
+// writes the two digits of 'value' to out, returns the position behind them
+inline char* encode(uint8_t value, char* out)
+{
+  static constexpr char Digits[] = "0123456789abcdef";
+
+  out[0] = Digits[value >> 4];
+  out[1] = Digits[value & 0x0F];
+  return out + 2;
+}
+
+//==============================================================================================================================================================
+// encodes 'length' bytes into out (at least encodedSize(length) chars) and '\0'-terminates it
+// @return number of digits written
+inline size_t encode(uint8_t const* data, size_t length, char* out)
+{
+  char* pos = out;
+  for (size_t i = 0; i < length; ++i)
+  {
+    pos = encode(data[i], pos);
+  }
+  *pos = '\0';
+
+  return pos - out;
+}
+
+//==============================================================================================================================================================
+// value of a hex digit, -1 for anything else
+constexpr int nibble(char c)
+{
+  return ((c >= '0') && (c <= '9')) ? (c - '0')
+       : ((c >= 'a') && (c <= 'f')) ? (c - 'a' + 10)
+       : ((c >= 'A') && (c <= 'F')) ? (c - 'A' + 10)
+       : -1;
+}
+
+//==============================================================================================================================================================
+// decodes a string of hex digit pairs into out
+// @return number of bytes, 0 if the text is empty, malformed or longer than 'capacity' bytes
+inline size_t decode(std::string_view text, uint8_t* out, size_t capacity)
+{
+  size_t length = text.size() / 2;
+  if ((text.size() & 1) || (length > capacity))
+  {
+    return 0;
+  }
+
+  for (size_t i = 0; i < length; ++i)
+  {
+    int high = nibble(text[2 * i]);
+    int low  = nibble(text[2 * i + 1]);
+    if ((high | low) < 0)
+    {
+      return 0;
+    }
+    out[i] = static_cast<uint8_t>((high << 4) | low);
+  }
+  return length;
+}
+
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}}} // namespace dps::protocol::hex
+
+#endif // PROTOCOL_HEX_INCLUDED_HPP
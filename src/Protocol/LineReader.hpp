@@ -0,0 +1,152 @@
+#ifndef PROTOCOL_LINE_READER_INCLUDED_HPP
+#define PROTOCOL_LINE_READER_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <Arduino.h>
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Fixed-capacity, allocation-free line discipline for a serial stream.
+// Incoming bytes are read in bulk into a static buffer. Every complete line is handed out in place, '\0'-terminated and without its line end,
+// so it can be parsed without copying (e.g. by ArduinoJson's zero-copy mode). Lines are kept contiguous, the unfinished tail is moved to the
+// front of the buffer after each read.
+// Lines that do not fit into the buffer are discarded up to their terminating delimiter and reported once via the overflow callback.
+// The delimiter is '\n' by default (a preceding '\r' is stripped) and can be switched at runtime, e.g. to 0x00 for COBS framed packets.
+// A switch from within onLine applies to the bytes after that line, so commands pipelined behind a mode change are kept; echo likewise.
+template <size_t Capacity>
+class LineReader
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  // reads everything available and calls onLine(char* line, size_t length) for every complete line, onOverflow() for every over-long one
+  // the received bytes are echoed to 'echo' if enabled
+  template <typename TLine, typename TOverflow>
+  void poll(Stream& stream, Print& echo, TLine&& onLine, TOverflow&& onOverflow)
+  {
+    int available;
+    while ((available = stream.available()) > 0)
+    {
+      size_t space = Capacity - Fill;
+      size_t count = stream.readBytes(Buffer + Fill, (static_cast<size_t>(available) < space) ? available : space);
+      if (!count)
+      {
+        break;
+      }
+
+      scan(count, echo, onLine, onOverflow);
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void     setEcho(bool echo)  { Echo = echo;      }
+  bool     echo() const        { return Echo;      }
+
+  // may be called from within onLine: the bytes after the current line are split by the new delimiter; an unfinished tail is searched
+  // again with the next poll
+  void     setDelimiter(char delimiter)
+  {
+    Delimiter  = delimiter;
+    Discarding = false;
+    Rescan     = true;
+  }
+  char     delimiter() const   { return Delimiter; }
+
+  uint32_t lines() const       { return Lines;     }
+  uint32_t overflows() const   { return Overflows; }
+
+  // unused buffer space, i.e. how many more bytes can be taken without overflowing
+  size_t   free() const        { return Capacity - Fill; }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // the new bytes are echoed line by line, so a line's handler may switch the echo for the following ones
+  template <typename TLine, typename TOverflow>
+  void scan(size_t count, Print& echo, TLine& onLine, TOverflow& onOverflow)
+  {
+    size_t start  = 0;
+    size_t pos    = Rescan ? 0 : Fill;
+    size_t echoed = Fill;
+    Fill         += count;
+    Rescan        = false;
+
+    while (auto nl = static_cast<char*>(memchr(Buffer + pos, Delimiter, Fill - pos)))
+    {
+      size_t end = nl - Buffer;
+      if (end >= echoed)   // a rescan finds lines in bytes echoed before
+      {
+        if (Echo)
+        {
+          echo.write(reinterpret_cast<uint8_t const*>(Buffer + echoed), end + 1 - echoed);
+        }
+        echoed = end + 1;
+      }
+
+      if (Discarding)
+      {
+        Discarding = false;
+      }
+      else
+      {
+        size_t length = end - start;
+        if (length && (Delimiter == '\n') && (Buffer[end - 1] == '\r'))
+        {
+          --length;
+        }
+        Buffer[start + length] = '\0';
+
+        ++Lines;
+        onLine(Buffer + start, length);
+        Rescan = false;   // the rest is searched with the delimiter now in effect
+      }
+      start = pos = end + 1;
+    }
+
+    if (Echo && (echoed < Fill))
+    {
+      echo.write(reinterpret_cast<uint8_t const*>(Buffer + echoed), Fill - echoed);
+    }
+
+    if (Discarding)
+    {
+      // still inside an over-long line
+      Fill = 0;
+    }
+    else if (start)
+    {
+      memmove(Buffer, Buffer + start, Fill - start);
+      Fill -= start;
+    }
+    else if (Fill == Capacity)
+    {
+      ++Overflows;
+      Discarding = true;
+      Fill       = 0;
+      onOverflow();
+    }
+  }
+
+  char     Buffer[Capacity + 1];  // + '\0'
+  size_t   Fill       = 0;
+  bool     Discarding = false;
+  bool     Echo       = true;
+  char     Delimiter  = '\n';
+  bool     Rescan     = false;   // delimiter switched, the buffered tail has not been searched for it
+  uint32_t Lines      = 0;
+  uint32_t Overflows  = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_LINE_READER_INCLUDED_HPP
@@ -0,0 +1,195 @@
+#ifndef PROTOCOL_NAME_MAP_INCLUDED_HPP
+#define PROTOCOL_NAME_MAP_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string_view>
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+template <typename TValue>
+struct NameEntry
+{
+  std::string_view Name;
+  TValue           Value;
+};
+
+namespace detail {
+
+// called (at compile time) only if a table cannot be built, which makes the constant evaluation fail
+inline void duplicateName() {}
+inline void noPerfectHash() {}
+
+constexpr size_t pow2(size_t n)
+{
+  size_t p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+// seeded FNV-1a with a final avalanche
+constexpr uint32_t hash(std::string_view name, uint32_t seed)
+{
+  uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+  for (char c : name)
+  {
+    h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+  }
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  return h;
+}
+
+} // namespace detail
+
+
+//==============================================================================================================================================================
+// Immutable name -> value table with a perfect hash computed at compile time ("hash and displace"):
+// the names are spread over buckets by a first hash, then every bucket gets its own seed for a second hash which puts each of its names into a
+// free slot. A lookup hashes the name twice and does exactly one string compare, nothing is allocated.
+// Create with makeNameMap() as 'static constexpr', so all of the construction happens in the compiler.
+template <typename TValue, size_t N>
+class NameMap
+{
+  static_assert((N > 0) && (N < 255), "slot indices are stored as uint8_t");
+
+  enum : size_t
+  {
+    NrBuckets = detail::pow2(N),
+    NrSlots   = detail::pow2(2 * N),
+    MaxSeed   = 0xFFFF,
+  };
+
+  enum : uint8_t
+  {
+    Empty = 0xFF,
+  };
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  constexpr explicit NameMap(NameEntry<TValue> const (&entries)[N]) : Entries{}, Seeds{}, Slots{}
+  {
+    uint8_t sizes[NrBuckets] = {};
+    for (size_t i = 0; i < N; ++i)
+    {
+      Entries[i] = entries[i];
+      ++sizes[bucket(Entries[i].Name)];
+      for (size_t j = 0; j < i; ++j)
+      {
+        if (Entries[i].Name == Entries[j].Name) detail::duplicateName();
+      }
+    }
+    for (auto& slot : Slots)
+    {
+      slot = Empty;
+    }
+
+    // crowded buckets first, while most slots are still free
+    for (size_t size = N; size > 0; --size)
+    {
+      for (size_t b = 0; b < NrBuckets; ++b)
+      {
+        if (sizes[b] == size)
+        {
+          place(b);
+        }
+      }
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // @return the value registered for 'name', nullptr if there is none
+  constexpr TValue const* find(std::string_view name) const
+  {
+    uint8_t slot = Slots[this->slot(name, Seeds[bucket(name)])];
+    return ((slot != Empty) && (Entries[slot].Name == name)) ? &Entries[slot].Value : nullptr;
+  }
+
+  constexpr bool find(std::string_view name, TValue& value) const
+  {
+    auto found = find(name);
+    if (found)
+    {
+      value = *found;
+    }
+    return found;
+  }
+
+  static constexpr size_t size() { return N; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static constexpr size_t bucket(std::string_view name)
+  {
+    return detail::hash(name, 0) & (NrBuckets - 1);
+  }
+
+  static constexpr size_t slot(std::string_view name, uint16_t seed)
+  {
+    return detail::hash(name, seed) & (NrSlots - 1);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // finds a seed that puts all names of bucket b into free slots
+  constexpr void place(size_t b)
+  {
+    for (uint32_t seed = 1; seed < MaxSeed; ++seed)
+    {
+      bool fits = true;
+      for (size_t i = 0; fits && (i < N); ++i)
+      {
+        if (bucket(Entries[i].Name) == b)
+        {
+          auto& s = Slots[slot(Entries[i].Name, seed)];
+          fits    = (s == Empty);
+          if (fits)
+          {
+            s = static_cast<uint8_t>(i);
+          }
+        }
+      }
+
+      if (fits)
+      {
+        Seeds[b] = static_cast<uint16_t>(seed);
+        return;
+      }
+
+      // undo the partial placement
+      for (size_t i = 0; i < N; ++i)
+      {
+        auto& s = Slots[slot(Entries[i].Name, seed)];
+        if ((bucket(Entries[i].Name) == b) && (s == i))
+        {
+          s = Empty;
+        }
+      }
+    }
+    detail::noPerfectHash();
+  }
+
+  NameEntry<TValue> Entries[N];
+  uint16_t          Seeds[NrBuckets];
+  uint8_t           Slots[NrSlots];
+};
+
+
+//==============================================================================================================================================================
+// static constexpr auto Map = makeNameMap<Value>({ { "name", value }, ... });
+template <typename TValue, size_t N>
+constexpr NameMap<TValue, N> makeNameMap(NameEntry<TValue> const (&entries)[N])
+{
+  return NameMap<TValue, N>(entries);
+}
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_NAME_MAP_INCLUDED_HPP
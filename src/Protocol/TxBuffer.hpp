@@ -0,0 +1,168 @@
+#ifndef PROTOCOL_TX_BUFFER_INCLUDED_HPP
+#define PROTOCOL_TX_BUFFER_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <Arduino.h>
+
+namespace dps { namespace protocol {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Outgoing byte ring in front of a (slow) output such as the UART.
+// Messages are written through the Print interface and published as a whole with commit(). drain() only passes on as many bytes as the output
+// accepts without blocking (availableForWrite()), so writers never stall on a full UART.
+// Overflow policy: a message that does not fit completely is dropped completely; already committed messages are never touched, so the
+// receiver only ever sees whole messages. Drops are counted apart by cause: no room left (dropped()) or larger than the whole buffer
+// (oversized(), never sendable).
+// Not thread safe: writing and draining have to happen in the same task.
+template <size_t Capacity>
+class TxBuffer : public Print
+{
+  static_assert((Capacity & (Capacity - 1)) == 0, "TX buffer capacity must be a power of two");
+
+  enum : uint32_t
+  {
+    Mask = Capacity - 1,
+  };
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  size_t write(uint8_t c) override
+  {
+    ++Length;
+    if (Overflowed || (Pending - Tail >= Capacity))
+    {
+      Overflowed = true;
+      return 0;
+    }
+
+    Buffer[Pending++ & Mask] = c;
+    return 1;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  size_t write(uint8_t const* data, size_t size) override
+  {
+    Length += size;
+    if (Overflowed || (Pending - Tail + size > Capacity))
+    {
+      Overflowed = true;
+      return 0;
+    }
+
+    size_t offset = Pending & Mask;
+    size_t first  = (size < Capacity - offset) ? size : (Capacity - offset);
+    memcpy(Buffer + offset, data, first);
+    memcpy(Buffer,          data + first, size - first);
+    Pending += size;
+
+    return size;
+  }
+
+  using Print::write;
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // publishes everything written since the last commit, or drops all of it if any part did not fit
+  // @return false if the message was dropped
+  bool commit()
+  {
+    size_t length = Length;
+    Length        = 0;
+
+    if (Overflowed)
+    {
+      Overflowed = false;
+      Pending    = Head;
+      ++((length > Capacity) ? Oversized : Dropped);
+      return false;
+    }
+
+    Head = Pending;
+    if (Head - Tail > Peak)
+    {
+      Peak = Head - Tail;
+    }
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // drops what was written since the last commit and counts the message as oversized, for writers that find it too large before writing all
+  // of it (e.g. an encoder with a smaller buffer of its own)
+  void reject()
+  {
+    Overflowed = true;
+    Length     = Capacity + 1;
+    commit();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // hands committed bytes to 'out' as far as it takes them without blocking
+  void drain(Print& out)
+  {
+    while (Tail != Head)
+    {
+      int room = out.availableForWrite();
+      if (room <= 0)
+      {
+        break;
+      }
+
+      Tail += out.write(Buffer + (Tail & Mask), chunk(room));
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // writes all committed bytes, blocking if necessary (for bulk output that bypasses the buffer afterwards)
+  void flush(Print& out)
+  {
+    while (Tail != Head)
+    {
+      Tail += out.write(Buffer + (Tail & Mask), chunk(Capacity));
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  bool     empty() const    { return Tail == Head; }
+  size_t   size() const     { return Head - Tail;  }
+  uint32_t dropped() const  { return Dropped;      }
+  uint32_t oversized() const { return Oversized;   }
+  uint32_t peak() const     { return Peak;         }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // contiguous committed bytes at Tail, at most 'limit'
+  size_t chunk(size_t limit) const
+  {
+    size_t offset = Tail & Mask;
+    size_t size   = Head - Tail;
+    if (size > Capacity - offset)
+    {
+      size = Capacity - offset;
+    }
+    return (size < limit) ? size : limit;
+  }
+
+  uint8_t  Buffer[Capacity];
+  uint32_t Tail       = 0;      // next byte to drain
+  uint32_t Head       = 0;      // end of the committed messages
+  uint32_t Pending    = 0;      // end of the message being written
+  bool     Overflowed = false;
+  size_t   Length     = 0;      // bytes written for the message being written, including those that did not fit
+  uint32_t Dropped    = 0;      // messages that found no room
+  uint32_t Oversized  = 0;      // messages larger than the buffer
+  uint32_t Peak       = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::protocol
+
+#endif // PROTOCOL_TX_BUFFER_INCLUDED_HPP
@@ -0,0 +1,92 @@
+#ifndef RFID_POLL_POLICY_HPP_INCLUDED
+#define RFID_POLL_POLICY_HPP_INCLUDED
+
+#include <stdint.h>
+#include "Delta/StartStopTimer.hpp"
+
+namespace dps { namespace rfid {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Re-arm interval of the readers (REQA period, i.e. the worst case until a tag entering the field is detected), driven by presence.
+// While someone is there the receivers are re-armed every Active_ms for the lowest tag-to-event latency. Hold_ms after presence ended the
+// policy backs off to Idle_ms; a tag held to an idle reader (e.g. out of the PIR's view) is still found, with up to Idle_ms latency.
+// test/test_poll_policy replays recorded presence traces through Pir, this policy and the readers and checks poll rate and detection latency.
+class PollPolicy
+{
+  using TTimer = common::delta::StartStopTimer<>;
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    Active_ms = 10,
+    Idle_ms   = 200,
+    Hold_ms   = 5000,
+  };
+
+  void configure(uint32_t active_ms, uint32_t idle_ms, uint32_t hold_ms)
+  {
+    Active = active_ms;
+    Idle   = idle_ms;
+    Hold   = hold_ms;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // presence changed; returns true if the interval changed
+  bool presence(bool present)
+  {
+    if (present)
+    {
+      Release.stop();
+      return set(true);
+    }
+
+    Release.start(Hold);
+    return false;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // ends the hold; returns true if the interval changed
+  bool operator()()
+  {
+    if (Release())
+    {
+      Release.stop();
+      return set(false);
+    }
+    return false;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint32_t interval() const { return Present ? Active : Idle; }
+  bool     present() const  { return Present;                 }
+
+  // time until the hold ends, Deadline::Never if none is running
+  uint32_t due() const      { return Release.remaining();     }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  bool set(bool present)
+  {
+    bool changed = (present != Present);
+    Present      = present;
+    return changed;
+  }
+
+  uint32_t Active  = Active_ms;
+  uint32_t Idle    = Idle_ms;
+  uint32_t Hold    = Hold_ms;
+  bool     Present = false;
+  TTimer   Release;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rfid
+
+#endif // RFID_POLL_POLICY_HPP_INCLUDED
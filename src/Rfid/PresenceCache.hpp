@@ -0,0 +1,142 @@
+#ifndef RFID_PRESENCE_CACHE_HPP_INCLUDED
+#define RFID_PRESENCE_CACHE_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <MFRC522.h>
+#include "Delta/TimeDelta.hpp"
+#include "Delta/Deadline.hpp"
+
+namespace dps { namespace rfid {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Tags currently in the field, keyed by UID.
+// Every read refreshes its entry; a UID not in the cache is an arrival, any further read of it is a duplicate. An entry not refreshed
+// for the dedup window is a removal. Each tag thus yields exactly one arrival and one removal, however often it is read in between.
+// @tparam Capacity  max. number of tags tracked at once; if exceeded the least recently seen one is reported as removed
+template <size_t Capacity>
+class PresenceCache
+{
+  using TDelta = common::delta::TimeDelta<>;
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum
+  {
+    Window_ms = 300,   // default dedup window
+  };
+
+  struct Entry
+  {
+    MFRC522::Uid Uid;
+    uint64_t     Arrived_us;
+    uint64_t     Seen_us;     // last read
+    TDelta       Since;       // since the last read
+  };
+
+  PresenceCache(uint32_t window = Window_ms) : Window(window) {}
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // records a read; returns true for an arrival. onEvicted(Entry const&) is called if a tracked tag had to make room.
+  template <typename TEvicted>
+  bool seen(MFRC522::Uid const& uid, uint64_t now_us, TEvicted&& onEvicted)
+  {
+    if (Entry* entry = find(uid))
+    {
+      entry->Seen_us = now_us;
+      entry->Since.reset();
+      return false;
+    }
+
+    if (Size == Capacity)
+    {
+      size_t stalest = 0;
+      for (size_t i = 1; i < Size; ++i)
+      {
+        stalest = (Entries[i].Since.get() > Entries[stalest].Since.get()) ? i : stalest;
+      }
+      onEvicted(Entries[stalest]);
+      Entries[stalest] = Entries[--Size];
+    }
+
+    Entry& entry     = Entries[Size++];
+    entry.Uid        = uid;
+    entry.Arrived_us = now_us;
+    entry.Seen_us    = now_us;
+    entry.Since.reset();
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // calls onRemoved(Entry const&) for and drops every entry not seen within the window
+  template <typename TRemoved>
+  void expire(TRemoved&& onRemoved)
+  {
+    for (size_t i = 0; i < Size;)
+    {
+      if (Entries[i].Since.get() >= Window)
+      {
+        onRemoved(Entries[i]);
+        Entries[i] = Entries[--Size];
+      }
+      else
+      {
+        ++i;
+      }
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // time [ms] until the next entry expires
+  uint32_t due() const
+  {
+    common::delta::Deadline next(common::delta::Deadline::Never);
+    for (size_t i = 0; i < Size; ++i)
+    {
+      next.at(common::delta::Deadline::until(Entries[i].Since.get(), Window));
+    }
+    return next.remaining();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void     setWindow(uint32_t window) { Window = window;     }
+  uint32_t window() const             { return Window;       }
+  size_t   size() const               { return Size;         }
+  bool     contains(MFRC522::Uid const& uid) const { return indexOf(uid) < Size; }
+  bool     empty() const              { return !Size;        }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // Size if not cached
+  size_t indexOf(MFRC522::Uid const& uid) const
+  {
+    size_t i = 0;
+    while ((i < Size) && ((Entries[i].Uid.size != uid.size) || memcmp(Entries[i].Uid.uidByte, uid.uidByte, uid.size)))
+    {
+      ++i;
+    }
+    return i;
+  }
+
+  Entry* find(MFRC522::Uid const& uid)
+  {
+    size_t i = indexOf(uid);
+    return (i < Size) ? &Entries[i] : nullptr;
+  }
+
+  Entry    Entries[Capacity];
+  size_t   Size   = 0;
+  uint32_t Window;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rfid
+
+#endif // RFID_PRESENCE_CACHE_HPP_INCLUDED
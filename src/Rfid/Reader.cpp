@@ -1,5 +0,0 @@
-#include "Reader.hpp"
-
-using namespace dps::rfid;
-
-volatile bool Reader::TagDetected = false;
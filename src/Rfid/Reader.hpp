@@ -5,96 +5,625 @@
 #include <stdint.h>
 #include <SPI.h>
 #include <MFRC522.h>
+#include "Delta/PeriodicTimer.hpp"
+#include "Delta/TimeSource.hpp"
+#include "Statemachine/TimedStatemachine.hpp"
+#include "Rtos/Wakeup.hpp"
+#include "Rtos/SpscQueue.hpp"
+#include "Stats/Histogram.hpp"
+#include "Trace/Trace.hpp"
+#include "PresenceCache.hpp"
+#include "RegisterBatch.hpp"
+#include "TagMemory.hpp"
+
+// requested SPI clock of the reader's own register accesses, lowered at init until register read back is exact
+#ifndef DPS_RFID_SPI_CLOCK
+#define DPS_RFID_SPI_CLOCK 8000000
+#endif
 
 namespace dps { namespace rfid { 
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
 
+enum
+{
+  MaxTags = 8,      // per inventory and tracked at once per reader
+};
+
+enum class Presence : uint8_t
+{
+  Arrived,
+  Removed,
+};
+
+struct TagEvent
+{
+  Presence     Kind;
+  uint8_t      Source;     // reader index within the ReaderSet
+  MFRC522::Uid Uid;
+  uint64_t     Time_us;    // arrival: first read, removal: last read
+  uint64_t     Dwell_us;   // removal: first to last read
+  Payload      Memory;     // arrival: configured tag memory (see TagMemory)
+};
+
+// all tags found by one anticollision pass
+struct Inventory
+{
+  struct Tag
+  {
+    MFRC522::Uid Uid;
+    uint32_t     Select_us;   // anticollision, select and halt of this tag
+    Payload      Memory;      // read for tags not tracked yet only
+  };
 
+  Tag      Tags[MaxTags];
+  size_t   Count;
+  uint8_t  Source;        // reader index within the ReaderSet
+  uint64_t Time_us;       // start of the pass
+  uint32_t Duration_us;
+  bool     Complete;      // false: more than MaxTags tags or a selection failed, the field may hold more
+};
+
+// error classes of a reader, see Reader::faults()
+enum class Fault : uint8_t
+{
+  Version,    // watchdog: VersionReg no longer reads the version found at init
+  Config,     // watchdog: the chip lost its configuration (reset by a brown-out)
+  Init,       // no valid version after a (re)init
+  Select,     // a tag answered but its anticollision or select failed
+};
+
+enum
+{
+  NrFaults = 4,
+};
+
+inline char const* name(Fault fault)
+{
+  static char const* const Names[NrFaults] = { "version", "config", "init", "select" };
+  return Names[static_cast<size_t>(fault)];
+}
+
+// statistics of one reader, copied by its servicing task so other tasks never read the live counters (see ReaderSet::report())
+struct Report
+{
+  uint8_t     Source;          // reader index within the ReaderSet
+  bool        Available;
+  char const* State;
+  uint32_t    Reads;
+  uint32_t    Duplicates;
+  uint32_t    Tracked;
+  uint32_t    Rearm_ms;
+  uint32_t    SpiClock;
+  uint32_t    SpiTransactions;
+  uint32_t    SpiFrames;
+  uint32_t    SpiBytes;
+  uint32_t    Irqs;
+  uint32_t    Coalesced;
+  uint32_t    Dropped;
+  uint32_t    Latency50_us;
+  uint32_t    Latency99_us;
+  uint32_t    LatencyMax_us;
+  uint32_t    MemoryReads;
+  uint32_t    MemoryFailed;
+  uint32_t    Faults[NrFaults];
+  uint32_t    Reinits;
+  uint32_t    Backoff_ms;
+  uint32_t    Rounds;          // ReaderSet::Service
+  uint32_t    Last_us;
+  uint32_t    Max_us;
+  uint32_t    Wait_us;
+};
 
-#define SS_PIN         25           // Configurable, see typical pin layout above
-#define RST_PIN        26           // Configurable, see typical pin layout above
-#define IRQ_PIN        27           // Configurable, depends on hardware
 
 //==============================================================================================================================================================
+// One MFRC522 with tag detection, presence tracking and fault recovery.
+// New tags are found by REQA and the RX interrupt, which triggers an inventory of the whole field (see inventory()); all tags are halted after
+// being read, so they no longer answer REQA. While tags are tracked the inventory is repeated periodically to check their presence.
+// Reads are de-duplicated by a PresenceCache, so a tag yields one Arrived event when it enters the field and one Removed event (with its
+// dwell time) once it has not been seen for the dedup window.
+// The SPI bus is not set up here, several readers share it (see ReaderSet). The register accesses of the polling path (re-arm, IRQ acknowledge,
+// watchdog) are batched into one SPI transaction per service, the tag exchanges are left to the MFRC522 library.
+//
+// The reader is driven by a state machine:
+//  - Idle:    initialized, receiver not armed; arms it right away
+//  - Armed:   REQA receiver armed, waits for the RX interrupt, presence checks, re-arm and watchdog
+//  - Reading: inventory of the field
+//  - Error:   a fault was detected, waits for the backoff
+//  - Reinit:  hard reset through the RST pin and reconfiguration
+// The watchdog periodically reads back VersionReg and ComIEnReg; a chip that stopped answering or came back from a reset with its default
+// configuration (RF noise, brown-out), repeated select failures or a failed init lead to Error. The backoff doubles with every fault in a
+// row, up to Backoff_ms, and starts over after the first good watchdog check. All waits are timed states, nothing here blocks the caller.
+// @tparam SsPin   chip select
+// @tparam RstPin  reset (power down)
+// @tparam IrqPin  IRQ output, active low
+template <uint8_t SsPin, uint8_t RstPin, uint8_t IrqPin>
 class Reader
 {
+  enum
+  {
+    Rearm_ms          = 10,
+    Check_ms          = 100,     // presence check period while tags are tracked
+    Watchdog_ms       = 1000,
+    IrqDepth          = 8,       // IRQ time stamps queued between two services
+    PowerDown_ms      = 1,       // RST low
+    Startup_ms        = 50,      // RST high to oscillator ready (as PCD_Init)
+    MinBackoff_ms     = 100,
+    MaxBackoff_ms     = 30000,
+    MaxSelectFailures = 3,       // in a row
+    ComIEn            = 0xA0,    // IRQ active low, RX interrupt only
+  };
+
+  enum class States : uint8_t
+  {
+    Idle,
+    Armed,
+    Reading,
+    Error,
+    Reinit,
+  };
+
 //==============================================================================================================================================================
 public:
 //==============================================================================================================================================================
-  Reader() : Mfrc522(SS_PIN, RST_PIN)
+  Reader(rtos::Wakeup& wakeup) : Mfrc522(SsPin, RstPin), Registers(SsPin), Rearm(Rearm_ms), Check(Check_ms), Watchdog(Watchdog_ms), Waker(wakeup)
+  {
+    Mfrc522.PCD_Init(); // Init MFRC522 card, blocking once at startup
+
+    /* setup the IRQ pin; IRQs are ignored until the reader is armed (see Busy)*/
+    pinMode(IrqPin, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(IrqPin), readCard, this, FALLING);
+
+    Machine = setup() ? States::Idle : fault(Fault::Init);
+  }
+
+  Reader(Reader const&)            = delete;
+  Reader& operator=(Reader const&) = delete;
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // runs the state machine: takes an inventory on a detected tag and periodically while tags are tracked, re-arms, watches and recovers the chip.
+  // Calls onEvent(TagEvent const&) for every arrival and removal, onInventory(Inventory const&) for each inventory that found a new tag.
+  template <typename TEvent, typename TInventory>
+  void operator()(TEvent&& onEvent, TInventory&& onInventory)
   {
-    SPI.begin(14, 12, 13, SS_PIN);
-    Mfrc522.PCD_Init(); // Init MFRC522 card
+    auto removed = [&](typename TCache::Entry const& entry)
+    {
+      onEvent(TagEvent{Presence::Removed, 0, entry.Uid, entry.Seen_us, entry.Seen_us - entry.Arrived_us, Payload{}});
+    };
+
+    do {
+      auto state = Machine();
 
-    /* read and printout the MFRC522 version (valid values 0x91 & 0x92)*/
-    Mfrc522.PCD_ReadRegister(Mfrc522.VersionReg);
+      switch (state)
+      {
+      case States::Idle:
+        activateRec();
+        Rearm.reset();
+        Machine >>= States::Armed;
+        break;
 
-    /* setup the IRQ pin*/
-    pinMode(IRQ_PIN, INPUT_PULLUP);
+      case States::Armed:
+        armed();
+        break;
 
-    /*
-    * Allow the ... irq to be propagated to the IRQ pin
-    * For test purposes propagate the IdleIrq and loAlert
-    */
-    regVal = 0xA0; //rx irq
-    Mfrc522.PCD_WriteRegister(Mfrc522.ComIEnReg, regVal);
+      case States::Reading:
+        Machine >>= reading(onEvent, onInventory, removed);
+        break;
 
-    /*Activate the interrupt*/
-    attachInterrupt(digitalPinToInterrupt(IRQ_PIN), readCard, FALLING);
+      case States::Error:
+        if (Machine.stateEntry())
+        {
+          Busy    = true;
+          Backoff = (Failures < 16) ? (uint32_t(MinBackoff_ms) << Failures) : uint32_t(MaxBackoff_ms);
+          Backoff = (Backoff < uint32_t(MaxBackoff_ms)) ? Backoff : uint32_t(MaxBackoff_ms);
+          ++Failures;
+        }
+        if (Machine.hasExpired(Backoff))
+        {
+          Machine >>= States::Reinit;
+        }
+        break;
 
-    while (TagDetected) {}
-    TagDetected = false;
+      case States::Reinit:
+        if (Machine.stateEntry())
+        {
+          // hard power down, the rising edge resets the chip
+          ++Reinits;
+          Starting = false;
+          pinMode(RstPin, OUTPUT);
+          digitalWrite(RstPin, LOW);
+        }
+        else if (!Starting && Machine.hasExpired(PowerDown_ms))
+        {
+          Starting = true;
+          digitalWrite(RstPin, HIGH);
+          Machine.resetTimer();
+        }
+        else if (Starting && Machine.hasExpired(Startup_ms))
+        {
+          Machine >>= setup() ? States::Idle : fault(Fault::Init);
+        }
+        break;
+      }
+    } while (Machine.loop());
 
-    Serial.println(F("End setup"));
+    Present.expire(removed);
+
+    // the IRQ line is held low from the inventory's last exchange until the acknowledge in this flush, so no IRQ edge is missed
+    Busy = (Machine.currentState() != States::Armed);
+    Registers.flush();
   }
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-  MFRC522::Uid* operator()()
+  // one ISO 14443A inventory of the field: WUPA moves every tag (halted ones too) to READY, then the tag winning the bitwise anticollision
+  // is selected (cascade levels for 7/10 byte UIDs included), its memory is read if it is new (see TagMemory) and it is halted. Tags that lost fall back to IDLE and answer the following REQA,
+  // so this repeats until no tag answers. Every tag ends up halted, i.e. silent for the REQA of the receiver.
+  // The final IRQ acknowledge is only queued, it goes out with the next flush of the register batch.
+  // Returns false if a tag answered but could not be selected.
+  bool inventory(Inventory& result)
   {
-    MFRC522::Uid* uid = nullptr;
+    result.Count    = 0;
+    result.Source   = 0;
+    result.Time_us  = now();
+    result.Complete = true;
+
+    bool selected = true;
+    byte atqa[2];
+    byte size   = sizeof(atqa);
+    auto status = Mfrc522.PICC_WakeupA(atqa, &size);
 
-    if (TagDetected)
+    // an ATQA collision still means tags are there
+    while ((status == MFRC522::STATUS_OK) || (status == MFRC522::STATUS_COLLISION))
     {
-      Mfrc522.PICC_ReadCardSerial(); //read the tag data
-      clearInt();
+      if (result.Count == MaxTags)
+      {
+        result.Complete = false;
+        break;
+      }
+
+      uint64_t start = now();
+      if (!Mfrc522.PICC_ReadCardSerial())
+      {
+        result.Complete = false;
+        selected        = false;
+        break;
+      }
+      FirstRead_us = result.Count ? FirstRead_us : now();
+
+      auto& tag = result.Tags[result.Count++];
+      tag.Uid            = Mfrc522.uid;
+      tag.Memory.Size    = 0;
+      tag.Memory.Read_us = 0;
+      if (!Present.contains(tag.Uid))
+      {
+        Memory.read(Mfrc522, tag.Uid, tag.Memory);
+      }
       Mfrc522.PICC_HaltA();
+      Mfrc522.PCD_StopCrypto1();   // after a MIFARE Classic read the HLTA goes out encrypted, then crypto is off for the next tag
+      tag.Select_us = static_cast<uint32_t>(now() - start) - tag.Memory.Read_us;
+
+      size   = sizeof(atqa);
+      status = Mfrc522.PICC_RequestA(atqa, &size);
+    }
+    result.Duration_us = static_cast<uint32_t>(now() - result.Time_us);
 
-      CurrentUid = Mfrc522.uid;
-      uid = &CurrentUid;
+    // acknowledges the RX interrupts of this exchange (ignored by the ISR while Busy)
+    clearInt();
+    return selected;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // time [ms] until the reader needs service (re-arm, presence check, removal, watchdog, recovery step)
+  uint32_t due() const
+  {
+    common::delta::Deadline next(Present.empty() ? common::delta::Deadline::Never : Present.due());
 
-      TagDetected = false;
+    switch (Machine.currentState())
+    {
+    case States::Armed:
+      next.at(Rearm.remaining());
+      next.at(Watchdog.remaining());
+      if (!Present.empty())
+      {
+        next.at(Check.remaining());
+      }
+      break;
+
+    case States::Error:
+      next.at(Machine.remaining(Backoff));
+      break;
+
+    case States::Reinit:
+      next.at(Machine.remaining(Starting ? Startup_ms : PowerDown_ms));
+      break;
+
+    default:
+      next.at(0);
+      break;
     }
+    return next.remaining();
+  }
+
+  // false while the reader is in error or being reinitialized (e.g. no MFRC522 answered at init)
+  bool     available() const  { return (Machine.currentState() != States::Error) && (Machine.currentState() != States::Reinit); }
+  uint8_t  version() const    { return Version;        }
+
+  // register batch: validated SPI clock (MinClock_Hz if even that failed), bus usage
+  auto const& registers() const { return Registers;    }
+
+  // inventories triggered by the RX interrupt / those of them that found no new tag
+  uint32_t reads() const      { return Reads;          }
+  uint32_t duplicates() const { return Duplicates;     }
+  size_t   tracked() const    { return Present.size(); }
 
+  // IRQs taken / answered by the inventory of an earlier one / lost because the stamp queue was full
+  uint32_t irqs() const       { return IrqCount;          }
+  uint32_t coalesced() const  { return Coalesced;         }
+  uint32_t dropped() const    { return Irqs.overflows();  }
 
-    activateRec();
-    return uid;
+  // IRQ to first UID read [us]
+  stats::Histogram const& latency() const { return Latency; }
+
+  // REQA re-arm interval [ms], see PollPolicy
+  void     setRearm(uint32_t rearm_ms) { Rearm.setCycleTime(rearm_ms); }
+  uint32_t rearm() const      { return Rearm.getCycleTime(); }
+
+  // tag memory reads, configured from the servicing task
+  auto&       memory()        { return Memory; }
+  auto const& memory() const  { return Memory; }
+
+  // recovery: faults per class, reinits done, current backoff [ms]
+  uint32_t faults(Fault fault) const { return Faults[static_cast<size_t>(fault)]; }
+  uint32_t reinits() const    { return Reinits;        }
+  uint32_t backoff() const    { return Backoff;        }
+
+  char const* state() const
+  {
+    static char const* const Names[] = { "idle", "armed", "reading", "error", "reinit" };
+    return Names[static_cast<size_t>(Machine.currentState())];
   }
-  
+
+  // copies the statistics, call from the servicing task
+  void report(Report& report) const
+  {
+    report.Available       = available();
+    report.State           = state();
+    report.Reads           = Reads;
+    report.Duplicates      = Duplicates;
+    report.Tracked         = static_cast<uint32_t>(tracked());
+    report.Rearm_ms        = rearm();
+    report.SpiClock        = Registers.clock();
+    report.SpiTransactions = Registers.transactions();
+    report.SpiFrames       = Registers.frames();
+    report.SpiBytes        = Registers.bytes();
+    report.Irqs            = IrqCount;
+    report.Coalesced       = Coalesced;
+    report.Dropped         = dropped();
+    report.Latency50_us    = Latency.percentile(500);
+    report.Latency99_us    = Latency.percentile(990);
+    report.LatencyMax_us   = Latency.max();
+    report.MemoryReads     = Memory.reads();
+    report.MemoryFailed    = Memory.failed();
+    for (size_t f = 0; f < NrFaults; ++f)
+    {
+      report.Faults[f] = Faults[f];
+    }
+    report.Reinits    = Reinits;
+    report.Backoff_ms = Backoff;
+  }
+
+  // counters and latency statistics, call from the servicing task
+  void resetStats()
+  {
+    Reads      = 0;
+    Duplicates = 0;
+    IrqCount   = 0;
+    Coalesced  = 0;
+    Reinits    = 0;
+    Memory.resetStats();
+    for (auto& count : Faults)
+    {
+      count = 0;
+    }
+    Latency.requestReset();
+  }
+
 //==============================================================================================================================================================
 private:
 //==============================================================================================================================================================
-  static volatile bool TagDetected;
-  
-  uint8_t regVal = 0x7F;
+  using TCache = PresenceCache<MaxTags>;
+
+  rtos::SpscQueue<uint64_t, IrqDepth> Irqs;          // ISR -> task: IRQ time stamps
+  volatile bool                       Busy = true;   // not armed or own exchange in progress, its RX IRQs are no detections
+
+  uint8_t Version = 0x00;
   MFRC522 Mfrc522;
-  MFRC522::Uid CurrentUid = {};
+  RegisterBatch<> Registers;
+
+  common::TimedStatemachine<States> Machine;
+  common::delta::PeriodicTimer<>    Rearm;
+  common::delta::PeriodicTimer<>    Check;
+  common::delta::PeriodicTimer<>    Watchdog;
+  TCache                            Present;
+  Inventory                         Last         = {};
+  bool                              Detected     = false;   // Reading was entered by an IRQ
+  uint64_t                          Irq_us       = 0;       // its time stamp
+  uint32_t                          Reads        = 0;
+  uint32_t                          Duplicates   = 0;
+  uint32_t                          IrqCount     = 0;
+  uint32_t                          Coalesced    = 0;
+  uint64_t                          FirstRead_us = 0;       // of the last inventory
+  stats::Histogram                  Latency;
+  TagMemory<>                       Memory;
 
+  uint32_t                          Faults[NrFaults] = {};
+  uint32_t                          Failures       = 0;     // faults without a good watchdog check in between
+  uint32_t                          SelectFailures = 0;     // failed inventories in a row
+  uint32_t                          Backoff        = 0;
+  uint32_t                          Reinits        = 0;
+  bool                              Starting       = false; // Reinit: RST released, waiting for the oscillator
+  rtos::Wakeup&                     Waker;
 
+  static uint64_t IRAM_ATTR now()
+  {
+    return common::delta::MonotonicSource<1>::micros64();
+  }
+
+  States fault(Fault fault)
+  {
+    ++Faults[static_cast<size_t>(fault)];
+    return States::Error;
+  }
+
+  // Armed: looks for work, in order of urgency
+  void armed()
+  {
+    // all IRQs since the last service are answered by one inventory
+    Detected = Irqs.pop(Irq_us);
+    if (Detected)
+    {
+      uint64_t later;
+      ++IrqCount;
+      while (Irqs.pop(later))
+      {
+        ++IrqCount;
+        ++Coalesced;
+      }
+    }
+
+    if (Present.empty())
+    {
+      Check.reset();
+    }
+
+    if (Detected || (!Present.empty() && Check()))
+    {
+      Machine >>= States::Reading;
+    }
+    else if (Watchdog())
+    {
+      uint8_t version = 0x00;
+      uint8_t comIEn  = 0x00;
+      Registers.read(Mfrc522.VersionReg, &version);
+      Registers.read(Mfrc522.ComIEnReg,  &comIEn);
+      Registers.flush();
+
+      if (version != Version)
+      {
+        Machine >>= fault(Fault::Version);
+      }
+      else if (comIEn != ComIEn)
+      {
+        Machine >>= fault(Fault::Config);
+      }
+      else
+      {
+        Failures = 0;
+      }
+    }
+    else if (Rearm())
+    {
+      activateRec();
+    }
+  }
+
+  // Reading: one inventory and its events; returns the next state
+  template <typename TEvent, typename TInventory, typename TRemoved>
+  States reading(TEvent& onEvent, TInventory& onInventory, TRemoved& removed)
+  {
+    Busy = true;
+    bool selected = inventory(Last);
+    if (Detected && Last.Count)
+    {
+      Latency.record(static_cast<uint32_t>(FirstRead_us - Irq_us));
+    }
+
+    size_t arrivals = 0;
+    for (size_t i = 0; i < Last.Count; ++i)
+    {
+      auto const& tag = Last.Tags[i];
+      if (Present.seen(tag.Uid, Last.Time_us, removed))
+      {
+        onEvent(TagEvent{Presence::Arrived, 0, tag.Uid, Last.Time_us, 0, tag.Memory});
+        ++arrivals;
+      }
+    }
+
+    if (Detected)
+    {
+      ++Reads;
+      Duplicates += !arrivals;
+    }
+    if (arrivals)
+    {
+      onInventory(static_cast<Inventory const&>(Last));
+    }
+
+    // a tag leaving mid-exchange fails a select now and then, only a run of them points to the reader
+    if (selected)
+    {
+      SelectFailures = 0;
+      return States::Idle;
+    }
+    fault(Fault::Select);
+    return (++SelectFailures < MaxSelectFailures) ? States::Idle : States::Error;
+  }
+
+  // chip found and configured as PCD_Init does (without its blocking reset); false if no valid version is read
+  bool setup()
+  {
+    /* valid versions are 0x91 & 0x92 (0x88 for clones), nothing answers with 0x00 or 0xFF*/
+    Registers.read(Mfrc522.VersionReg, &Version);
+    Registers.flush();
+    if ((Version == 0x00) || (Version == 0xFF))
+    {
+      return false;
+    }
+    Registers.setClock(DPS_RFID_SPI_CLOCK);
+
+    Registers.write(Mfrc522.TxModeReg,     0x00);
+    Registers.write(Mfrc522.RxModeReg,     0x00);
+    Registers.write(Mfrc522.ModWidthReg,   0x26);
+    Registers.write(Mfrc522.TModeReg,      0x80);   // timer auto start, 25 ms timeout
+    Registers.write(Mfrc522.TPrescalerReg, 0xA9);
+    Registers.write(Mfrc522.TReloadRegH,   0x03);
+    Registers.write(Mfrc522.TReloadRegL,   0xE8);
+    Registers.write(Mfrc522.TxASKReg,      0x40);   // 100 % ASK
+    Registers.write(Mfrc522.ModeReg,       0x3D);   // CRC preset 0x6363
+    Registers.write(Mfrc522.TxControlReg,  0x83);   // antenna on
+    Registers.write(Mfrc522.ComIEnReg,     ComIEn);
+    clearInt();
+    Registers.flush();
+
+    SelectFailures = 0;
+    Watchdog.reset();
+    return true;
+  }
+
+  // queued, see RegisterBatch
   void activateRec()
   {
-    Mfrc522.PCD_WriteRegister(Mfrc522.FIFODataReg,   Mfrc522.PICC_CMD_REQA);
-    Mfrc522.PCD_WriteRegister(Mfrc522.CommandReg,    Mfrc522.PCD_Transceive);
-    Mfrc522.PCD_WriteRegister(Mfrc522.BitFramingReg, 0x87);
+    Registers.write(Mfrc522.FIFODataReg,   Mfrc522.PICC_CMD_REQA);
+    Registers.write(Mfrc522.CommandReg,    Mfrc522.PCD_Transceive);
+    Registers.write(Mfrc522.BitFramingReg, 0x87);
   }
 
   void clearInt()
   {
-    Mfrc522.PCD_WriteRegister(Mfrc522.ComIrqReg, 0x7F);    
+    Registers.write(Mfrc522.ComIrqReg, 0x7F);
   }
 
-  static void readCard()
+  static void IRAM_ATTR readCard(void* arg)
   {
-    TagDetected = true;
+    auto& reader = *static_cast<Reader*>(arg);
+
+    if (reader.Busy)
+    {
+      return;
+    }
+
+    trace::Trace::instant(trace::Id::RfidIrq, IrqPin);
+    reader.Irqs.push(now());
+    reader.Waker.notifyFromIsr();
   }
 };
 
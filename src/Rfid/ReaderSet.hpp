@@ -0,0 +1,186 @@
+#ifndef RFID_READER_SET_HPP_INCLUDED
+#define RFID_READER_SET_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <tuple>
+#include <utility>
+#include <SPI.h>
+#include "Delta/Deadline.hpp"
+#include "Delta/TimeSource.hpp"
+#include "Rtos/Wakeup.hpp"
+#include "Reader.hpp"
+
+namespace dps { namespace rfid {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// SPI bus shared by the readers, started before any of them is initialized
+template <uint8_t SckPin, uint8_t MisoPin, uint8_t MosiPin>
+struct SpiBus
+{
+  SpiBus()
+  {
+    SPI.begin(SckPin, MisoPin, MosiPin);
+  }
+};
+
+
+//==============================================================================================================================================================
+// Readers on one SPI bus, serviced by a single task.
+// Each reader only touches the bus while it is serviced, so there is exactly one transaction sequence on the bus at a time. The service
+// order rotates every round, so a reader with a long inventory delays each of the others only every N-th round instead of always the same one.
+// Events and inventories are tagged with the reader index (position in TReaders).
+// @tparam TBus      SpiBus, set up first
+// @tparam TReaders  Reader<..> instances, each with its own chip select and IRQ pin
+template <typename TBus, typename... TReaders>
+class ReaderSet : TBus
+{
+  using TTuple = std::tuple<TReaders...>;
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : size_t
+  {
+    Count = sizeof...(TReaders),
+  };
+
+  static_assert(Count > 0, "no reader");
+
+  // per reader service statistics
+  struct Service
+  {
+    uint32_t Rounds;      // times serviced
+    uint32_t Last_us;     // duration of the last service
+    uint32_t Max_us;      // longest service
+    uint32_t Wait_us;     // longest wait from the start of a round until the reader was serviced
+  };
+
+  // every reader is constructed in place from the wakeup
+  ReaderSet(rtos::Wakeup& wakeup) : Readers((static_cast<void>(sizeof(TReaders)), wakeup)...) {}
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // one round: services every reader once, starting one further than last time; see Reader::operator() for the callbacks
+  template <typename TEvent, typename TInventory>
+  void operator()(TEvent&& onEvent, TInventory&& onInventory)
+  {
+    if (ResetRequested)
+    {
+      ResetRequested = false;
+      for (auto& stats : Stats)
+      {
+        stats = {};
+      }
+      std::apply([](auto&... reader) { (reader.resetStats(), ...); }, Readers);
+    }
+
+    uint32_t rearm = RequestedRearm;
+    if (rearm != Rearm)
+    {
+      Rearm = rearm;
+      std::apply([&](auto&... reader) { (reader.setRearm(rearm), ...); }, Readers);
+    }
+
+    uint64_t round = now();
+    for (size_t k = 0; k < Count; ++k)
+    {
+      size_t   index = (Next + k) % Count;
+      uint64_t start = now();
+
+      visit(index, [&](auto& reader)
+      {
+        reader([&](TagEvent event)         { event.Source = static_cast<uint8_t>(index); onEvent(event); },
+               [&](Inventory const& batch) { Batch = batch; Batch.Source = static_cast<uint8_t>(index); onInventory(Batch); });
+      });
+
+      uint64_t end   = now();
+      auto&    stats = Stats[index];
+      ++stats.Rounds;
+      stats.Last_us = static_cast<uint32_t>(end - start);
+      stats.Max_us  = (stats.Last_us > stats.Max_us) ? stats.Last_us : stats.Max_us;
+      stats.Wait_us = ((start - round) > stats.Wait_us) ? static_cast<uint32_t>(start - round) : stats.Wait_us;
+    }
+    Next = (Next + 1) % Count;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // time [ms] until any reader needs service
+  uint32_t due() const
+  {
+    common::delta::Deadline next;
+    std::apply([&](auto const&... reader) { (next.at(reader.due()), ...); }, Readers);
+    return next.remaining();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // calls f(reader) for the reader with the given index
+  template <typename TFunc>
+  void visit(size_t index, TFunc&& f)
+  {
+    visit(index, f, std::index_sequence_for<TReaders...>());
+  }
+
+  template <typename TFunc>
+  void visit(size_t index, TFunc&& f) const
+  {
+    visit(index, f, std::index_sequence_for<TReaders...>());
+  }
+
+  Service const& service(size_t index) const { return Stats[index]; }
+
+  // statistics of one reader and its service, call from the servicing task
+  void report(size_t index, Report& report) const
+  {
+    visit(index, [&](auto const& reader) { reader.report(report); });
+
+    auto const& stats = Stats[index];
+    report.Source  = static_cast<uint8_t>(index);
+    report.Rounds  = stats.Rounds;
+    report.Last_us = stats.Last_us;
+    report.Max_us  = stats.Max_us;
+    report.Wait_us = stats.Wait_us;
+  }
+
+  // clears the service and reader statistics with the next round (i.e. in the servicing task)
+  void requestReset() { ResetRequested = true; }
+
+  // re-arm interval [ms] of all readers, applied with the next round (see PollPolicy)
+  void setRearm(uint32_t rearm_ms) { RequestedRearm = rearm_ms; }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  template <typename TFunc, size_t... Is>
+  void visit(size_t index, TFunc& f, std::index_sequence<Is...>)
+  {
+    ((index == Is ? f(std::get<Is>(Readers)) : void()), ...);
+  }
+
+  template <typename TFunc, size_t... Is>
+  void visit(size_t index, TFunc& f, std::index_sequence<Is...>) const
+  {
+    ((index == Is ? f(std::get<Is>(Readers)) : void()), ...);
+  }
+
+  static uint64_t now()
+  {
+    return common::delta::MonotonicSource<1>::micros64();
+  }
+
+  TTuple            Readers;
+  size_t            Next           = 0;
+  Service           Stats[Count]   = {};
+  Inventory         Batch;                  // inventory handed out, tagged with the reader
+  volatile bool     ResetRequested = false;
+  volatile uint32_t RequestedRearm = 0;     // 0: reader default
+  uint32_t          Rearm          = 0;     // applied
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rfid
+
+#endif // RFID_READER_SET_HPP_INCLUDED
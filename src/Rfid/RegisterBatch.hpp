@@ -0,0 +1,192 @@
+#ifndef RFID_REGISTER_BATCH_HPP_INCLUDED
+#define RFID_REGISTER_BATCH_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <SPI.h>
+#include <MFRC522.h>
+
+namespace dps { namespace rfid {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Queued MFRC522 register access, executed in one SPI transaction per flush() instead of one per register.
+// Within the transaction the chip select frames are packed as far as the MFRC522 SPI protocol allows:
+//  - consecutive reads share one frame (address bytes are pipelined, each data byte is returned with the next address)
+//  - consecutive writes to the same register (e.g. the FIFO) share one frame, other writes need a frame each
+// Every frame is sent with a single transferBytes() burst.
+// @tparam Capacity  queued accesses; write()/read() flush automatically when full
+template <size_t Capacity = 16>
+class RegisterBatch
+{
+  struct Access
+  {
+    uint8_t  Address;   // SPI address byte: register << 1, bit 7 = read
+    uint8_t  Value;
+    uint8_t* Result;    // reads
+  };
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum : uint32_t
+  {
+    MinClock_Hz = 1000000,
+    MaxClock_Hz = 10000000,   // MFRC522 SPI limit
+  };
+
+  RegisterBatch(uint8_t ssPin, uint32_t clock = 4000000) : Ss(ssPin), Clock(clock) {}
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // reg as defined by MFRC522::PCD_Register (already shifted)
+  void write(MFRC522::PCD_Register reg, uint8_t value)
+  {
+    queue({ static_cast<uint8_t>(reg & 0x7E), value, nullptr });
+  }
+
+  // *result is valid after the next flush()
+  void read(MFRC522::PCD_Register reg, uint8_t* result)
+  {
+    queue({ static_cast<uint8_t>(0x80 | (reg & 0x7E)), 0, result });
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void flush()
+  {
+    if (!Fill)
+    {
+      return;
+    }
+
+    SPI.beginTransaction(SPISettings(Clock, MSBFIRST, SPI_MODE0));
+    for (size_t i = 0; i < Fill;)
+    {
+      size_t  n = 0;
+      uint8_t tx[Capacity + 1];
+      uint8_t rx[Capacity + 1];
+
+      if (isRead(Queue[i]))
+      {
+        size_t first = i;
+        while ((i < Fill) && isRead(Queue[i]))
+        {
+          tx[n++] = Queue[i++].Address;
+        }
+        tx[n++] = 0x00;   // clocks out the last data byte
+
+        frame(tx, rx, n);
+        for (size_t k = first; k < i; ++k)
+        {
+          *Queue[k].Result = rx[k - first + 1];
+        }
+      }
+      else
+      {
+        uint8_t address = Queue[i].Address;
+        tx[n++] = address;
+        while ((i < Fill) && (Queue[i].Address == address))
+        {
+          tx[n++] = Queue[i++].Value;
+        }
+        frame(tx, rx, n);
+      }
+    }
+    SPI.endTransaction();
+
+    ++Transactions;
+    Fill = 0;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // selects the fastest clock up to 'clock' at which a register write/read back is exact, halving from the requested one down to
+  // MinClock_Hz; returns the clock in effect, 0 if not even MinClock_Hz works (chip absent or wiring broken, MinClock_Hz is kept)
+  uint32_t setClock(uint32_t clock)
+  {
+    clock = (clock > MaxClock_Hz) ? MaxClock_Hz : clock;
+
+    // the register is restored afterwards, so it is read at the safe clock
+    uint8_t saved;
+    Clock = MinClock_Hz;
+    read(MFRC522::TReloadRegL, &saved);
+    flush();
+
+    uint32_t valid = 0;
+    for (; !valid && (clock >= MinClock_Hz); clock /= 2)
+    {
+      Clock = clock;
+      valid = probe() ? clock : 0;
+    }
+
+    Clock = valid ? valid : MinClock_Hz;
+    write(MFRC522::TReloadRegL, saved);
+    flush();
+    return valid;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint32_t clock() const        { return Clock;        }
+
+  // bus usage since start: SPI transactions, chip select frames, bytes clocked
+  uint32_t transactions() const { return Transactions; }
+  uint32_t frames() const       { return Frames;       }
+  uint32_t bytes() const        { return Bytes;        }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static bool isRead(Access const& access) { return access.Address & 0x80; }
+
+  void queue(Access const& access)
+  {
+    if (Fill == Capacity)
+    {
+      flush();
+    }
+    Queue[Fill++] = access;
+  }
+
+  void frame(uint8_t const* tx, uint8_t* rx, size_t n)
+  {
+    digitalWrite(Ss, LOW);
+    SPI.transferBytes(tx, rx, n);
+    digitalWrite(Ss, HIGH);
+
+    ++Frames;
+    Bytes += n;
+  }
+
+  // two complementary patterns through a R/W register (timer reload, restored by the caller)
+  bool probe()
+  {
+    static uint8_t const Patterns[] = { 0x5A, 0xA5 };
+
+    for (uint8_t pattern : Patterns)
+    {
+      uint8_t value = ~pattern;
+      write(MFRC522::TReloadRegL, pattern);
+      read(MFRC522::TReloadRegL, &value);
+      flush();
+      if (value != pattern)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint8_t  Ss;
+  uint32_t Clock;
+  Access   Queue[Capacity];
+  size_t   Fill         = 0;
+  uint32_t Transactions = 0;
+  uint32_t Frames       = 0;
+  uint32_t Bytes        = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rfid
+
+#endif // RFID_REGISTER_BATCH_HPP_INCLUDED
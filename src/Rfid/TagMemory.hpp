@@ -0,0 +1,245 @@
+#ifndef RFID_TAG_MEMORY_HPP_INCLUDED
+#define RFID_TAG_MEMORY_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <MFRC522.h>
+#include "Delta/TimeSource.hpp"
+
+namespace dps { namespace rfid {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+enum
+{
+  MaxPayload = 60,  // 15 pages: one FAST_READ answer plus its CRC fits the 64 byte FIFO
+  MaxKeys    = 4,
+};
+
+// memory read from a tag after its selection (e.g. a signed credential)
+struct Payload
+{
+  uint8_t  Size;                // 0: nothing read
+  uint8_t  Data[MaxPayload];
+  uint32_t Read_us;             // read incl. authentication and retries
+};
+
+// what to read, set by the host
+struct MemoryConfig
+{
+  uint8_t             FirstPage;      // NTAG21x/Ultralight: Pages pages from FirstPage by one FAST_READ
+  uint8_t             Pages;          // 0: off
+  uint8_t             Sector;         // MIFARE Classic: the 3 data blocks of this sector (< 32), NoSector: off
+  uint8_t             NrKeys;
+  MFRC522::MIFARE_Key Keys[MaxKeys];  // key A candidates
+
+  enum : uint8_t
+  {
+    MaxPages  = MaxPayload / 4,
+    NoSector  = 0xFF,
+    MaxSector = 31,                   // sectors of 4 blocks
+  };
+};
+
+
+//==============================================================================================================================================================
+// Reads the configured memory of a selected tag with as few exchanges as possible:
+//  - NTAG21x/Ultralight (EV1): the whole page range with one FAST_READ instead of a READ per 4 pages
+//  - MIFARE Classic: the data blocks of one sector after authenticating with key A. The key that worked is cached per UID and tried first
+//    the next time; a wrong key costs a timeout and a reselection, so with the cache a known tag needs a single authentication.
+// A tag that NAKs or fails an authentication falls back to IDLE; it is selected again, so the caller can halt it as usual.
+template <size_t CacheSize = 16>
+class TagMemory
+{
+  struct Cached
+  {
+    uint8_t Size;
+    uint8_t Uid[sizeof(MFRC522::Uid::uidByte)];
+    uint8_t Key;
+  };
+
+  enum : uint8_t
+  {
+    FastRead = 0x3A,
+    Block    = 16,
+  };
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  // drops the key cache, the key indices change
+  void configure(MemoryConfig const& config)
+  {
+    Config = config;
+    Config.NrKeys = std::min<uint8_t>(Config.NrKeys, MaxKeys);
+    Size = 0;
+    Next = 0;
+  }
+
+  MemoryConfig const& config() const { return Config; }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // reads into payload (Size 0 if nothing is configured for the tag type or the read failed); the tag is left selected
+  // returns false if the tag could not be selected again after a failure (it left the field)
+  bool read(MFRC522& pcd, MFRC522::Uid const& uid, Payload& payload)
+  {
+    payload.Size    = 0;
+    payload.Read_us = 0;
+
+    auto type = MFRC522::PICC_GetType(uid.sak);
+    bool pages  = Config.Pages && (type == MFRC522::PICC_TYPE_MIFARE_UL);
+    bool sector = (Config.Sector <= MemoryConfig::MaxSector) && Config.NrKeys
+               && ((type == MFRC522::PICC_TYPE_MIFARE_MINI) || (type == MFRC522::PICC_TYPE_MIFARE_1K) || (type == MFRC522::PICC_TYPE_MIFARE_4K));
+    if (!pages && !sector)
+    {
+      return true;
+    }
+
+    uint64_t start = now();
+    bool     present = pages ? fastRead(pcd, uid, payload) : sectorRead(pcd, uid, payload);
+    payload.Read_us = static_cast<uint32_t>(now() - start);
+
+    ++Reads;
+    Failed += !payload.Size;
+    return present;
+  }
+
+  // tags read / of them without payload
+  uint32_t reads() const  { return Reads;  }
+  uint32_t failed() const { return Failed; }
+
+  void resetStats()
+  {
+    Reads  = 0;
+    Failed = 0;
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  static uint64_t now()
+  {
+    return common::delta::MonotonicSource<1>::micros64();
+  }
+
+  // FAST_READ start end, answered by all pages and a CRC_A
+  bool fastRead(MFRC522& pcd, MFRC522::Uid const& uid, Payload& payload)
+  {
+    size_t last = Config.FirstPage + Config.Pages - 1;
+    byte   command[5] = { FastRead, Config.FirstPage, static_cast<byte>(last) };
+    if (pcd.PCD_CalculateCRC(command, 3, &command[3]) != MFRC522::STATUS_OK)
+    {
+      return true;
+    }
+
+    byte buffer[MaxPayload + 2];
+    byte size   = sizeof(buffer);
+    auto status = pcd.PCD_TransceiveData(command, sizeof(command), buffer, &size, nullptr, 0, true);
+
+    size_t length = 4 * Config.Pages;
+    if ((status != MFRC522::STATUS_OK) || (size < length))
+    {
+      return reselect(pcd, uid);   // NAK (range beyond the tag's memory, FAST_READ unsupported) or lost
+    }
+    memcpy(payload.Data, buffer, length);
+    payload.Size = static_cast<uint8_t>(length);
+    return true;
+  }
+
+  // authenticates the sector trailer with the cached key first, then reads the data blocks
+  bool sectorRead(MFRC522& pcd, MFRC522::Uid const& uid, Payload& payload)
+  {
+    MFRC522::Uid selected = uid;
+    byte         trailer  = 4 * Config.Sector + 3;
+    uint8_t      first    = cached(uid);
+
+    for (uint8_t n = 0; n < Config.NrKeys; ++n)
+    {
+      uint8_t key = (first + n) % Config.NrKeys;
+      if (n && !reselect(pcd, uid))
+      {
+        return false;
+      }
+      if (pcd.PCD_Authenticate(MFRC522::PICC_CMD_MF_AUTH_KEY_A, trailer, &Config.Keys[key], &selected) != MFRC522::STATUS_OK)
+      {
+        continue;
+      }
+      remember(uid, key);
+
+      byte buffer[Block + 2];
+      for (byte block = trailer - 3; block < trailer; ++block)
+      {
+        byte size = sizeof(buffer);
+        if (pcd.MIFARE_Read(block, buffer, &size) != MFRC522::STATUS_OK)
+        {
+          payload.Size = 0;
+          pcd.PCD_StopCrypto1();
+          return reselect(pcd, uid);
+        }
+        memcpy(payload.Data + payload.Size, buffer, Block);
+        payload.Size += Block;
+      }
+      return true;   // crypto stays on for the HLTA, see Reader::inventory()
+    }
+    return reselect(pcd, uid);
+  }
+
+  // wakes the IDLE tags (REQA) and selects this one by its full UID, the others return to IDLE
+  static bool reselect(MFRC522& pcd, MFRC522::Uid const& uid)
+  {
+    MFRC522::Uid selected = uid;
+    byte atqa[2];
+    byte size = sizeof(atqa);
+
+    pcd.PCD_StopCrypto1();
+    auto status = pcd.PICC_RequestA(atqa, &size);
+    return ((status == MFRC522::STATUS_OK) || (status == MFRC522::STATUS_COLLISION))
+        && (pcd.PICC_Select(&selected, 8 * selected.size) == MFRC522::STATUS_OK);
+  }
+
+  uint8_t cached(MFRC522::Uid const& uid) const
+  {
+    for (size_t i = 0; i < Size; ++i)
+    {
+      if ((Cache[i].Size == uid.size) && !memcmp(Cache[i].Uid, uid.uidByte, uid.size))
+      {
+        return Cache[i].Key;
+      }
+    }
+    return 0;
+  }
+
+  // replaces the oldest entry when full
+  void remember(MFRC522::Uid const& uid, uint8_t key)
+  {
+    for (size_t i = 0; i < Size; ++i)
+    {
+      if ((Cache[i].Size == uid.size) && !memcmp(Cache[i].Uid, uid.uidByte, uid.size))
+      {
+        Cache[i].Key = key;
+        return;
+      }
+    }
+
+    Cached& entry = (Size < CacheSize) ? Cache[Size++] : Cache[Next++ % CacheSize];
+    entry.Size = uid.size;
+    entry.Key  = key;
+    memcpy(entry.Uid, uid.uidByte, uid.size);
+  }
+
+  MemoryConfig Config = { 0, 0, MemoryConfig::NoSector, 0, {} };
+  Cached       Cache[CacheSize];
+  size_t       Size   = 0;
+  size_t       Next   = 0;
+  uint32_t     Reads  = 0;
+  uint32_t     Failed = 0;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rfid
+
+#endif // RFID_TAG_MEMORY_HPP_INCLUDED
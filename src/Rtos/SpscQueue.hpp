@@ -0,0 +1,96 @@
+#ifndef RTOS_SPSC_QUEUE_INCLUDED_HPP
+#define RTOS_SPSC_QUEUE_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace dps { namespace rtos {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Bounded lock-free single-producer/single-consumer ring buffer.
+// Exactly one task (or ISR) may push and exactly one task may pop; neither side ever blocks or allocates.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+  static_assert((Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0), "capacity must be a power of two");
+
+  enum : uint32_t
+  {
+    Mask      = Capacity - 1,
+    CacheLine = 64,
+  };
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  // producer side: returns false (and counts the overflow) if the queue is full
+  bool push(T const& item)
+  {
+    auto head = Head.load(std::memory_order_relaxed);
+    if (head - Tail.load(std::memory_order_acquire) >= Capacity)
+    {
+      Overflows.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    Items[head & Mask] = item;
+    Head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // consumer side: returns false if the queue is empty
+  bool pop(T& item)
+  {
+    auto tail = Tail.load(std::memory_order_relaxed);
+    if (Head.load(std::memory_order_acquire) == tail)
+    {
+      return false;
+    }
+
+    item = Items[tail & Mask];
+    Tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // number of queued items (a snapshot, exact only on the consumer side)
+  size_t size() const
+  {
+    return Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire);
+  }
+
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  static constexpr size_t capacity()
+  {
+    return Capacity;
+  }
+
+  // number of items rejected because the queue was full
+  uint32_t overflows() const
+  {
+    return Overflows.load(std::memory_order_relaxed);
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  alignas(CacheLine) std::atomic<uint32_t> Head{0};      // written by the producer only
+  alignas(CacheLine) std::atomic<uint32_t> Tail{0};      // written by the consumer only
+  std::atomic<uint32_t>                    Overflows{0};
+  T                                        Items[Capacity];
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rtos
+
+#endif // RTOS_SPSC_QUEUE_INCLUDED_HPP
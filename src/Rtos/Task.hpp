@@ -0,0 +1,58 @@
+#ifndef RTOS_TASK_INCLUDED_HPP
+#define RTOS_TASK_INCLUDED_HPP
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+namespace dps { namespace rtos {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Endless worker task pinned to a core (FreeRTOS on target, std::thread on host builds).
+class Task
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum
+  {
+    StackSize = 4096,
+    Priority  = 1,
+  };
+
+  using TEntry = void (*)(void*);
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // starts entry(arg) on the given core; entry must never return
+  bool start(char const* name, int core, TEntry entry, void* arg, uint32_t stackSize = StackSize, uint32_t priority = Priority)
+  {
+#ifdef ESP_PLATFORM
+    return xTaskCreatePinnedToCore(entry, name, stackSize, arg, priority, &Handle, core) == pdPASS;
+#else
+    (void)name; (void)core; (void)stackSize; (void)priority;
+    std::thread(entry, arg).detach();
+    return true;
+#endif
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+#ifdef ESP_PLATFORM
+  TaskHandle_t Handle = nullptr;
+#endif
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rtos
+
+#endif // RTOS_TASK_INCLUDED_HPP
@@ -0,0 +1,122 @@
+#ifndef RTOS_WAKEUP_INCLUDED_HPP
+#define RTOS_WAKEUP_INCLUDED_HPP
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_attr.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+#endif
+
+namespace dps { namespace rtos {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Lets a task sleep until a deadline or until an external event (ISR, other task) wakes it up.
+// Notifications are latched: an event that arrives while the task is still busy makes the next wait() return immediately.
+class Wakeup
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  // binds the wakeup to the calling task
+  Wakeup()
+  {
+    attach();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // (re)binds the wakeup to the calling task; worker tasks call this first thing in their body
+  void attach()
+  {
+#ifdef ESP_PLATFORM
+    Task = xTaskGetCurrentTaskHandle();
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // wakes the task from task context
+  void notify()
+  {
+#ifdef ESP_PLATFORM
+    if (Task)
+    {
+      xTaskNotifyGive(Task);
+    }
+#else
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Pending = true;
+    }
+    Condition.notify_one();
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // wakes the task from interrupt context
+  void IRAM_ATTR notifyFromIsr()
+  {
+#ifdef ESP_PLATFORM
+    BaseType_t woken = pdFALSE;
+    if (Task)
+    {
+      vTaskNotifyGiveFromISR(Task, &woken);
+    }
+    if (woken)
+    {
+      portYIELD_FROM_ISR();
+    }
+#else
+    notify();
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // ISR trampoline for attachInterruptArg(pin, Wakeup::isr, &wakeup, mode)
+  static void IRAM_ATTR isr(void* wakeup)
+  {
+    static_cast<Wakeup*>(wakeup)->notifyFromIsr();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // blocks the calling task until notified or until timeout_ms has passed
+  // returns true if woken by a notification
+  bool wait(uint32_t timeout_ms)
+  {
+#ifdef ESP_PLATFORM
+    return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) != 0;
+#else
+    std::unique_lock<std::mutex> lock(Mutex);
+    bool woken = Condition.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return Pending; });
+    Pending    = false;
+    return woken;
+#endif
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+#ifdef ESP_PLATFORM
+  TaskHandle_t volatile   Task = nullptr;
+#else
+  std::mutex              Mutex;
+  std::condition_variable Condition;
+  bool                    Pending = false;
+#endif
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::rtos
+
+#endif // RTOS_WAKEUP_INCLUDED_HPP
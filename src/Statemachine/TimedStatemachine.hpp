@@ -2,6 +2,7 @@
 #define TIMED_STATEMACHINE_HPP_INCLUDED
 
 #include "Delta/TimeDelta.hpp"
+#include "Delta/Deadline.hpp"
 #include "Statemachine.hpp"
 
 
@@ -71,6 +72,16 @@ public:
     return dwell() >= time;
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// liefert die Restlaufzeit, bis die angegebene Verweilzeit erreicht ist.
+  /// Steht eine Transition an, ist der Automat sofort wieder fällig.
+  /// @param time  Soll-Verweilzeit
+  /// @return Restlaufzeit, 0 falls sofort fällig
+  inline uint32_t remaining(uint32_t time) const
+  {
+    return stateExit() ? 0 : delta::Deadline::until(dwell(), time);
+  }
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   using Statemachine<TStates>::operator=;
   using Statemachine<TStates>::stateEntry;
@@ -0,0 +1,53 @@
+#ifndef STATS_CYCLE_CLOCK_INCLUDED_HPP
+#define STATS_CYCLE_CLOCK_INCLUDED_HPP
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <Arduino.h>
+#include <xtensa/core-macros.h>
+#else
+#include <chrono>
+#endif
+
+namespace dps { namespace stats {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Free-running 32-bit cycle counter for short interval measurements.
+// On target this is the CCOUNT register of the executing core (usable from ISRs); host builds count nanoseconds.
+// Differences are wrap-safe as long as the measured interval is shorter than one counter period (~17 s at 240 MHz).
+class CycleClock
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  static inline uint32_t now()
+  {
+#ifdef ESP_PLATFORM
+    return XTHAL_GET_CCOUNT();
+#else
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // counter frequency [Hz]
+  static inline uint32_t hz()
+  {
+#ifdef ESP_PLATFORM
+    return getCpuFrequencyMhz() * 1000000UL;
+#else
+    return 1000000000UL;
+#endif
+  }
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::stats
+
+#endif // STATS_CYCLE_CLOCK_INCLUDED_HPP
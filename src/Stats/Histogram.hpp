@@ -0,0 +1,151 @@
+#ifndef STATS_HISTOGRAM_INCLUDED_HPP
+#define STATS_HISTOGRAM_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace dps { namespace stats {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// Fixed-bucket log2 histogram with exact min/max.
+// Bucket 0 counts zeros, bucket b > 0 counts values in [2^(b-1), 2^b - 1].
+// record() is meant to be called by a single writer; any other task may request a reset, which the writer carries out on its next record().
+// Other tasks read through a copy: record() is guarded by a sequence counter (seqlock), the copy constructor retries until it got the
+// counters of one consistent state. The writer never waits; its own reads may use the live object.
+class Histogram
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  enum
+  {
+    Buckets = 33,
+  };
+
+  Histogram() = default;
+
+  // consistent snapshot, may be taken by any task while the writer records
+  Histogram(Histogram const& other)
+  {
+    uint32_t before, after;
+    do
+    {
+      before = other.Sequence.load(std::memory_order_acquire);
+      copy(other);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = other.Sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || (before != after));
+  }
+
+  Histogram& operator=(Histogram const&) = delete;
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void record(uint32_t value)
+  {
+    uint32_t sequence = Sequence.load(std::memory_order_relaxed);
+    Sequence.store(sequence + 1, std::memory_order_relaxed);   // odd: update in progress
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (ResetPending.load(std::memory_order_relaxed))
+    {
+      clear();
+      ResetPending.store(false, std::memory_order_relaxed);
+    }
+
+    ++Counts[bucket(value)];
+    ++Count;
+    if (value < Min) Min = value;
+    if (value > Max) Max = value;
+
+    Sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void requestReset()
+  {
+    ResetPending.store(true, std::memory_order_relaxed);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  uint32_t count() const               { return Count;                    }
+  uint32_t min() const                 { return Count ? Min : 0;          }
+  uint32_t max() const                 { return Max;                      }
+  uint32_t bucketCount(size_t b) const { return Counts[b];                }
+
+  // number of buckets up to and including the highest populated one
+  size_t used() const
+  {
+    size_t n = Buckets;
+    while (n && !Counts[n - 1]) --n;
+    return n;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // upper bound of the bucket containing the given percentile (in per mille, e.g. 990 = p99), clipped to max()
+  uint32_t percentile(uint32_t permille) const
+  {
+    uint64_t rank = (static_cast<uint64_t>(Count) * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < Buckets; ++b)
+    {
+      seen += Counts[b];
+      if (seen && (seen >= rank))
+      {
+        auto bound = upperBound(b);
+        return (bound < Max) ? bound : Max;
+      }
+    }
+    return Max;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  static inline size_t bucket(uint32_t value)
+  {
+    return value ? (32 - __builtin_clz(value)) : 0;
+  }
+
+  static inline uint32_t upperBound(size_t b)
+  {
+    return b ? static_cast<uint32_t>((uint64_t(1) << b) - 1) : 0;
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // word by word, a torn copy is detected by the sequence
+  void copy(Histogram const& other)
+  {
+    for (size_t b = 0; b < Buckets; ++b)
+    {
+      Counts[b] = static_cast<uint32_t const volatile&>(other.Counts[b]);
+    }
+    Count = static_cast<uint32_t const volatile&>(other.Count);
+    Min   = static_cast<uint32_t const volatile&>(other.Min);
+    Max   = static_cast<uint32_t const volatile&>(other.Max);
+  }
+
+  void clear()
+  {
+    for (auto& c : Counts) c = 0;
+    Count = 0;
+    Min   = UINT32_MAX;
+    Max   = 0;
+  }
+
+  uint32_t              Counts[Buckets] = {};
+  uint32_t              Count           = 0;
+  uint32_t              Min             = UINT32_MAX;
+  uint32_t              Max             = 0;
+  std::atomic<bool>     ResetPending{false};
+  std::atomic<uint32_t> Sequence{0};   // odd while record() updates
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::stats
+
+#endif // STATS_HISTOGRAM_INCLUDED_HPP
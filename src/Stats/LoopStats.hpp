@@ -0,0 +1,140 @@
+#ifndef STATS_LOOP_STATS_INCLUDED_HPP
+#define STATS_LOOP_STATS_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CycleClock.hpp"
+#include "Histogram.hpp"
+
+// enable per-stage loop timing with -D DPS_LOOP_STATS=1
+#ifndef DPS_LOOP_STATS
+#define DPS_LOOP_STATS 0
+#endif
+
+namespace dps { namespace stats {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+enum class Stage : uint8_t
+{
+  Usart,
+  Pir,
+  Reader,
+  Uid,
+  Ring,
+  Inputs,
+};
+
+enum
+{
+  NrStages = 6,
+};
+
+inline char const* name(Stage stage)
+{
+  static char const* const Names[NrStages] = { "usart", "pir", "reader", "uid", "ring", "inputs" };
+  return Names[static_cast<size_t>(stage)];
+}
+
+
+//==============================================================================================================================================================
+// Cycle timing of the application stages.
+// @tparam Enabled  false: every member is an empty inline no-op, so disabled builds carry neither code nor data
+template <bool Enabled = (DPS_LOOP_STATS != 0)>
+class LoopStats;
+
+
+//==============================================================================================================================================================
+template <>
+class LoopStats<true>
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  static constexpr bool IsEnabled = true;
+
+  // measures the lifetime of the probe and records it into the stage's histogram
+  class Probe
+  {
+  public:
+    Probe(Histogram& histogram) : Target(histogram), Start(CycleClock::now()) {}
+    Probe(Probe const&)            = delete;
+    Probe& operator=(Probe const&) = delete;
+    ~Probe()
+    {
+      Target.record(CycleClock::now() - Start);
+    }
+
+  private:
+    Histogram& Target;
+    uint32_t   Start;
+  };
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  Probe measure(Stage stage)
+  {
+    return Probe(Stages[static_cast<size_t>(stage)]);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // fills a JSON object with the statistics of one stage (durations in cycles of 'hz'); from any task, it reports a snapshot
+  template <typename TObject>
+  void report(Stage stage, TObject&& obj) const
+  {
+    Histogram const h = Stages[static_cast<size_t>(stage)];
+
+    obj["stage"] = name(stage);
+    obj["hz"]    = CycleClock::hz();
+    obj["n"]     = h.count();
+    obj["min"]   = h.min();
+    obj["max"]   = h.max();
+    obj["p99"]   = h.percentile(990);
+
+    auto hist = obj.createNestedArray("log2");
+    for (size_t b = 0, n = h.used(); b < n; ++b)
+    {
+      hist.add(h.bucketCount(b));
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void reset()
+  {
+    for (auto& h : Stages) h.requestReset();
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  Histogram Stages[NrStages];
+};
+
+
+//==============================================================================================================================================================
+template <>
+class LoopStats<false>
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  static constexpr bool IsEnabled = false;
+
+  struct Probe
+  {
+    ~Probe() {}
+  };
+
+  Probe measure(Stage) { return {}; }
+
+  template <typename TObject>
+  void report(Stage, TObject&&) const {}
+
+  void reset() {}
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::stats
+
+#endif // STATS_LOOP_STATS_INCLUDED_HPP
@@ -0,0 +1,280 @@
+#ifndef TRACE_INCLUDED_HPP
+#define TRACE_INCLUDED_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "Delta/TimeSource.hpp"
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_attr.h>
+#elif !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif
+
+// enable span tracing with -D DPS_TRACE=1
+#ifndef DPS_TRACE
+#define DPS_TRACE 0
+#endif
+
+// number of records kept in the trace ring (power of two, 8 bytes each)
+#ifndef DPS_TRACE_CAPACITY
+#define DPS_TRACE_CAPACITY 1024
+#endif
+
+namespace dps { namespace trace {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+// span/event identifiers; the names are sent along with every dump (see name())
+enum class Id : uint8_t
+{
+  Protocol,
+  Usart,
+  Pir,
+  Uid,
+  Reader,
+  RfidIrq,
+  Render,
+  Fx,
+  Show,
+  FxState,
+  Inputs,
+};
+
+enum
+{
+  NrIds    = 11,
+  MaxTasks = 8,      // tasks told apart, later ones share index MaxTasks
+  Isr      = 0x7F,   // task index of records from interrupts
+};
+
+inline char const* name(Id id)
+{
+  static char const* const Names[NrIds] = { "protocol", "usart", "pir", "uid", "reader", "rfid_irq", "render", "fx", "show", "fx_state", "inputs" };
+  return Names[static_cast<size_t>(id)];
+}
+
+enum class Kind : uint8_t
+{
+  Begin,
+  End,
+  Instant,
+};
+
+// binary record as dumped over serial (little endian)
+struct Record
+{
+  uint32_t Time_us;  // lower 32 bits of the monotonic clock
+  uint8_t  Id;
+  uint8_t  Kind;
+  uint8_t  Task;     // bit 7: core, bits 0..6: task index (see Tracer::taskName()), Isr for interrupts
+  uint8_t  Arg;      // free argument, e.g. the state entered
+};
+static_assert(sizeof(Record) == 8, "trace records are dumped as 8 byte entries");
+
+
+//==============================================================================================================================================================
+// Global trace ring buffer.
+// Recording is lock- and allocation-free and may happen concurrently from any task or ISR on either core: a slot is claimed with a single atomic
+// increment and the oldest records are overwritten once the ring is full.
+// @tparam Enabled  false: every member is an empty inline no-op, so disabled builds carry neither code nor data
+template <bool Enabled = (DPS_TRACE != 0)>
+class Tracer;
+
+
+//==============================================================================================================================================================
+template <>
+class Tracer<true>
+{
+  enum : uint32_t
+  {
+    Capacity = DPS_TRACE_CAPACITY,
+    Mask     = Capacity - 1,
+  };
+  static_assert((Capacity & Mask) == 0, "trace capacity must be a power of two");
+
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  static constexpr bool IsEnabled = true;
+
+  static inline void IRAM_ATTR record(Id id, Kind kind, uint8_t arg = 0)
+  {
+    if (Paused.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    auto& r   = Records[Next.fetch_add(1, std::memory_order_relaxed) & Mask];
+    r.Time_us = static_cast<uint32_t>(common::delta::MonotonicSource<1>::micros64());
+    r.Id      = static_cast<uint8_t>(id);
+    r.Kind    = static_cast<uint8_t>(kind);
+    r.Task    = static_cast<uint8_t>((core() << 7) | task());
+    r.Arg     = arg;
+  }
+
+  static inline void IRAM_ATTR begin(Id id, uint8_t arg = 0)   { record(id, Kind::Begin,   arg); }
+  static inline void IRAM_ATTR end(Id id, uint8_t arg = 0)     { record(id, Kind::End,     arg); }
+  static inline void IRAM_ATTR instant(Id id, uint8_t arg = 0) { record(id, Kind::Instant, arg); }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // pauses recording so the buffer can be dumped consistently
+  // @return number of buffered records
+  static size_t freeze()
+  {
+    Paused.store(true, std::memory_order_seq_cst);
+    return size();
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // passes the records to 'write' in chronological order (as up to two contiguous chunks), optionally clears the buffer and resumes recording
+  // must be preceded by freeze()
+  template <typename TWrite>
+  static void dump(TWrite&& write, bool clear)
+  {
+    uint32_t next  = Next.load(std::memory_order_seq_cst);
+    uint32_t count = (next < Capacity) ? next : Capacity;
+    uint32_t first = (next - count) & Mask;
+    uint32_t chunk = (first + count <= Capacity) ? count : (Capacity - first);
+
+    write(reinterpret_cast<uint8_t const*>(&Records[first]), chunk * sizeof(Record));
+    if (chunk < count)
+    {
+      write(reinterpret_cast<uint8_t const*>(&Records[0]), (count - chunk) * sizeof(Record));
+    }
+
+    if (clear)
+    {
+      Next.store(0, std::memory_order_relaxed);
+    }
+    Paused.store(false, std::memory_order_seq_cst);
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  static size_t size()
+  {
+    uint32_t next = Next.load(std::memory_order_seq_cst);
+    return (next < Capacity) ? next : Capacity;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // name of the task behind a task index, nullptr if the index was not assigned
+  static char const* taskName(size_t index)
+  {
+    void* handle = (index < MaxTasks) ? Tasks[index].load(std::memory_order_relaxed) : nullptr;
+#ifdef ESP_PLATFORM
+    return handle ? pcTaskGetName(static_cast<TaskHandle_t>(handle)) : nullptr;
+#else
+    return handle ? "main" : nullptr;
+#endif
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  // small index of the running task, assigned on its first record; tasks time-sliced on one core thus get a track each
+  static inline uint8_t IRAM_ATTR task()
+  {
+#ifdef ESP_PLATFORM
+    if (xPortInIsrContext())
+    {
+      return Isr;
+    }
+    void* self = xTaskGetCurrentTaskHandle();
+#else
+    void* self = &Tasks;
+#endif
+    for (uint8_t i = 0; i < MaxTasks; ++i)
+    {
+      void* handle = Tasks[i].load(std::memory_order_relaxed);
+      if (!handle && Tasks[i].compare_exchange_strong(handle, self, std::memory_order_relaxed))
+      {
+        return i;
+      }
+      if (handle == self)
+      {
+        return i;
+      }
+    }
+    return MaxTasks;
+  }
+
+  static inline uint8_t IRAM_ATTR core()
+  {
+#ifdef ESP_PLATFORM
+    return static_cast<uint8_t>(xPortGetCoreID());
+#else
+    return 0;
+#endif
+  }
+
+  static inline Record                Records[Capacity] = {};
+  static inline std::atomic<uint32_t> Next{0};
+  static inline std::atomic<bool>     Paused{false};
+  static inline std::atomic<void*>    Tasks[MaxTasks] = {};
+};
+
+
+//==============================================================================================================================================================
+template <>
+class Tracer<false>
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  static constexpr bool IsEnabled = false;
+
+  static inline void record(Id, Kind, uint8_t = 0) {}
+  static inline void begin(Id, uint8_t = 0)        {}
+  static inline void end(Id, uint8_t = 0)          {}
+  static inline void instant(Id, uint8_t = 0)      {}
+
+  static size_t freeze() { return 0; }
+
+  template <typename TWrite>
+  static void dump(TWrite&&, bool) {}
+
+  static size_t size() { return 0; }
+
+  static char const* taskName(size_t) { return nullptr; }
+};
+
+using Trace = Tracer<>;
+
+
+//==============================================================================================================================================================
+// Scoped span: records 'begin' on construction and 'end' on destruction.
+class Span
+{
+//==============================================================================================================================================================
+public:
+//==============================================================================================================================================================
+  explicit Span(Id id, uint8_t arg = 0) : SpanId(id), Arg(arg)
+  {
+    Trace::begin(SpanId, Arg);
+  }
+
+  Span(Span const&)            = delete;
+  Span& operator=(Span const&) = delete;
+
+  ~Span()
+  {
+    Trace::end(SpanId, Arg);
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  Id      SpanId;
+  uint8_t Arg;
+};
+
+
+//==============================================================================================================================================================
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+}} // namespace dps::trace
+
+#endif // TRACE_INCLUDED_HPP
@@ -9,6 +9,8 @@ static dps::App* App;
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void setup()
 {
+  Serial.setRxBufferSize(dps::App::UartRxBuffer);
+  Serial.setTxBufferSize(dps::App::UartTxBuffer);
   Serial.begin(115200); // Initialize serial communications with the PC
 
   App = new dps::App();
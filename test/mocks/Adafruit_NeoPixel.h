@@ -0,0 +1,52 @@
+#ifndef MOCK_ADAFRUIT_NEOPIXEL_H
+#define MOCK_ADAFRUIT_NEOPIXEL_H
+
+// Host stand-in for the Adafruit NeoPixel library: the strip is a fixed pixel array, show() counts frames and keeps what was shown.
+
+#include <Arduino.h>
+
+#define NEO_GRB    0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel
+{
+  enum { MaxPixels = 64 };
+
+public:
+  Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t = NEO_GRB + NEO_KHZ800) : Count((n < uint16_t(MaxPixels)) ? n : uint16_t(MaxPixels)), Pin(pin) {}
+
+  void     begin()                                                  { pinMode(Pin, OUTPUT); }
+  void     setBrightness(uint8_t brightness)                        { Brightness = brightness; }
+  uint8_t  getBrightness() const                                    { return Brightness; }
+  uint16_t numPixels() const                                        { return Count; }
+  void     clear()                                                  { memset(Pixels, 0, sizeof(Pixels)); }
+
+  void     setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b)
+  {
+    if (i < Count)
+    {
+      Pixels[i] = (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+    }
+  }
+
+  uint32_t getPixelColor(uint16_t i) const                          { return (i < Count) ? Pixels[i] : 0; }
+
+  void     show()
+  {
+    memcpy(Shown, Pixels, sizeof(Shown));
+    ++Shows;
+  }
+
+  // test side
+  uint32_t shown(uint16_t i) const                                  { return Shown[i]; }
+  uint32_t Shows = 0;
+
+private:
+  uint16_t Count;
+  int16_t  Pin;
+  uint8_t  Brightness         = 255;
+  uint32_t Pixels[MaxPixels]  = {};
+  uint32_t Shown[MaxPixels]   = {};
+};
+
+#endif // MOCK_ADAFRUIT_NEOPIXEL_H
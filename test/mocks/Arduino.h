@@ -0,0 +1,317 @@
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino core the firmware uses (native test environment only).
+// Time is real (steady_clock); pins and the serial port are simulated and can be driven through mock::.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <string>
+#include <functional>
+
+typedef uint8_t byte;
+
+#define LOW          0x0
+#define HIGH         0x1
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING       0x01
+#define FALLING      0x02
+#define CHANGE       0x03
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+//==============================================================================================================================================================
+// time
+inline unsigned long micros()
+{
+  using namespace std::chrono;
+  return static_cast<unsigned long>(static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count()));
+}
+
+inline unsigned long millis()
+{
+  using namespace std::chrono;
+  return static_cast<unsigned long>(static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count()));
+}
+
+inline void delay(uint32_t ms)             { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield()                        { std::this_thread::yield(); }
+
+inline uint32_t getCpuFrequencyMhz()       { return 240; }
+
+
+//==============================================================================================================================================================
+// GPIO
+namespace mock {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+enum { PinCount = 40 };
+
+struct Pin
+{
+  int    Mode    = INPUT;
+  int    Level   = HIGH;
+  int    Edge    = 0;         // RISING, FALLING, CHANGE or 0 without interrupt
+  void (*Isr)(void*) = nullptr;
+  void*  Arg     = nullptr;
+  int    Writes  = 0;
+  void (*Wire)(void*, int) = nullptr;   // device on the other end, told about every level change (see connect())
+  void*  WireArg = nullptr;
+};
+
+inline Pin Pins[PinCount];
+
+//==============================================================================================================================================================
+// sets the level seen on a pin and runs its interrupt handler (in the calling thread) if the edge matches
+inline void setPin(uint8_t pin, int level)
+{
+  Pin& p   = Pins[pin];
+  int  was = p.Level;
+  p.Level  = level ? HIGH : LOW;
+  if ((p.Wire != nullptr) && (was != p.Level))
+  {
+    p.Wire(p.WireArg, p.Level);
+  }
+  if ((p.Isr != nullptr) && (was != p.Level))
+  {
+    int edge = p.Level ? RISING : FALLING;
+    if ((p.Edge == CHANGE) || (p.Edge == edge))
+    {
+      p.Isr(p.Arg);
+    }
+  }
+}
+
+//==============================================================================================================================================================
+// lets a simulated device follow a pin driven by the firmware, e.g. a reset line
+inline void connect(uint8_t pin, void (*wire)(void*, int), void* arg)
+{
+  Pins[pin].Wire    = wire;
+  Pins[pin].WireArg = arg;
+}
+
+//==============================================================================================================================================================
+inline void resetPins()
+{
+  for (auto& p : Pins)
+  {
+    p = Pin();
+  }
+}
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+} // namespace mock
+
+inline void pinMode(uint8_t pin, uint8_t mode)          { mock::Pins[pin].Mode = mode; }
+inline int  digitalRead(uint8_t pin)                    { return mock::Pins[pin].Level; }
+inline void digitalWrite(uint8_t pin, uint8_t level)    { ++mock::Pins[pin].Writes; mock::setPin(pin, level); }
+inline int  digitalPinToInterrupt(uint8_t pin)          { return pin; }
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode)
+{
+  mock::Pins[pin].Isr  = isr;
+  mock::Pins[pin].Arg  = arg;
+  mock::Pins[pin].Edge = mode;
+}
+
+inline void detachInterrupt(uint8_t pin)
+{
+  mock::Pins[pin].Isr  = nullptr;
+  mock::Pins[pin].Edge = 0;
+}
+
+
+//==============================================================================================================================================================
+// streams
+class Print
+{
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(uint8_t const* buffer, size_t size)
+  {
+    size_t n = 0;
+    while (size-- && write(*buffer++))
+    {
+      ++n;
+    }
+    return n;
+  }
+  size_t write(char const* s)                   { return write(reinterpret_cast<uint8_t const*>(s), strlen(s)); }
+  size_t write(char const* buffer, size_t size) { return write(reinterpret_cast<uint8_t const*>(buffer), size); }
+
+  virtual int availableForWrite() { return 0; }
+  virtual void flush()            {}
+
+  size_t print(char const* s)     { return write(s); }
+  size_t print(long v)            { return print(std::to_string(v).c_str()); }
+  size_t print(unsigned long v)   { return print(std::to_string(v).c_str()); }
+  size_t print(int v)             { return print(static_cast<long>(v)); }
+  size_t print(unsigned v)        { return print(static_cast<unsigned long>(v)); }
+  size_t println()                { return write("\r\n"); }
+  template <typename T>
+  size_t println(T v)             { return print(v) + println(); }
+};
+
+//==============================================================================================================================================================
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read()      = 0;
+  virtual int peek()      = 0;
+
+  virtual size_t readBytes(uint8_t* buffer, size_t length)
+  {
+    size_t n = 0;
+    int    c;
+    while ((n < length) && ((c = read()) >= 0))
+    {
+      buffer[n++] = static_cast<uint8_t>(c);
+    }
+    return n;
+  }
+  size_t readBytes(char* buffer, size_t length) { return readBytes(reinterpret_cast<uint8_t*>(buffer), length); }
+
+  void setTimeout(unsigned long) {}
+};
+
+
+//==============================================================================================================================================================
+// UART with driver sized RX/TX rings. The test side injects received bytes (dropped beyond the RX ring like the driver does) and takes what was sent.
+class HardwareSerial : public Stream
+{
+public:
+  void   begin(unsigned long baud)                        { Baud = baud; }
+  void   end()                                            {}
+  size_t setRxBufferSize(size_t size)                     { RxSize = size; return size; }
+  size_t setTxBufferSize(size_t size)                     { TxSize = size; return size; }
+  void   onReceive(std::function<void()> callback, bool = false) { std::lock_guard<std::mutex> lock(Mutex); OnReceive = callback; }
+
+  int available() override
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return static_cast<int>(Rx.size() - RxRead);
+  }
+
+  int read() override
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return (RxRead < Rx.size()) ? static_cast<uint8_t>(Rx[RxRead++]) : -1;
+  }
+
+  int peek() override
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return (RxRead < Rx.size()) ? static_cast<uint8_t>(Rx[RxRead]) : -1;
+  }
+
+  size_t readBytes(uint8_t* buffer, size_t length) override
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    size_t n = std::min(length, Rx.size() - RxRead);
+    memcpy(buffer, Rx.data() + RxRead, n);
+    RxRead += n;
+    return n;
+  }
+  using Stream::readBytes;
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(uint8_t const* buffer, size_t size) override
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Tx.append(reinterpret_cast<char const*>(buffer), size);
+    return size;
+  }
+  using Print::write;
+
+  int availableForWrite() override
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return (Tx.size() < TxSize) ? static_cast<int>(TxSize - Tx.size()) : 0;
+  }
+
+  // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+  // test side
+
+  // bytes arriving on the line; returns how many fitted into the RX ring
+  size_t inject(void const* data, size_t length)
+  {
+    std::function<void()> callback;
+    size_t                n;
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Rx.erase(0, RxRead);
+      RxRead = 0;
+      n      = std::min(length, (Rx.size() < RxSize) ? RxSize - Rx.size() : 0);
+      Rx.append(static_cast<char const*>(data), n);
+      Dropped += length - n;
+      callback = OnReceive;
+    }
+    if (callback && n)
+    {
+      callback();
+    }
+    return n;
+  }
+  size_t inject(char const* s) { return inject(s, strlen(s)); }
+
+  // everything sent since the last call, frees the TX ring
+  std::string take()
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    std::string sent;
+    sent.swap(Tx);
+    return sent;
+  }
+
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Rx.clear();
+    Tx.clear();
+    RxRead    = 0;
+    Dropped   = 0;
+    OnReceive = nullptr;
+  }
+
+  unsigned long Baud    = 0;
+  size_t        RxSize  = 256;
+  size_t        TxSize  = 128;
+  size_t        Dropped = 0;
+
+private:
+  std::mutex            Mutex;
+  std::string           Rx;
+  size_t                RxRead = 0;
+  std::string           Tx;
+  std::function<void()> OnReceive;
+};
+
+inline HardwareSerial Serial;
+
+
+//==============================================================================================================================================================
+class EspClass
+{
+public:
+  uint32_t getCycleCount() { return static_cast<uint32_t>(micros() * getCpuFrequencyMhz()); }
+  void     restart()       {}
+};
+
+inline EspClass ESP;
+
+#endif // MOCK_ARDUINO_H
@@ -0,0 +1,888 @@
+#ifndef MOCK_MFRC522_H
+#define MOCK_MFRC522_H
+
+// Host stand-in for the MFRC522 library, backed by a simulated chip and the tags in its field (mock::Chip, mock::Tag).
+// The register interface is reached over the SPI mock (as RegisterBatch does), the library calls act directly on the simulated field.
+// Only what the firmware uses is modelled: REQA/WUPA, anticollision by lowest UID, select, HLTA, MIFARE Classic key A authentication and
+// READ, Ultralight READ/FAST_READ, CRC_A, the RX interrupt with its IRQ pin, hard reset through RST, brown-outs and a dead chip.
+// RF exchanges can be given an air time (Exchange_us, Byte_us) to make timings measurable.
+// Faults for the recovery paths: a latched-up chip with a garbled VersionReg, overwritten registers and a bus that stops answering for a while.
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <array>
+#include <chrono>
+#include <vector>
+
+//==============================================================================================================================================================
+class MFRC522
+{
+public:
+  enum PCD_Register : byte
+  {
+    CommandReg        = 0x01 << 1,
+    ComIEnReg         = 0x02 << 1,
+    DivIEnReg         = 0x03 << 1,
+    ComIrqReg         = 0x04 << 1,
+    DivIrqReg         = 0x05 << 1,
+    ErrorReg          = 0x06 << 1,
+    Status1Reg        = 0x07 << 1,
+    Status2Reg        = 0x08 << 1,
+    FIFODataReg       = 0x09 << 1,
+    FIFOLevelReg      = 0x0A << 1,
+    WaterLevelReg     = 0x0B << 1,
+    ControlReg        = 0x0C << 1,
+    BitFramingReg     = 0x0D << 1,
+    CollReg           = 0x0E << 1,
+    ModeReg           = 0x11 << 1,
+    TxModeReg         = 0x12 << 1,
+    RxModeReg         = 0x13 << 1,
+    TxControlReg      = 0x14 << 1,
+    TxASKReg          = 0x15 << 1,
+    TxSelReg          = 0x16 << 1,
+    RxSelReg          = 0x17 << 1,
+    RxThresholdReg    = 0x18 << 1,
+    DemodReg          = 0x19 << 1,
+    MfTxReg           = 0x1C << 1,
+    MfRxReg           = 0x1D << 1,
+    SerialSpeedReg    = 0x1F << 1,
+    CRCResultRegH     = 0x21 << 1,
+    CRCResultRegL     = 0x22 << 1,
+    ModWidthReg       = 0x24 << 1,
+    RFCfgReg          = 0x26 << 1,
+    GsNReg            = 0x27 << 1,
+    CWGsPReg          = 0x28 << 1,
+    ModGsPReg         = 0x29 << 1,
+    TModeReg          = 0x2A << 1,
+    TPrescalerReg     = 0x2B << 1,
+    TReloadRegH       = 0x2C << 1,
+    TReloadRegL       = 0x2D << 1,
+    TCounterValueRegH = 0x2E << 1,
+    TCounterValueRegL = 0x2F << 1,
+    VersionReg        = 0x37 << 1,
+  };
+
+  enum PCD_Command : byte
+  {
+    PCD_Idle       = 0x00,
+    PCD_Mem        = 0x01,
+    PCD_CalcCRC    = 0x03,
+    PCD_Transmit   = 0x04,
+    PCD_Receive    = 0x08,
+    PCD_Transceive = 0x0C,
+    PCD_MFAuthent  = 0x0E,
+    PCD_SoftReset  = 0x0F,
+  };
+
+  enum PICC_Command : byte
+  {
+    PICC_CMD_REQA          = 0x26,
+    PICC_CMD_WUPA          = 0x52,
+    PICC_CMD_CT            = 0x88,
+    PICC_CMD_SEL_CL1       = 0x93,
+    PICC_CMD_SEL_CL2       = 0x95,
+    PICC_CMD_SEL_CL3       = 0x97,
+    PICC_CMD_HLTA          = 0x50,
+    PICC_CMD_MF_AUTH_KEY_A = 0x60,
+    PICC_CMD_MF_AUTH_KEY_B = 0x61,
+    PICC_CMD_MF_READ       = 0x30,
+    PICC_CMD_MF_WRITE      = 0xA0,
+    PICC_CMD_UL_WRITE      = 0xA2,
+  };
+
+  enum StatusCode : byte
+  {
+    STATUS_OK,
+    STATUS_ERROR,
+    STATUS_COLLISION,
+    STATUS_TIMEOUT,
+    STATUS_NO_ROOM,
+    STATUS_INTERNAL_ERROR,
+    STATUS_INVALID,
+    STATUS_CRC_WRONG,
+    STATUS_MIFARE_NACK = 0xff,
+  };
+
+  enum PICC_Type : byte
+  {
+    PICC_TYPE_UNKNOWN,
+    PICC_TYPE_ISO_14443_4,
+    PICC_TYPE_ISO_18092,
+    PICC_TYPE_MIFARE_MINI,
+    PICC_TYPE_MIFARE_1K,
+    PICC_TYPE_MIFARE_4K,
+    PICC_TYPE_MIFARE_UL,
+    PICC_TYPE_MIFARE_PLUS,
+    PICC_TYPE_MIFARE_DESFIRE,
+    PICC_TYPE_TNP3XXX,
+    PICC_TYPE_NOT_COMPLETE = 0xff,
+  };
+
+  enum : byte
+  {
+    MF_KEY_SIZE = 6,
+  };
+
+  struct Uid
+  {
+    byte size;
+    byte uidByte[10];
+    byte sak;
+  };
+
+  struct MIFARE_Key
+  {
+    byte keyByte[MF_KEY_SIZE];
+  };
+
+  Uid uid = {};
+
+  MFRC522(byte chipSelectPin, byte resetPowerDownPin) : Ss(chipSelectPin), Rst(resetPowerDownPin) {}
+
+  void       PCD_Init();
+  StatusCode PCD_CalculateCRC(byte* data, byte length, byte* result);
+  StatusCode PCD_TransceiveData(byte* sendData, byte sendLen, byte* backData, byte* backLen, byte* validBits = nullptr, byte rxAlign = 0,
+                                bool checkCRC = false);
+  StatusCode PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key* key, Uid* uid);
+  void       PCD_StopCrypto1();
+  StatusCode PICC_RequestA(byte* bufferATQA, byte* bufferSize);
+  StatusCode PICC_WakeupA(byte* bufferATQA, byte* bufferSize);
+  StatusCode PICC_Select(Uid* uid, byte validBits = 0);
+  StatusCode PICC_HaltA();
+  StatusCode MIFARE_Read(byte blockAddr, byte* buffer, byte* bufferSize);
+  bool       PICC_ReadCardSerial();
+
+  static PICC_Type PICC_GetType(byte sak)
+  {
+    switch (sak & 0x7F)
+    {
+    case 0x04: return PICC_TYPE_NOT_COMPLETE;
+    case 0x09: return PICC_TYPE_MIFARE_MINI;
+    case 0x08: return PICC_TYPE_MIFARE_1K;
+    case 0x18: return PICC_TYPE_MIFARE_4K;
+    case 0x00: return PICC_TYPE_MIFARE_UL;
+    case 0x10:
+    case 0x11: return PICC_TYPE_MIFARE_PLUS;
+    case 0x01: return PICC_TYPE_TNP3XXX;
+    case 0x20: return PICC_TYPE_ISO_14443_4;
+    case 0x40: return PICC_TYPE_ISO_18092;
+    default:   return PICC_TYPE_UNKNOWN;
+    }
+  }
+
+private:
+  byte Ss;
+  byte Rst;
+};
+
+
+namespace mock {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// CRC_A of ISO 14443-3 (preset 0x6363), low byte first
+inline void crcA(uint8_t const* data, size_t length, uint8_t* result)
+{
+  uint16_t crc = 0x6363;
+  for (size_t i = 0; i < length; ++i)
+  {
+    uint8_t ch = static_cast<uint8_t>(data[i] ^ crc);
+    ch  = static_cast<uint8_t>(ch ^ (ch << 4));
+    crc = static_cast<uint16_t>((crc >> 8) ^ (ch << 8) ^ (ch << 3) ^ (ch >> 4));
+  }
+  result[0] = static_cast<uint8_t>(crc);
+  result[1] = static_cast<uint8_t>(crc >> 8);
+}
+
+
+//==============================================================================================================================================================
+// a tag in the field of a Chip
+struct Tag
+{
+  enum class State : uint8_t { Idle, Ready, Active, Halted };
+
+  using TKey = std::array<uint8_t, MFRC522::MF_KEY_SIZE>;
+
+  MFRC522::Uid         Uid        = {};
+  std::vector<uint8_t> Memory;             // Ultralight: pages of 4 bytes, Classic: blocks of 16 bytes
+  std::vector<TKey>    KeysA;              // Classic: key A per sector
+  bool                 FastRead   = true;  // Ultralight: NTAG21x/EV1 command set
+  State                Now        = State::Idle;
+  int                  AuthSector = -1;    // Classic: sector authenticated with (crypto on)
+
+  bool classic() const { return MFRC522::PICC_GetType(Uid.sak) != MFRC522::PICC_TYPE_MIFARE_UL; }
+
+  bool is(MFRC522::Uid const& uid) const
+  {
+    return (uid.size == Uid.size) && !memcmp(uid.uidByte, Uid.uidByte, Uid.size);
+  }
+
+  // NTAG21x-like tag with a 7 byte UID; page p holds p*4+i ^ serial in byte i
+  static Tag ultralight(uint8_t serial, size_t pages = 45)
+  {
+    Tag tag;
+    uint8_t const uid[] = { 0x04, serial, 0x10, 0x20, 0x30, 0x40, 0x50 };
+    tag.Uid.size = sizeof(uid);
+    tag.Uid.sak  = 0x00;
+    memcpy(tag.Uid.uidByte, uid, sizeof(uid));
+    tag.Memory.resize(4 * pages);
+    for (size_t i = 0; i < tag.Memory.size(); ++i)
+    {
+      tag.Memory[i] = static_cast<uint8_t>(i ^ serial);
+    }
+    return tag;
+  }
+
+  // MIFARE Classic 1K with a 4 byte UID and transport keys; block b holds b*16+i ^ serial in byte i
+  static Tag classic(uint8_t serial)
+  {
+    Tag tag;
+    uint8_t const uid[] = { 0xC0, serial, 0x5A, 0xA5 };
+    tag.Uid.size = sizeof(uid);
+    tag.Uid.sak  = 0x08;
+    memcpy(tag.Uid.uidByte, uid, sizeof(uid));
+    tag.Memory.resize(64 * 16);
+    for (size_t i = 0; i < tag.Memory.size(); ++i)
+    {
+      tag.Memory[i] = static_cast<uint8_t>(i ^ serial);
+    }
+    tag.KeysA.assign(16, TKey{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF });
+    return tag;
+  }
+};
+
+
+//==============================================================================================================================================================
+// Simulated MFRC522 with the tags in its antenna field. Registers itself as the SPI device of its chip select and follows its RST pin.
+class Chip : public SpiDevice
+{
+public:
+  // exchanges with the field since construction
+  struct Counters
+  {
+    uint32_t Reqa, Wupa, Selects, SelectFailures, Halts, Auths, AuthFailures, Reads, FastReads, Crcs, Resets, Irqs, Timeouts;
+    uint32_t Arms;   // receiver re-arms (REQA by StartSend), i.e. polls of the field for new tags
+  };
+
+  enum : uint8_t
+  {
+    Version = 0x92,
+  };
+
+  Chip(uint8_t ss, uint8_t rst, uint8_t irq) : Ss(ss), Rst(rst), Irq(irq)
+  {
+    SpiDevices[Ss] = this;
+    Chips[Ss]      = this;
+    connect(Rst, wire, this);
+    setPin(Irq, HIGH);
+    reset();
+  }
+
+  ~Chip() override
+  {
+    SpiDevices[Ss] = nullptr;
+    Chips[Ss]      = nullptr;
+    connect(Rst, nullptr, nullptr);
+  }
+
+  Chip(Chip const&)            = delete;
+  Chip& operator=(Chip const&) = delete;
+
+  static inline Chip* Chips[PinCount] = {};
+
+  // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+  // test side
+
+  void enter(Tag const& tag)
+  {
+    Field.push_back(tag);
+    Field.back().Now = Tag::State::Idle;
+  }
+
+  bool leave(MFRC522::Uid const& uid)
+  {
+    for (auto it = Field.begin(); it != Field.end(); ++it)
+    {
+      if (it->is(uid))
+      {
+        Field.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  Tag* find(MFRC522::Uid const& uid)
+  {
+    for (auto& tag : Field)
+    {
+      if (tag.is(uid))
+      {
+        return &tag;
+      }
+    }
+    return nullptr;
+  }
+
+  // supply dip: the chip restarts with its power-on defaults (antenna off, interrupts off), the tags lose power
+  void brownout()
+  {
+    reset();
+    for (auto& tag : Field)
+    {
+      tag.Now        = Tag::State::Idle;
+      tag.AuthSector = -1;
+    }
+  }
+
+  uint8_t reg(MFRC522::PCD_Register reg) const { return Regs[reg >> 1]; }
+
+  // overwrites a register behind the firmware's back (e.g. ComIEnReg cleared by a glitch)
+  void poke(MFRC522::PCD_Register reg, uint8_t value)
+  {
+    Regs[reg >> 1] = value;
+    updateIrq();
+  }
+
+  // RF noise latch-up: VersionReg reads garbage until the next hard reset
+  void latchUp()
+  {
+    Latched = true;
+  }
+
+  // the chip stops answering for 'ms': SPI reads float high (0xFF), writes are lost, RF exchanges time out; a reset does not help
+  void stall(uint32_t ms)
+  {
+    StallEnd_ms = static_cast<uint32_t>(millis() + ms);
+    Stalled     = true;
+  }
+
+  bool stalled()
+  {
+    Stalled = Stalled && (static_cast<int32_t>(StallEnd_ms - static_cast<uint32_t>(millis())) > 0);
+    return Stalled;
+  }
+
+  std::vector<Tag> Field;
+  Counters         Ops          = {};
+  bool             Dead         = false;      // stops answering: SPI reads 0x00, RF exchanges time out
+  uint32_t         MaxClock     = 10000000;   // register reads above this SPI clock come back corrupted
+  int              FailSelects  = 0;          // anticollisions that fail from now on (tag leaving mid-exchange)
+  uint32_t         Exchange_us  = 0;          // simulated air time of every RF exchange (frames, turnaround, timeouts) ...
+  uint32_t         Byte_us      = 0;          // ... plus this per byte answered by a tag
+
+  // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+  // SPI: the first byte of a frame is the address (bit 7 read); reads are pipelined, writes stream into one register
+
+  uint8_t transfer(uint8_t mosi, bool start, uint32_t clock) override
+  {
+    if (stalled())
+    {
+      ++Ops.Timeouts;
+      return 0xFF;
+    }
+    if (!alive())
+    {
+      return 0x00;
+    }
+
+    uint8_t miso = 0x00;
+    if (start)
+    {
+      Address = mosi;
+    }
+    else if (!(Address & 0x80))
+    {
+      write(Address >> 1 & 0x3F, mosi);
+      return 0x00;
+    }
+    else
+    {
+      miso = Pending;
+    }
+
+    // reads: this byte is the next address, its value goes out with the next byte
+    if (mosi & 0x80)
+    {
+      Pending = read(mosi >> 1 & 0x3F);
+      Pending = (clock > MaxClock) ? static_cast<uint8_t>(Pending ^ 0x10) : Pending;
+    }
+    return miso;
+  }
+
+  // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+  // library side, see MFRC522
+
+  bool alive()       { return !Dead && !PowerDown && !stalled(); }
+  bool radio()       { return alive() && ((Regs[MFRC522::TxControlReg >> 1] & 0x03) == 0x03); }
+
+  void softReset()
+  {
+    reset();
+  }
+
+  // spends the air time of one RF exchange (busy, like the library's polling of ComIrqReg)
+  void air(size_t bytes = 0)
+  {
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(Exchange_us + bytes * Byte_us);
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+  }
+
+  // REQA: idle tags answer, WUPA: halted ones too; returns the number of tags that answered
+  size_t request(bool wakeup)
+  {
+    ++(wakeup ? Ops.Wupa : Ops.Reqa);
+    size_t answered = 0;
+    if (radio())
+    {
+      for (auto& tag : Field)
+      {
+        if ((tag.Now == Tag::State::Idle) || (tag.Now == Tag::State::Ready) || (wakeup && (tag.Now == Tag::State::Halted)))
+        {
+          tag.Now = Tag::State::Ready;
+          ++answered;
+        }
+        else if (tag.Now == Tag::State::Active)
+        {
+          tag.Now        = Tag::State::Idle;
+          tag.AuthSector = -1;
+        }
+      }
+    }
+    air(answered ? 2 : 0);   // ATQA
+    return answered;
+  }
+
+  // anticollision and select: the ready tag with the lowest UID wins, the others fall back to idle
+  Tag* anticollision()
+  {
+    ++Ops.Selects;
+    Tag* winner = nullptr;
+    for (auto& tag : Field)
+    {
+      if (radio() && (tag.Now == Tag::State::Ready) &&
+          (!winner || (memcmp(tag.Uid.uidByte, winner->Uid.uidByte, std::min(tag.Uid.size, winner->Uid.size)) < 0)))
+      {
+        winner = &tag;
+      }
+    }
+    if (winner && (FailSelects > 0))
+    {
+      --FailSelects;
+      winner = nullptr;
+    }
+    Ops.SelectFailures += !winner;
+    air(winner ? winner->Uid.size + 1 : 0);   // UID and SAK
+    return activate(winner);
+  }
+
+  // select by the full UID
+  Tag* select(MFRC522::Uid const& uid)
+  {
+    ++Ops.Selects;
+    Tag* tag = radio() ? find(uid) : nullptr;
+    tag      = (tag && (tag->Now == Tag::State::Ready)) ? tag : nullptr;
+    Ops.SelectFailures += !tag;
+    air(tag ? 1 : 0);
+    return activate(tag);
+  }
+
+  Tag* active()
+  {
+    for (auto& tag : Field)
+    {
+      if (radio() && (tag.Now == Tag::State::Active))
+      {
+        return &tag;
+      }
+    }
+    return nullptr;
+  }
+
+  // a tag that NAKs or fails an authentication returns to idle
+  void drop(Tag& tag)
+  {
+    tag.Now        = Tag::State::Idle;
+    tag.AuthSector = -1;
+  }
+
+//==============================================================================================================================================================
+private:
+//==============================================================================================================================================================
+  Tag* activate(Tag* winner)
+  {
+    for (auto& tag : Field)
+    {
+      if ((&tag != winner) && (tag.Now == Tag::State::Ready))
+      {
+        tag.Now = Tag::State::Idle;
+      }
+    }
+    if (winner)
+    {
+      winner->Now        = Tag::State::Active;
+      winner->AuthSector = -1;
+    }
+    return winner;
+  }
+
+  // power-on defaults of the registers that matter here
+  void reset()
+  {
+    memset(Regs, 0, sizeof(Regs));
+    Regs[MFRC522::CommandReg >> 1]   = 0x20;
+    Regs[MFRC522::ComIEnReg >> 1]    = 0x80;
+    Regs[MFRC522::ComIrqReg >> 1]    = 0x14;
+    Regs[MFRC522::ModeReg >> 1]      = 0x3F;
+    Regs[MFRC522::TxControlReg >> 1] = 0x80;
+    Regs[MFRC522::ModWidthReg >> 1]  = 0x26;
+    Fifo.clear();
+    ++Ops.Resets;
+    updateIrq();
+  }
+
+  uint8_t read(uint8_t reg)
+  {
+    switch (reg)
+    {
+    case MFRC522::VersionReg >> 1:
+      return Latched ? 0x3C : Version;
+
+    case MFRC522::FIFODataReg >> 1:
+    {
+      if (Fifo.empty())
+      {
+        return 0x00;
+      }
+      uint8_t value = Fifo.front();
+      Fifo.erase(Fifo.begin());
+      return value;
+    }
+
+    case MFRC522::FIFOLevelReg >> 1:
+      return static_cast<uint8_t>(Fifo.size());
+
+    default:
+      return Regs[reg];
+    }
+  }
+
+  void write(uint8_t reg, uint8_t value)
+  {
+    switch (reg)
+    {
+    case MFRC522::CommandReg >> 1:
+      Regs[reg] = value;
+      if ((value & 0x0F) == MFRC522::PCD_SoftReset)
+      {
+        reset();
+      }
+      break;
+
+    case MFRC522::ComIrqReg >> 1:
+      Regs[reg] = (value & 0x80) ? (Regs[reg] | (value & 0x7F)) : (Regs[reg] & ~value);
+      updateIrq();
+      break;
+
+    case MFRC522::ComIEnReg >> 1:
+      Regs[reg] = value;
+      updateIrq();
+      break;
+
+    case MFRC522::FIFODataReg >> 1:
+      Fifo.push_back(value);
+      break;
+
+    case MFRC522::FIFOLevelReg >> 1:
+      if (value & 0x80)
+      {
+        Fifo.clear();
+      }
+      break;
+
+    case MFRC522::BitFramingReg >> 1:
+      Regs[reg] = value & 0x7F;
+      if ((value & 0x80) && ((Regs[MFRC522::CommandReg >> 1] & 0x0F) == MFRC522::PCD_Transceive))
+      {
+        transceive();
+      }
+      break;
+
+    case MFRC522::VersionReg >> 1:
+      break;
+
+    default:
+      Regs[reg] = value;
+      break;
+    }
+  }
+
+  // StartSend of a REQA/WUPA from the FIFO, as the receiver re-arm does: any answer raises RxIRq
+  void transceive()
+  {
+    std::vector<uint8_t> frame;
+    frame.swap(Fifo);
+    if ((frame.size() == 1) && ((frame[0] == MFRC522::PICC_CMD_REQA) || (frame[0] == MFRC522::PICC_CMD_WUPA)))
+    {
+      Ops.Arms += (frame[0] == MFRC522::PICC_CMD_REQA);
+      bool answered = request(frame[0] == MFRC522::PICC_CMD_WUPA) > 0;
+      Regs[MFRC522::ComIrqReg >> 1] |= answered ? 0x20 : 0x01;   // RxIRq / TimerIRq
+      if (answered)
+      {
+        Fifo = { 0x44, 0x00 };                                    // ATQA
+      }
+      updateIrq();
+    }
+  }
+
+  // IRQ pin: enabled and pending interrupts, inverted (active low) with IRqInv
+  void updateIrq()
+  {
+    bool active = (Regs[MFRC522::ComIrqReg >> 1] & Regs[MFRC522::ComIEnReg >> 1] & 0x7F) != 0;
+    bool invert = (Regs[MFRC522::ComIEnReg >> 1] & 0x80) != 0;
+    int  level  = (active != invert) ? HIGH : LOW;
+    if (active && (Pins[Irq].Level != level))
+    {
+      ++Ops.Irqs;
+    }
+    setPin(Irq, level);
+  }
+
+  // RST: low powers the chip down, the rising edge restarts it with defaults
+  static void wire(void* self, int level)
+  {
+    auto& chip = *static_cast<Chip*>(self);
+    chip.PowerDown = (level == LOW);
+    if (level == HIGH)
+    {
+      chip.Latched = false;
+      chip.brownout();
+    }
+  }
+
+  uint8_t              Ss, Rst, Irq;
+  uint8_t              Regs[64];
+  std::vector<uint8_t> Fifo;
+  uint8_t              Address     = 0;
+  uint8_t              Pending     = 0;
+  bool                 PowerDown   = false;
+  bool                 Latched     = false;
+  bool                 Stalled     = false;
+  uint32_t             StallEnd_ms = 0;
+};
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+} // namespace mock
+
+
+//==============================================================================================================================================================
+// library calls on the simulated chip of the chip select pin; without one (or with a dead chip) everything times out
+inline void MFRC522::PCD_Init()
+{
+  pinMode(Ss, OUTPUT);
+  digitalWrite(Ss, HIGH);
+
+  auto chip = mock::Chip::Chips[Ss];
+  if (!chip || !chip->alive())
+  {
+    return;
+  }
+  chip->softReset();
+  // as the library: timer, 100 % ASK, CRC preset 0x6363, antenna on
+  uint8_t const config[][2] = { { TModeReg, 0x80 }, { TPrescalerReg, 0xA9 }, { TReloadRegH, 0x03 }, { TReloadRegL, 0xE8 },
+                                { TxASKReg, 0x40 }, { ModeReg, 0x3D },       { TxControlReg, 0x83 } };
+  for (auto const& reg : config)
+  {
+    SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+    digitalWrite(Ss, LOW);
+    SPI.transfer(reg[0]);
+    SPI.transfer(reg[1]);
+    digitalWrite(Ss, HIGH);
+    SPI.endTransaction();
+  }
+}
+
+inline MFRC522::StatusCode MFRC522::PCD_CalculateCRC(byte* data, byte length, byte* result)
+{
+  auto chip = mock::Chip::Chips[Ss];
+  if (!chip || !chip->alive())
+  {
+    return STATUS_TIMEOUT;
+  }
+  ++chip->Ops.Crcs;
+  mock::crcA(data, length, result);
+  return STATUS_OK;
+}
+
+// FAST_READ only: 0x3A start end CRC_A, answered by the pages and their CRC_A
+inline MFRC522::StatusCode MFRC522::PCD_TransceiveData(byte* sendData, byte sendLen, byte* backData, byte* backLen, byte*, byte, bool)
+{
+  auto chip = mock::Chip::Chips[Ss];
+  auto tag  = chip ? chip->active() : nullptr;
+  if (!tag)
+  {
+    return STATUS_TIMEOUT;
+  }
+
+  uint8_t crc[2];
+  mock::crcA(sendData, sendLen - 2, crc);
+  if ((sendLen != 5) || (sendData[0] != 0x3A) || memcmp(crc, sendData + 3, 2))
+  {
+    return STATUS_TIMEOUT;   // not understood, the tag stays silent
+  }
+
+  ++chip->Ops.FastReads;
+  size_t first = sendData[1];
+  size_t last  = sendData[2];
+  if (tag->classic() || !tag->FastRead || (first > last) || (4 * (last + 1) > tag->Memory.size()))
+  {
+    chip->air(1);
+    chip->drop(*tag);
+    return STATUS_MIFARE_NACK;
+  }
+
+  size_t length = 4 * (last - first + 1);
+  if (length + 2 > *backLen)
+  {
+    return STATUS_NO_ROOM;
+  }
+  chip->air(length + 2);
+  memcpy(backData, tag->Memory.data() + 4 * first, length);
+  mock::crcA(backData, length, backData + length);
+  *backLen = static_cast<byte>(length + 2);
+  return STATUS_OK;
+}
+
+inline MFRC522::StatusCode MFRC522::PCD_Authenticate(byte, byte blockAddr, MIFARE_Key* key, Uid* uid)
+{
+  auto chip = mock::Chip::Chips[Ss];
+  auto tag  = chip ? chip->active() : nullptr;
+  if (!tag || !tag->is(*uid) || !tag->classic())
+  {
+    return STATUS_TIMEOUT;
+  }
+
+  ++chip->Ops.Auths;
+  chip->air(5);   // three pass authentication
+  size_t sector = blockAddr / 4;
+  if ((sector >= tag->KeysA.size()) || memcmp(tag->KeysA[sector].data(), key->keyByte, MF_KEY_SIZE))
+  {
+    ++chip->Ops.AuthFailures;
+    chip->drop(*tag);
+    return STATUS_TIMEOUT;
+  }
+  tag->AuthSector = static_cast<int>(sector);
+  return STATUS_OK;
+}
+
+inline void MFRC522::PCD_StopCrypto1()
+{
+  auto chip = mock::Chip::Chips[Ss];
+  auto tag  = chip ? chip->active() : nullptr;
+  if (tag)
+  {
+    tag->AuthSector = -1;
+  }
+}
+
+inline MFRC522::StatusCode MFRC522::PICC_RequestA(byte* bufferATQA, byte* bufferSize)
+{
+  auto chip = mock::Chip::Chips[Ss];
+  if (!chip || (*bufferSize < 2) || !chip->request(false))
+  {
+    return STATUS_TIMEOUT;
+  }
+  bufferATQA[0] = 0x44;
+  bufferATQA[1] = 0x00;
+  *bufferSize   = 2;
+  return STATUS_OK;
+}
+
+inline MFRC522::StatusCode MFRC522::PICC_WakeupA(byte* bufferATQA, byte* bufferSize)
+{
+  auto chip = mock::Chip::Chips[Ss];
+  if (!chip || (*bufferSize < 2) || !chip->request(true))
+  {
+    return STATUS_TIMEOUT;
+  }
+  bufferATQA[0] = 0x44;
+  bufferATQA[1] = 0x00;
+  *bufferSize   = 2;
+  return STATUS_OK;
+}
+
+inline MFRC522::StatusCode MFRC522::PICC_Select(Uid* uid, byte validBits)
+{
+  auto chip = mock::Chip::Chips[Ss];
+  if (!chip || (validBits != 8 * uid->size))
+  {
+    return STATUS_TIMEOUT;
+  }
+  auto tag = chip->select(*uid);
+  if (!tag)
+  {
+    return STATUS_TIMEOUT;
+  }
+  uid->sak = tag->Uid.sak;
+  return STATUS_OK;
+}
+
+// no answer within 1 ms means success, so this never fails
+inline MFRC522::StatusCode MFRC522::PICC_HaltA()
+{
+  auto chip = mock::Chip::Chips[Ss];
+  auto tag  = chip ? chip->active() : nullptr;
+  if (tag)
+  {
+    ++chip->Ops.Halts;
+    chip->air();   // success is the absence of an answer
+    tag->Now        = mock::Tag::State::Halted;
+    tag->AuthSector = -1;
+  }
+  return STATUS_OK;
+}
+
+// 16 bytes and their CRC_A: one Classic block (sector authenticated), or 4 Ultralight pages
+inline MFRC522::StatusCode MFRC522::MIFARE_Read(byte blockAddr, byte* buffer, byte* bufferSize)
+{
+  if (!buffer || (*bufferSize < 18))
+  {
+    return STATUS_NO_ROOM;
+  }
+  auto chip = mock::Chip::Chips[Ss];
+  auto tag  = chip ? chip->active() : nullptr;
+  if (!tag)
+  {
+    return STATUS_TIMEOUT;
+  }
+
+  ++chip->Ops.Reads;
+  size_t unit = tag->classic() ? 16 : 4;
+  if ((tag->classic() && (tag->AuthSector != blockAddr / 4)) || (unit * blockAddr + 16 > tag->Memory.size()))
+  {
+    chip->air(1);
+    chip->drop(*tag);
+    return STATUS_MIFARE_NACK;
+  }
+  chip->air(18);
+  memcpy(buffer, tag->Memory.data() + unit * blockAddr, 16);
+  mock::crcA(buffer, 16, buffer + 16);
+  *bufferSize = 18;
+  return STATUS_OK;
+}
+
+inline bool MFRC522::PICC_ReadCardSerial()
+{
+  auto chip = mock::Chip::Chips[Ss];
+  auto tag  = chip ? chip->anticollision() : nullptr;
+  if (!tag)
+  {
+    return false;
+  }
+  uid = tag->Uid;
+  return true;
+}
+
+#endif // MOCK_MFRC522_H
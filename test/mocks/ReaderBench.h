@@ -0,0 +1,75 @@
+#ifndef MOCK_READER_BENCH_H
+#define MOCK_READER_BENCH_H
+
+// Services an rfid::Reader or rfid::ReaderSet like the reader task does, in real time: one round, then sleep on the wakeup until the readers
+// are due again. Events and inventories are collected.
+// A suite derives its bench from ReaderBench<Bench>, declares its simulated chips (mock::Chip) before the readers and hands them out with
+// readers(); serviced() is called after every round, e.g. to log state changes, and due() may add what else the loop has to wake up for.
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include <algorithm>
+#include <vector>
+
+#include "Rfid/Reader.hpp"
+
+namespace mock {
+
+inline uint64_t now_us()
+{
+  return common::delta::MonotonicSource<1>::micros64();
+}
+
+//==============================================================================================================================================================
+template <typename TBench>
+struct ReaderBench
+{
+  dps::rtos::Wakeup                  Waker;
+  std::vector<dps::rfid::TagEvent>   Events;
+  std::vector<uint64_t>              Reported_us;     // when each event was delivered
+  std::vector<dps::rfid::Inventory>  Inventories;
+  uint64_t                           MaxService_us = 0;
+
+  // services every reader once
+  void round()
+  {
+    auto& bench = static_cast<TBench&>(*this);
+    bench.readers()([this](dps::rfid::TagEvent const& event) { Events.push_back(event); Reported_us.push_back(now_us()); },
+                    [this](dps::rfid::Inventory const& inventory) { Inventories.push_back(inventory); });
+    bench.serviced();
+  }
+
+  void run(uint32_t ms)
+  {
+    uint64_t end = now_us() + 1000ull * ms;
+    for (uint64_t t = now_us(); t < end; t = now_us())
+    {
+      round();
+      MaxService_us = std::max(MaxService_us, now_us() - t);
+
+      uint32_t left = static_cast<uint32_t>((end - t + 999) / 1000);
+      Waker.wait(std::min(static_cast<TBench&>(*this).due(), left));
+    }
+  }
+
+  // the indices of the arrivals reported so far
+  std::vector<size_t> arrivals() const
+  {
+    std::vector<size_t> found;
+    for (size_t i = 0; i < Events.size(); ++i)
+    {
+      if (Events[i].Kind == dps::rfid::Presence::Arrived)
+      {
+        found.push_back(i);
+      }
+    }
+    return found;
+  }
+
+  void     serviced() {}
+  uint32_t due()      { return static_cast<TBench&>(*this).readers().due(); }
+};
+
+} // namespace mock
+
+#endif // MOCK_READER_BENCH_H
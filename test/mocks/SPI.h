@@ -0,0 +1,125 @@
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+// Host stand-in for the Arduino SPI library: bytes go to the simulated device whose chip select pin is low.
+
+#include <Arduino.h>
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+struct SPISettings
+{
+  SPISettings(uint32_t clock = 1000000, uint8_t = MSBFIRST, uint8_t = SPI_MODE0) : Clock(clock) {}
+
+  uint32_t Clock;
+};
+
+namespace mock {
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+
+//==============================================================================================================================================================
+// a device on the bus, registered by its chip select pin
+class SpiDevice
+{
+public:
+  virtual ~SpiDevice() = default;
+
+  // start: first byte after the chip select went low
+  virtual uint8_t transfer(uint8_t mosi, bool start, uint32_t clock) = 0;
+};
+
+inline SpiDevice* SpiDevices[PinCount] = {};
+
+// ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+} // namespace mock
+
+
+//==============================================================================================================================================================
+class SPIClass
+{
+public:
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t = -1)
+  {
+    Sck  = sck;
+    Miso = miso;
+    Mosi = mosi;
+  }
+  void end() {}
+
+  void beginTransaction(SPISettings settings)
+  {
+    Conflicts += InTransaction;
+    InTransaction = true;
+    Clock         = settings.Clock;
+    ++Transactions;
+  }
+
+  void endTransaction()
+  {
+    InTransaction = false;
+  }
+
+  uint8_t transfer(uint8_t data)
+  {
+    ++Bytes;
+    Conflicts += !InTransaction;
+
+    mock::SpiDevice* device = nullptr;
+    int              frame  = 0;
+    for (uint8_t pin = 0; pin < mock::PinCount; ++pin)
+    {
+      if (mock::SpiDevices[pin] && (mock::Pins[pin].Level == LOW))
+      {
+        Conflicts += (device != nullptr);   // two chip selects active at once
+        device     = mock::SpiDevices[pin];
+        frame      = mock::Pins[pin].Writes;
+      }
+    }
+    if (!device)
+    {
+      return 0xFF;   // nobody drives MISO
+    }
+
+    bool start = (device != Last) || (frame != Frame);
+    Last    = device;
+    Frame   = frame;
+    Frames += start;
+    return device->transfer(data, start, Clock);
+  }
+
+  void transferBytes(uint8_t const* tx, uint8_t* rx, uint32_t size)
+  {
+    for (uint32_t i = 0; i < size; ++i)
+    {
+      uint8_t in = transfer(tx ? tx[i] : 0xFF);
+      if (rx)
+      {
+        rx[i] = in;
+      }
+    }
+  }
+
+  // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
+  // test side
+  void reset()
+  {
+    *this = SPIClass();
+  }
+
+  int8_t   Sck = -1, Miso = -1, Mosi = -1;
+  uint32_t Clock         = 0;
+  bool     InTransaction = false;
+  uint32_t Transactions  = 0;
+  uint32_t Frames        = 0;   // chip select frames that clocked at least one byte
+  uint32_t Bytes         = 0;
+  uint32_t Conflicts     = 0;   // nested transactions, transfers outside one, several devices selected
+
+private:
+  mock::SpiDevice* Last  = nullptr;
+  int              Frame = 0;
+};
+
+inline SPIClass SPI;
+
+#endif // MOCK_SPI_H
@@ -0,0 +1,14 @@
+#ifndef MOCK_ESP_TASK_WDT_H
+#define MOCK_ESP_TASK_WDT_H
+
+// Host stand-in for the ESP-IDF task watchdog: nothing to feed.
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return 0; }
+inline esp_err_t esp_task_wdt_add(void*)           { return 0; }
+inline esp_err_t esp_task_wdt_reset()              { return 0; }
+
+#endif // MOCK_ESP_TASK_WDT_H
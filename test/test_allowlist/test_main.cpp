@@ -0,0 +1,228 @@
+#include <unity.h>
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "Delta/TimeSource.hpp"
+#include "Access/KeySet.hpp"
+#include "Access/Allowlist.hpp"
+
+using namespace dps::access;
+
+using TUid = std::vector<uint8_t>;
+
+static Allowlist<10240, 2048> List;
+static std::mt19937           Rng;
+
+static TUid randomUid(size_t size)
+{
+  TUid uid(size);
+  for (auto& b : uid)
+  {
+    b = static_cast<uint8_t>(Rng());
+  }
+  return uid;
+}
+
+
+void setUp()
+{
+  List.clear();
+  Rng.seed(14);
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// the branch-free search agrees with std::binary_search for every size and for probes below, between, on and above the keys
+void test_search_matches_binary_search()
+{
+  for (size_t size = 0; size < 130; ++size)
+  {
+    std::set<uint32_t> unique;
+    while (unique.size() < size)
+    {
+      unique.insert(2 * (Rng() % 1000) + 1);   // odd keys, so even probes fall between them
+    }
+    std::vector<uint32_t> keys(unique.begin(), unique.end());
+
+    for (uint32_t probe = 0; probe <= 2002; ++probe)
+    {
+      TEST_ASSERT_EQUAL(std::binary_search(keys.begin(), keys.end(), probe), KeySet::search(keys.data(), keys.size(), probe));
+    }
+  }
+}
+
+
+//==============================================================================================================================================================
+// 10000 UIDs of all three sizes are found, random UIDs only if the reference set has them
+void test_large_list()
+{
+  std::set<TUid> reference;
+  for (int i = 0; i < 10000; ++i)
+  {
+    TUid uid = randomUid((i % 10) ? 4 : ((i % 20) ? 10 : 7));
+    TEST_ASSERT_TRUE(List.add(uid.data(), uid.size()));
+    reference.insert(uid);
+  }
+  TEST_ASSERT_FALSE(List.contains(reference.begin()->data(), reference.begin()->size()));   // not before commit()
+
+  List.commit();
+  TEST_ASSERT_EQUAL_size_t(reference.size(), List.size());
+  TEST_ASSERT_EQUAL_size_t(0, List.pending());
+
+  for (auto const& uid : reference)
+  {
+    TEST_ASSERT_TRUE(List.contains(uid.data(), uid.size()));
+  }
+  for (int i = 0; i < 100000; ++i)
+  {
+    TUid uid = randomUid(4 + 3 * (i % 3));
+    TEST_ASSERT_EQUAL(reference.count(uid) != 0, List.contains(uid.data(), uid.size()));
+  }
+}
+
+
+//==============================================================================================================================================================
+void test_staging_duplicates_and_limits()
+{
+  uint8_t const a[]  = { 0x04, 0x11, 0x22, 0x33 };
+  uint8_t const b[]  = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+  uint8_t const c[]  = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+  uint8_t const c2[] = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x98 };
+
+  TEST_ASSERT_TRUE(List.add(a, sizeof(a)));
+  TEST_ASSERT_TRUE(List.add(a, sizeof(a)));
+  TEST_ASSERT_TRUE(List.add(b, sizeof(b)));
+  TEST_ASSERT_FALSE(List.add(a, 5));
+  TEST_ASSERT_FALSE(List.add(a, 0));
+  TEST_ASSERT_EQUAL_size_t(3, List.pending());
+  List.commit();
+
+  TEST_ASSERT_EQUAL_size_t(1, List.shortSize());
+  TEST_ASSERT_EQUAL_size_t(1, List.longSize());
+  TEST_ASSERT_TRUE(List.contains(a, sizeof(a)));
+  TEST_ASSERT_TRUE(List.contains(b, sizeof(b)));
+  TEST_ASSERT_FALSE(List.contains(c, sizeof(c)));   // same 7 byte prefix, different size
+
+  // staged entries stay invisible until the next commit, committed ones stay visible meanwhile
+  TEST_ASSERT_TRUE(List.add(c, sizeof(c)));
+  TEST_ASSERT_FALSE(List.contains(c, sizeof(c)));
+  TEST_ASSERT_TRUE(List.contains(a, sizeof(a)));
+  List.commit();
+  TEST_ASSERT_TRUE(List.contains(c, sizeof(c)));
+  TEST_ASSERT_FALSE(List.contains(c2, sizeof(c2)));
+
+  Allowlist<2, 1> small;
+  uint8_t const d[] = { 1, 2, 3, 4 };
+  uint8_t const e[] = { 1, 2, 3, 5 };
+  TEST_ASSERT_TRUE(small.add(d, sizeof(d)));
+  TEST_ASSERT_TRUE(small.add(e, sizeof(e)));
+  TEST_ASSERT_FALSE(small.add(a, sizeof(a)));
+  TEST_ASSERT_TRUE(small.add(b, sizeof(b)));
+  TEST_ASSERT_FALSE(small.add(c, sizeof(c)));
+
+  List.clear();
+  TEST_ASSERT_TRUE(List.empty());
+  TEST_ASSERT_FALSE(List.contains(a, sizeof(a)));
+}
+
+
+//==============================================================================================================================================================
+// KeySet works as a plain view on sorted arrays held elsewhere, e.g. in memory mapped flash
+void test_key_set_view()
+{
+  uint8_t const  uid4[] = { 0xDE, 0xAD, 0xBE, 0xEF };
+  uint8_t const  uid7[] = { 0x04, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+  uint32_t const shortKeys[] = { 1, KeySet::shortKey(uid4), 0xFFFFFFFF };
+  uint64_t const longKeys[]  = { KeySet::longKey(uid7, sizeof(uid7)) };
+
+  KeySet set{shortKeys, 3, longKeys, 1};
+  TEST_ASSERT_EQUAL_size_t(4, set.size());
+  TEST_ASSERT_TRUE(set.contains(uid4, sizeof(uid4)));
+  TEST_ASSERT_TRUE(set.contains(uid7, sizeof(uid7)));
+  TEST_ASSERT_FALSE(set.contains(uid7, 4));
+
+  KeySet empty;
+  TEST_ASSERT_TRUE(empty.empty());
+  TEST_ASSERT_FALSE(empty.contains(uid4, sizeof(uid4)));
+  TEST_ASSERT_FALSE(empty.contains(uid7, sizeof(uid7)));
+}
+
+
+//==============================================================================================================================================================
+// lookup latency of the full list (10240 + 2048 UIDs), half of the probes known, against std::binary_search on the same keys and a
+// std::set of the UIDs; memory per entry
+void test_benchmark()
+{
+  enum : uint32_t { Lookups = 2000000, Probes = 4096 };
+
+  std::set<TUid>    reference;
+  std::vector<TUid> probes;
+  for (size_t i = 0; i < List.capacity(); ++i)
+  {
+    TUid uid = randomUid((i < 10240) ? 4 : 7);
+    List.add(uid.data(), uid.size());
+    reference.insert(uid);
+    if (i % (List.capacity() / (Probes / 2)) == 0)
+    {
+      probes.push_back(uid);
+      probes.push_back(randomUid(uid.size()));
+    }
+  }
+  List.commit();
+  TEST_ASSERT_EQUAL_size_t(reference.size(), List.size());
+
+  KeySet const keys = List.keys();
+  auto time = [&](auto&& contains)
+  {
+    uint32_t hits  = 0;
+    uint64_t start = common::delta::MonotonicSource<1>::micros64();
+    for (uint32_t i = 0; i < Lookups; ++i)
+    {
+      auto const& uid = probes[i % probes.size()];
+      hits += contains(uid);
+    }
+    uint64_t elapsed_us = common::delta::MonotonicSource<1>::micros64() - start;
+    return std::make_pair(elapsed_us * 1000.0 / Lookups, hits);
+  };
+
+  auto keySet = time([&](TUid const& uid) { return keys.contains(uid.data(), uid.size()); });
+  auto binary = time([&](TUid const& uid)
+  {
+    return KeySet::isShort(uid.size()) ? std::binary_search(keys.Short, keys.Short + keys.ShortSize, KeySet::shortKey(uid.data()))
+                                       : std::binary_search(keys.Long, keys.Long + keys.LongSize, KeySet::longKey(uid.data(), uid.size()));
+  });
+  auto tree   = time([&](TUid const& uid) { return reference.count(uid) != 0; });
+
+  TEST_ASSERT_EQUAL(keySet.second, binary.second);
+  TEST_ASSERT_EQUAL(keySet.second, tree.second);
+  TEST_ASSERT_TRUE(keySet.second >= Lookups / 2);
+  TEST_ASSERT_TRUE(keySet.first < tree.first);
+
+  char line[160];
+  snprintf(line, sizeof(line), "%u UIDs: KeySet %.1f ns, std::binary_search %.1f ns, std::set %.1f ns per lookup",
+           static_cast<unsigned>(List.size()), keySet.first, binary.first, tree.first);
+  TEST_MESSAGE(line);
+  snprintf(line, sizeof(line), "memory: %u bytes for %u entries, 4 bytes per 4 byte UID, 8 bytes per 7/10 byte UID",
+           static_cast<unsigned>(List.bytes()), static_cast<unsigned>(List.capacity()));
+  TEST_MESSAGE(line);
+}
+
+
+//==============================================================================================================================================================
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_search_matches_binary_search);
+  RUN_TEST(test_large_list);
+  RUN_TEST(test_staging_duplicates_and_limits);
+  RUN_TEST(test_key_set_view);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
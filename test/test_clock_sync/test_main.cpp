@@ -0,0 +1,99 @@
+#include <unity.h>
+
+#include "Protocol/ClockSync.hpp"
+
+using namespace dps;
+using protocol::ClockSync;
+
+// an exchange with a symmetric link: 'rtt' on the wire, 100 us on the device; host = device + offset
+static bool exchange(ClockSync& clock, uint64_t device, int64_t offset, uint32_t rtt)
+{
+  uint64_t t1 = device;
+  uint64_t t2 = device + 100;
+  uint64_t t0 = t1 + offset - rtt / 2;
+  uint64_t t3 = t2 + offset + rtt / 2;
+  return clock.sample(t0, t1, t2, t3);
+}
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// a constant offset is tracked exactly, the skew stays 0
+void test_offset()
+{
+  ClockSync clock;
+  for (uint64_t t = 1000000; t < 20000000; t += 1000000)
+  {
+    TEST_ASSERT_TRUE(exchange(clock, t, 5000000, 800));
+  }
+  TEST_ASSERT_TRUE(clock.synced());
+  TEST_ASSERT_EQUAL(0, clock.skew());
+  TEST_ASSERT_EQUAL(25000050 + 5000000, clock.toHost(25000050));
+}
+
+//==============================================================================================================================================================
+// the host clock steps by hours (or the host restarts): no overflow in the skew estimate, the next sample restarts the estimate
+void test_host_clock_step()
+{
+  ClockSync clock;
+  for (uint64_t t = 1000000; t < 5000000; t += 1000000)
+  {
+    exchange(clock, t, 0, 800);
+  }
+
+  int64_t step = 10000 * 1000000000LL;   // 10^13 us: error * 10^9 exceeds int64
+  TEST_ASSERT_TRUE(exchange(clock, 6000000, step, 800));
+  TEST_ASSERT_EQUAL(1, clock.restarts());
+  TEST_ASSERT_EQUAL(0, clock.skew());
+  TEST_ASSERT_EQUAL(7000050 + step, clock.toHost(7000050));
+
+  TEST_ASSERT_TRUE(exchange(clock, 8000000, 0, 800));
+  TEST_ASSERT_EQUAL(2, clock.restarts());
+  TEST_ASSERT_EQUAL(9000050, clock.toHost(9000050));
+
+  // small errors are corrected by the loop, no restart
+  TEST_ASSERT_TRUE(exchange(clock, 10000000, 2000, 800));
+  TEST_ASSERT_EQUAL(2, clock.restarts());
+  TEST_ASSERT_TRUE(clock.skew() > 0);
+}
+
+//==============================================================================================================================================================
+// the best round trip ages with the elapsed device time, not per exchange: a burst of exchanges does not age it, after a quiet minute a
+// permanently slower link is accepted again
+void test_best_rtt_ages_with_time()
+{
+  ClockSync clock;
+  exchange(clock, 1000000, 0, 1000);
+  TEST_ASSERT_EQUAL(1000, clock.bestRtt());
+
+  // 100 rejected exchanges within 100 ms: 1 us each
+  for (uint64_t t = 1001000; t < 1101000; t += 1000)
+  {
+    TEST_ASSERT_FALSE(exchange(clock, t, 0, 1000000));
+  }
+  TEST_ASSERT_LESS_THAN(1200, clock.bestRtt());
+  TEST_ASSERT_FALSE(exchange(clock, 1102000, 0, 3000));
+
+  // a minute later: doubled (the age counts up to Aging_us), the slower link is used
+  TEST_ASSERT_FALSE(exchange(clock, 61102000, 0, 5000000));
+  TEST_ASSERT_TRUE(clock.bestRtt() >= 2000);
+  TEST_ASSERT_TRUE(exchange(clock, 61103000, 0, 3000));
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_offset);
+  RUN_TEST(test_host_clock_step);
+  RUN_TEST(test_best_rtt_ages_with_time);
+  return UNITY_END();
+}
@@ -0,0 +1,154 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Protocol/Cobs.hpp"
+#include "Protocol/Crc16.hpp"
+#include "Protocol/Frame.hpp"
+
+using namespace dps::protocol;
+
+// collects everything written to it
+class Capture : public Print
+{
+public:
+  size_t write(uint8_t c) override { Data.push_back(static_cast<char>(c)); return 1; }
+  using Print::write;
+
+  std::string Data;
+};
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+void test_crc16_check_value()
+{
+  uint8_t const check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, Crc16::compute(check, sizeof(check)));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, Crc16::compute(check, 0));
+  // incremental computation gives the same result
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, Crc16::compute(check + 4, 5, Crc16::compute(check, 4)));
+}
+
+
+//==============================================================================================================================================================
+void test_cobs_known_vectors()
+{
+  struct { std::vector<uint8_t> Raw, Encoded; } const vectors[] =
+  {
+    { { 0x00 },                   { 0x01, 0x01 } },
+    { { 0x00, 0x00 },             { 0x01, 0x01, 0x01 } },
+    { { 0x11, 0x22, 0x00, 0x33 }, { 0x03, 0x11, 0x22, 0x02, 0x33 } },
+    { { 0x11, 0x22, 0x33, 0x44 }, { 0x05, 0x11, 0x22, 0x33, 0x44 } },
+    { { 0x11, 0x00, 0x00, 0x00 }, { 0x02, 0x11, 0x01, 0x01, 0x01 } },
+  };
+
+  for (auto const& v : vectors)
+  {
+    uint8_t encoded[16], decoded[16];
+    size_t  length = cobs::encode(v.Raw.data(), v.Raw.size(), encoded);
+    TEST_ASSERT_EQUAL_size_t(v.Encoded.size(), length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(v.Encoded.data(), encoded, length);
+
+    TEST_ASSERT_EQUAL_size_t(v.Raw.size(), cobs::decode(encoded, length, decoded));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(v.Raw.data(), decoded, v.Raw.size());
+  }
+}
+
+
+//==============================================================================================================================================================
+// random packets of 1..700 bytes, zero heavy and zero free (254 byte runs), decoded in place
+void test_cobs_round_trip()
+{
+  std::mt19937 rng(7);
+
+  for (int run = 0; run < 20000; ++run)
+  {
+    size_t               length = 1 + rng() % 700;
+    std::vector<uint8_t> raw(length), encoded(cobs::maxEncoded(length));
+    for (auto& b : raw)
+    {
+      b = (run % 3 == 0) ? static_cast<uint8_t>(1 + rng() % 255) : static_cast<uint8_t>((rng() % 4 == 0) ? 0 : rng());
+    }
+
+    size_t size = cobs::encode(raw.data(), length, encoded.data());
+    TEST_ASSERT_LESS_OR_EQUAL_size_t(cobs::maxEncoded(length), size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      TEST_ASSERT_NOT_EQUAL(0, encoded[i]);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(length, cobs::decode(encoded.data(), size, encoded.data()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(raw.data(), encoded.data(), length);
+  }
+}
+
+
+//==============================================================================================================================================================
+void test_cobs_rejects_malformed()
+{
+  uint8_t out[8];
+  uint8_t const zeroCode[]  = { 0x02, 0x11, 0x00, 0x22 };
+  uint8_t const truncated[] = { 0x05, 0x11, 0x22 };
+
+  TEST_ASSERT_EQUAL_size_t(0, cobs::decode(zeroCode, sizeof(zeroCode), out));
+  TEST_ASSERT_EQUAL_size_t(0, cobs::decode(truncated, sizeof(truncated), out));
+}
+
+
+//==============================================================================================================================================================
+// FrameWriter output unframes to the original payload; a flipped bit anywhere is caught
+void test_frame_round_trip_and_corruption()
+{
+  FrameWriter<300> writer;
+  std::mt19937     rng(9);
+
+  for (int run = 0; run < 2000; ++run)
+  {
+    size_t length = 1 + rng() % writer.capacity();
+    std::vector<uint8_t> payload(length);
+    for (auto& b : payload)
+    {
+      b = static_cast<uint8_t>(rng());
+    }
+    memcpy(writer.payload(), payload.data(), length);
+
+    Capture wire;
+    writer.send(length, wire);
+    TEST_ASSERT_EQUAL(Delimiter, wire.Data.back());
+    TEST_ASSERT_EQUAL(wire.Data.size() - 1, wire.Data.find('\0'));
+
+    std::vector<uint8_t> frame(wire.Data.begin(), wire.Data.end() - 1);
+    std::vector<uint8_t> corrupt = frame;
+
+    TEST_ASSERT_EQUAL_size_t(length, unframe(frame.data(), frame.size()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payload.data(), frame.data(), length);
+
+    corrupt[rng() % corrupt.size()] ^= static_cast<uint8_t>(1 << (rng() % 8));
+    TEST_ASSERT_EQUAL_size_t(0, unframe(corrupt.data(), corrupt.size()));
+  }
+}
+
+
+//==============================================================================================================================================================
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_cobs_known_vectors);
+  RUN_TEST(test_cobs_round_trip);
+  RUN_TEST(test_cobs_rejects_malformed);
+  RUN_TEST(test_frame_round_trip_and_corruption);
+  return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <unity.h>
+#include <atomic>
+#include <thread>
+
+#include "Stats/Histogram.hpp"
+
+using namespace dps;
+using stats::Histogram;
+
+// bucket counts add up to the count, min/max lie in the populated buckets
+static bool consistent(Histogram const& h)
+{
+  uint64_t sum = 0;
+  for (size_t b = 0; b < Histogram::Buckets; ++b)
+  {
+    sum += h.bucketCount(b);
+  }
+  if (sum != h.count())
+  {
+    return false;
+  }
+  return !h.count() || (h.bucketCount(Histogram::bucket(h.min())) && h.bucketCount(Histogram::bucket(h.max())) && (h.min() <= h.max()));
+}
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+void test_buckets_and_percentiles()
+{
+  Histogram h;
+  for (uint32_t v = 0; v < 1000; ++v)
+  {
+    h.record(v);
+  }
+  TEST_ASSERT_EQUAL(1000, h.count());
+  TEST_ASSERT_EQUAL(0, h.min());
+  TEST_ASSERT_EQUAL(999, h.max());
+  TEST_ASSERT_EQUAL(1, h.bucketCount(0));
+  TEST_ASSERT_EQUAL(488, h.bucketCount(10));   // 512..999
+  TEST_ASSERT_EQUAL(511, h.percentile(500));
+  TEST_ASSERT_EQUAL(999, h.percentile(990));
+  TEST_ASSERT_EQUAL(11, h.used());
+
+  Histogram copy = h;
+  TEST_ASSERT_EQUAL(1000, copy.count());
+  TEST_ASSERT_EQUAL(999, copy.max());
+
+  h.requestReset();
+  TEST_ASSERT_EQUAL(1000, h.count());   // carried out by the writer
+  h.record(7);
+  TEST_ASSERT_EQUAL(1, h.count());
+  TEST_ASSERT_EQUAL(7, h.min());
+  TEST_ASSERT_EQUAL(7, h.max());
+}
+
+//==============================================================================================================================================================
+// a writer thread records (and now and then resets) while a reader takes copies: every copy is a state the writer left behind
+void test_snapshots_are_consistent()
+{
+  Histogram         h;
+  std::atomic<bool> done{false};
+  uint32_t          snapshots = 0;
+  uint32_t          torn      = 0;
+
+  std::thread writer([&]
+  {
+    for (uint32_t i = 0; i < 2000000; ++i)
+    {
+      h.record((i * 2654435761u) >> (i % 32));
+      if (!(i % 100000))
+      {
+        h.requestReset();
+      }
+    }
+    done = true;
+  });
+
+  while (!done)
+  {
+    Histogram copy = h;
+    torn += !consistent(copy);
+    ++snapshots;
+  }
+  writer.join();
+
+  TEST_ASSERT_EQUAL(0, torn);
+  TEST_ASSERT_TRUE(snapshots > 0);
+  TEST_ASSERT_TRUE(consistent(h));
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_buckets_and_percentiles);
+  RUN_TEST(test_snapshots_are_consistent);
+  return UNITY_END();
+}
@@ -0,0 +1,295 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "Delta/TimeSource.hpp"
+#include "Input/InputScanner.hpp"
+
+using namespace dps;
+using input::VerticalDebouncer;
+
+// straightforward per-input debouncer the bit-parallel one has to match
+struct ScalarDebouncer
+{
+  bool State   = false;
+  int  Counter = 0;
+
+  bool operator()(bool sample)
+  {
+    Counter = (sample != State) ? Counter + 1 : 0;
+    if (Counter == VerticalDebouncer::Samples)
+    {
+      State   = sample;
+      Counter = 0;
+      return true;
+    }
+    return false;
+  }
+};
+
+// clean square wave with random periods, bounces of up to 'bounce' samples after each edge and isolated glitches of up to 'glitch' samples
+struct NoisyTrace
+{
+  NoisyTrace(uint32_t seed, int bounce, int glitch) : Rng(seed), Bounce(bounce), Glitch(glitch) {}
+
+  bool next()
+  {
+    if (Hold == 0)
+    {
+      Clean   = !Clean;
+      ++Edges;
+      Hold    = 20 + Rng() % 200;
+      Chatter = Rng() % (Bounce + 1);
+      Since   = 0;
+    }
+    --Hold;
+    ++Since;
+
+    bool sample = Clean;
+    if (Since <= Chatter)
+    {
+      sample = Rng() & 1;
+    }
+    else if (GlitchLeft > 0)
+    {
+      --GlitchLeft;
+      sample = !Clean;
+    }
+    else if (Glitch && (Since > Bounce + VerticalDebouncer::Samples) && (Hold > Glitch) && (Calm > Glitch) && (Rng() % 50 == 0))
+    {
+      GlitchLeft = Rng() % Glitch;
+      sample     = !Clean;
+    }
+    Calm = (sample == Clean) ? Calm + 1 : 0;
+    return sample;
+  }
+
+  std::mt19937 Rng;
+  int          Bounce, Glitch;
+  bool         Clean      = false;
+  int          Hold       = 50;
+  int          Chatter    = 0;
+  int          Since      = 0;
+  int          GlitchLeft = 0;
+  int          Calm       = 0;
+  int          Edges      = 0;
+};
+
+
+void setUp()
+{
+  mock::resetPins();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// 32 independent noisy inputs, compared bit by bit against the scalar model
+void test_matches_scalar_model()
+{
+  std::mt19937      rng(13);
+  VerticalDebouncer debouncer;
+  ScalarDebouncer   model[32];
+
+  for (int sample = 0; sample < 200000; ++sample)
+  {
+    uint32_t bits = rng() & rng();   // biased, so runs of equal samples occur
+    uint32_t expected = 0;
+    for (int i = 0; i < 32; ++i)
+    {
+      if (model[i](((bits >> i) & 1) != 0))
+      {
+        expected |= 1u << i;
+      }
+    }
+
+    TEST_ASSERT_EQUAL_HEX32(expected, debouncer(bits));
+    for (int i = 0; i < 32; ++i)
+    {
+      TEST_ASSERT_EQUAL(model[i].State, (debouncer.state() >> i) & 1);
+    }
+  }
+}
+
+
+//==============================================================================================================================================================
+// bounces and glitches shorter than the debounce time never produce an extra toggle, and every clean edge comes through at most
+// 'bounce' + Samples samples late
+void test_noisy_edges_toggle_once()
+{
+  enum { Inputs = 32, Bounce = 3, Glitch = 3 };
+
+  std::vector<NoisyTrace> traces;
+  for (int i = 0; i < Inputs; ++i)
+  {
+    traces.emplace_back(100 + i, Bounce, Glitch);
+  }
+
+  VerticalDebouncer debouncer;
+  int               toggles[Inputs] = {};
+  int               lag[Inputs]     = {};
+
+  for (int sample = 0; sample < 100000; ++sample)
+  {
+    uint32_t bits = 0;
+    for (int i = 0; i < Inputs; ++i)
+    {
+      bits |= static_cast<uint32_t>(traces[i].next()) << i;
+    }
+
+    uint32_t toggled = debouncer(bits);
+    for (int i = 0; i < Inputs; ++i)
+    {
+      toggles[i] += (toggled >> i) & 1;
+
+      bool clean = traces[i].Clean;
+      lag[i]     = (((debouncer.state() >> i) & 1) == clean) ? 0 : lag[i] + 1;
+      TEST_ASSERT_LESS_OR_EQUAL(Bounce + VerticalDebouncer::Samples, lag[i]);
+    }
+  }
+
+  for (int i = 0; i < Inputs; ++i)
+  {
+    // the trace starts low and the last edge may still be settling
+    TEST_ASSERT_INT_WITHIN(1, traces[i].Edges, toggles[i]);
+  }
+}
+
+
+//==============================================================================================================================================================
+void test_short_glitches_are_filtered()
+{
+  for (int length = 1; length < VerticalDebouncer::Samples; ++length)
+  {
+    VerticalDebouncer debouncer(0);
+    for (int i = 0; i < length; ++i)
+    {
+      TEST_ASSERT_EQUAL_HEX32(0, debouncer(0xFFFFFFFF));
+    }
+    TEST_ASSERT_TRUE(debouncer.settling());
+    TEST_ASSERT_EQUAL_HEX32(0, debouncer(0));
+    TEST_ASSERT_FALSE(debouncer.settling());
+  }
+
+  VerticalDebouncer debouncer(0);
+  for (int i = 1; i < VerticalDebouncer::Samples; ++i)
+  {
+    TEST_ASSERT_EQUAL_HEX32(0, debouncer(0x5));
+  }
+  TEST_ASSERT_EQUAL_HEX32(0x5, debouncer(0x5));
+  TEST_ASSERT_EQUAL_HEX32(0x5, debouncer.state());
+}
+
+
+//==============================================================================================================================================================
+// the scanner stays idle until an edge interrupt, then samples every Scan_ms until the input has settled
+void test_scanner_is_edge_driven()
+{
+  using TScanner = input::InputScanner<input::GpioInputs<25, 26, 27>>;
+  rtos::Wakeup wakeup;
+  TScanner     scanner(wakeup);
+  TScanner::Change change{};
+
+  TEST_ASSERT_EQUAL_HEX32(0x7, scanner.state());
+  TEST_ASSERT_EQUAL_UINT32(common::delta::Deadline::Never, scanner.due());
+
+  // a glitch wakes the scanner up, which goes back to sleep once it has seen the input unchanged
+  mock::setPin(26, LOW);
+  mock::setPin(26, HIGH);
+  TEST_ASSERT_TRUE(wakeup.wait(0));
+  TEST_ASSERT_LESS_OR_EQUAL(TScanner::Scan_ms, scanner.due());
+  delay(TScanner::Scan_ms + 1);
+  TEST_ASSERT_FALSE(scanner(change));
+  TEST_ASSERT_EQUAL_UINT32(common::delta::Deadline::Never, scanner.due());
+
+  // a real press is reported after Samples scans
+  mock::setPin(26, LOW);
+  auto start    = millis();
+  int  scans    = 0;
+  bool reported = false;
+  while (!reported && (millis() - start < 200))
+  {
+    delay(scanner.due());
+    reported = scanner(change);
+    ++scans;
+  }
+  TEST_ASSERT_TRUE(reported);
+  TEST_ASSERT_EQUAL_HEX32(0x2, change.Toggled);
+  TEST_ASSERT_EQUAL_HEX32(0x5, change.State);
+  TEST_ASSERT_GREATER_OR_EQUAL((VerticalDebouncer::Samples - 1) * TScanner::Scan_ms, millis() - start);
+  TEST_ASSERT_EQUAL_UINT32(common::delta::Deadline::Never, scanner.due());
+}
+
+
+//==============================================================================================================================================================
+// debounce cost per scan as the number of inputs grows: one vertical debouncer for all of them against a scalar debouncer per input
+void test_benchmark()
+{
+  enum : uint32_t { Scans = 200000, Samples = 4096 };
+
+  static uint32_t samples[Samples];
+  std::mt19937    rng(17);
+  for (auto& sample : samples)
+  {
+    sample = rng() & rng();
+  }
+
+  auto now = [] { return common::delta::MonotonicSource<1>::micros64(); };
+
+  for (int inputs : { 1, 3, 8, 16, 32 })
+  {
+    uint32_t        mask = (inputs == 32) ? 0xFFFFFFFF : ((1u << inputs) - 1);
+    uint32_t        vertical_toggles = 0, scalar_toggles = 0;
+    ScalarDebouncer model[32];
+
+    VerticalDebouncer debouncer;
+    uint64_t          start = now();
+    for (uint32_t i = 0; i < Scans; ++i)
+    {
+      vertical_toggles += __builtin_popcount(debouncer(samples[i % Samples] & mask));
+    }
+    uint64_t vertical_us = now() - start;
+
+    start = now();
+    for (uint32_t i = 0; i < Scans; ++i)
+    {
+      uint32_t bits = samples[i % Samples];
+      for (int k = 0; k < inputs; ++k)
+      {
+        scalar_toggles += model[k](((bits >> k) & 1) != 0);
+      }
+    }
+    uint64_t scalar_us = now() - start;
+
+    TEST_ASSERT_EQUAL(scalar_toggles, vertical_toggles);
+    if (inputs == 32)
+    {
+      TEST_ASSERT_LESS_THAN(scalar_us, vertical_us);
+    }
+
+    char line[128];
+    double vertical_ns = vertical_us * 1000.0 / Scans;
+    double scalar_ns   = scalar_us * 1000.0 / Scans;
+    snprintf(line, sizeof(line), "%2d inputs: vertical %5.1f ns/scan (%4.2f ns/input), scalar %6.1f ns/scan (%4.2f ns/input)", inputs,
+             vertical_ns, vertical_ns / inputs, scalar_ns, scalar_ns / inputs);
+    TEST_MESSAGE(line);
+  }
+}
+
+
+//==============================================================================================================================================================
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_scalar_model);
+  RUN_TEST(test_noisy_edges_toggle_once);
+  RUN_TEST(test_short_glitches_are_filtered);
+  RUN_TEST(test_scanner_is_edge_driven);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
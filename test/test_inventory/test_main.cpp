@@ -0,0 +1,188 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <ReaderBench.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Rfid/Reader.hpp"
+
+using namespace dps;
+using rfid::Inventory;
+using rfid::Presence;
+
+enum : uint8_t { Ss = 5, Rst = 22, Irq = 21 };
+
+enum : uint32_t
+{
+  Exchange_us = 200,   // simulated air time per RF exchange
+};
+
+// one reader on a simulated chip
+struct Bench : mock::ReaderBench<Bench>
+{
+  mock::Chip                 Chip{ Ss, Rst, Irq };
+  rfid::Reader<Ss, Rst, Irq> Reader{ Waker };
+
+  auto& readers() { return Reader; }
+
+  // n tags, Ultralight and Classic alternating
+  void fill(size_t n, uint8_t first = 1)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      uint8_t serial = static_cast<uint8_t>(first + i);
+      Chip.enter((i % 2) ? mock::Tag::classic(serial) : mock::Tag::ultralight(serial));
+    }
+  }
+};
+
+// how often each tag of the field is in the inventory
+static std::vector<int> occurrences(mock::Chip& chip, Inventory const& inventory)
+{
+  std::vector<int> found(chip.Field.size(), 0);
+  for (size_t i = 0; i < inventory.Count; ++i)
+  {
+    for (size_t t = 0; t < chip.Field.size(); ++t)
+    {
+      found[t] += chip.Field[t].is(inventory.Tags[i].Uid);
+    }
+  }
+  return found;
+}
+
+
+void setUp()
+{
+  mock::resetPins();
+  SPI.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// 1..8 tags: one pass reports every tag exactly once with WUPA + n * (anticollision, HLTA, REQA) exchanges, each tag with its own timing;
+// the next pass (WUPA wakes the halted tags) reports them all again
+void test_inventory_1_to_8_tags()
+{
+  for (size_t n = 1; n <= rfid::MaxTags; ++n)
+  {
+    Bench bench;
+    bench.fill(n);
+    bench.Chip.Exchange_us = Exchange_us;
+
+    for (int round = 0; round < 2; ++round)
+    {
+      bench.Chip.Ops = {};
+      Inventory inventory;
+      TEST_ASSERT_TRUE(bench.Reader.inventory(inventory));
+
+      TEST_ASSERT_EQUAL(n, inventory.Count);
+      TEST_ASSERT_TRUE(inventory.Complete);
+      for (int count : occurrences(bench.Chip, inventory))
+      {
+        TEST_ASSERT_EQUAL(1, count);
+      }
+      for (auto const& tag : bench.Chip.Field)
+      {
+        TEST_ASSERT_TRUE(tag.Now == mock::Tag::State::Halted);
+      }
+
+      TEST_ASSERT_EQUAL(1, bench.Chip.Ops.Wupa);
+      TEST_ASSERT_EQUAL(n, bench.Chip.Ops.Selects);
+      TEST_ASSERT_EQUAL(n, bench.Chip.Ops.Halts);
+      TEST_ASSERT_EQUAL(n, bench.Chip.Ops.Reqa);
+      TEST_ASSERT_EQUAL(0, bench.Chip.Ops.SelectFailures);
+
+      // per tag: its anticollision/select and its HLTA
+      uint64_t sum = 0;
+      for (size_t i = 0; i < inventory.Count; ++i)
+      {
+        TEST_ASSERT_GREATER_OR_EQUAL(2 * Exchange_us, inventory.Tags[i].Select_us);
+        TEST_ASSERT_LESS_THAN(2 * Exchange_us + 2000, inventory.Tags[i].Select_us);
+        sum += inventory.Tags[i].Select_us;
+      }
+      TEST_ASSERT_GREATER_OR_EQUAL((1 + 3 * n) * Exchange_us, inventory.Duration_us);
+      TEST_ASSERT_GREATER_OR_EQUAL(sum, inventory.Duration_us);
+
+      if (round == 0)
+      {
+        char line[128];
+        snprintf(line, sizeof(line), "%zu tags: %u us per pass, %llu us per tag selected, %u exchanges", n,
+                 static_cast<unsigned>(inventory.Duration_us), static_cast<unsigned long long>(sum / n), static_cast<unsigned>(1 + 3 * n));
+        TEST_MESSAGE(line);
+      }
+    }
+  }
+}
+
+//==============================================================================================================================================================
+// halted tags stay silent for the armed REQA, so only newcomers trigger an inventory; every tag arrives once however often it is checked
+void test_halted_tags_not_reported_again()
+{
+  Bench bench;
+  bench.fill(3);
+  bench.run(300);
+
+  TEST_ASSERT_EQUAL(3, bench.Events.size());
+  TEST_ASSERT_EQUAL(1, bench.Inventories.size());
+  TEST_ASSERT_EQUAL(3, bench.Inventories[0].Count);
+  TEST_ASSERT_EQUAL(1, bench.Reader.reads());
+
+  // newcomers are found by the re-arm IRQ or by the next presence check, whichever comes first
+  bench.fill(2, 10);
+  bench.run(300);
+  TEST_ASSERT_EQUAL(5, bench.Events.size());
+  TEST_ASSERT_EQUAL(2, bench.Inventories.size());
+  TEST_ASSERT_EQUAL(5, bench.Inventories[1].Count);
+  TEST_ASSERT_TRUE(bench.Reader.reads() <= 2);
+  TEST_ASSERT_EQUAL(0, bench.Reader.duplicates());
+
+  // presence checks wake and re-halt all of them, no further arrivals
+  uint32_t wupa = bench.Chip.Ops.Wupa;
+  bench.run(500);
+  TEST_ASSERT_TRUE(bench.Chip.Ops.Wupa > wupa);
+  TEST_ASSERT_EQUAL(5, bench.Events.size());
+  TEST_ASSERT_EQUAL(2, bench.Inventories.size());
+  TEST_ASSERT_EQUAL(5, bench.Reader.tracked());
+  for (auto const& event : bench.Events)
+  {
+    TEST_ASSERT_TRUE(event.Kind == Presence::Arrived);
+  }
+
+  // a REQA is answered by none of them
+  TEST_ASSERT_EQUAL(0, bench.Chip.request(false));
+}
+
+//==============================================================================================================================================================
+// more tags than an inventory holds: MaxTags are reported, the pass is flagged incomplete
+void test_overfull_field()
+{
+  Bench bench;
+  bench.fill(rfid::MaxTags + 1);
+
+  Inventory inventory;
+  TEST_ASSERT_TRUE(bench.Reader.inventory(inventory));
+  TEST_ASSERT_EQUAL(rfid::MaxTags, inventory.Count);
+  TEST_ASSERT_FALSE(inventory.Complete);
+
+  size_t reported = 0;
+  for (int count : occurrences(bench.Chip, inventory))
+  {
+    TEST_ASSERT_TRUE(count <= 1);
+    reported += count;
+  }
+  TEST_ASSERT_EQUAL(rfid::MaxTags, reported);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_inventory_1_to_8_tags);
+  RUN_TEST(test_halted_tags_not_reported_again);
+  RUN_TEST(test_overfull_field);
+  return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "LedRing/LedRing.hpp"
+
+using namespace dps;
+using led::LedRing;
+
+enum : uint8_t  { LedPin = 23 };
+enum : uint32_t { Switches = 2000000 };
+
+// every heap allocation of the program goes through here: counted, and the live ones tracked
+static size_t Allocations = 0;
+static long   Live        = 0;
+
+void* operator new(size_t size)
+{
+  ++Allocations;
+  ++Live;
+  if (void* p = malloc(size ? size : 1))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)               { return operator new(size); }
+void  operator delete(void* p) noexcept         { if (p) { --Live; free(p); } }
+void  operator delete[](void* p) noexcept       { operator delete(p); }
+void  operator delete(void* p, size_t) noexcept { operator delete(p); }
+void  operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+
+void setUp()
+{
+  mock::resetPins();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// millions of effect switches through every entry point (name, effect, queued command), each rendered: not a single allocation, nothing
+// left behind
+void test_switching_does_not_allocate()
+{
+  LedRing ring(LedPin);
+
+  static char const* const Names[] = { "activate", "pass", "deactivate", "fail" };
+  LedRing::Command const   command = { LedRing::Command::Kinds::Effect, static_cast<uint32_t>(LedRing::Effect::Fail), LedRing::Layer::Idle };
+
+  size_t   allocations = Allocations;
+  long     live        = Live;
+  uint32_t shows       = ring.Shows;
+
+  for (uint32_t i = 0; i < Switches; ++i)
+  {
+    switch (i % 3)
+    {
+    case 0:  TEST_ASSERT_TRUE(ring = std::string_view(Names[(i / 3) % 4]));                 break;
+    case 1:  TEST_ASSERT_TRUE(ring = static_cast<LedRing::Effect>((i / 3) % 4));            break;
+    default: TEST_ASSERT_TRUE(ring = command);                                              break;
+    }
+    ring();
+  }
+
+  TEST_ASSERT_EQUAL(allocations, Allocations);
+  TEST_ASSERT_EQUAL(live, Live);
+  TEST_ASSERT_EQUAL(Switches, ring.Shows - shows);
+
+  char line[96];
+  snprintf(line, sizeof(line), "%u switches: %u allocations, %ld live", static_cast<unsigned>(Switches),
+           static_cast<unsigned>(Allocations - allocations), Live - live);
+  TEST_MESSAGE(line);
+}
+
+//==============================================================================================================================================================
+// effects that run to their end are destroyed in place: the ring goes idle, the kept presence frame stays, the status flash is gone
+void test_finished_effects_are_released()
+{
+  LedRing ring(LedPin);
+  long    live = Live;
+
+  ring = LedRing::Effect::Activate;
+  ring = LedRing::Effect::Fail;
+
+  uint32_t start = millis();
+  while (!ring() && (millis() - start < 3000))
+  {
+    delay(ring.due());
+  }
+  TEST_ASSERT_TRUE(ring());
+  TEST_ASSERT_EQUAL(live, Live);
+
+  // white from Activate, no red left over from Fail
+  uint32_t pixel = ring.shown(0);
+  TEST_ASSERT_NOT_EQUAL(0, pixel);
+  TEST_ASSERT_EQUAL(pixel & 0xFF, pixel >> 16);
+}
+
+//==============================================================================================================================================================
+// composite cost per frame as layers and pixels grow: clear, then every layer blended in (replace, add and alpha in turn, partly covered)
+void test_compositor_benchmark()
+{
+  enum : uint32_t { Pixels = 4000000 };   // blended pixels per measurement
+
+  std::mt19937 rng(25);
+  for (uint16_t pixels : { 12, 60, 144, 300 })
+  {
+    std::vector<led::Pixel> composite(pixels);
+    std::vector<led::Pixel> layers[8];
+    for (auto& layer : layers)
+    {
+      layer.resize(pixels);
+      for (auto& pixel : layer)
+      {
+        pixel = (rng() % 2) ? led::Pixel{ static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), 0xFF }
+                            : led::Pixel{ 0, 0, 0, 0 };
+      }
+    }
+
+    char line[160];
+    int  length = snprintf(line, sizeof(line), "%3u pixels, ns per frame with 1/2/4/8 layers:", static_cast<unsigned>(pixels));
+    for (size_t count : { 1, 2, 4, 8 })
+    {
+      led::Framebuffer target(composite.data(), pixels);
+      uint32_t         frames = Pixels / (pixels * count) + 1;
+      uint32_t         check  = 0;
+
+      uint64_t start = common::delta::MonotonicSource<1>::micros64();
+      for (uint32_t f = 0; f < frames; ++f)
+      {
+        target.fill({ 0, 0, 0, 0xFF });
+        for (size_t l = 0; l < count; ++l)
+        {
+          led::Framebuffer layer(layers[l].data(), pixels);
+          target.blend(layer, static_cast<led::Blend>(l % 3), 200);
+        }
+        check += target[f % pixels].R;
+      }
+      double frame_ns = (common::delta::MonotonicSource<1>::micros64() - start) * 1000.0 / frames;
+
+      TEST_ASSERT_TRUE(check <= 0xFF * frames);
+      length += snprintf(line + length, sizeof(line) - length, " %6.0f", frame_ns);
+    }
+    TEST_MESSAGE(line);
+  }
+
+  // an opaque Replace layer on top covers everything beneath
+  led::FramebufferN<12> bottom, top, target;
+  bottom.fill({ 10, 20, 30, 0xFF });
+  top.fill({ 1, 2, 3, 0xFF });
+  target.blend(bottom, led::Blend::Replace, 0xFF);
+  target.blend(top, led::Blend::Replace, 0xFF);
+  TEST_ASSERT_EQUAL(1, target[5].R);
+  TEST_ASSERT_EQUAL(3, target[11].B);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_switching_does_not_allocate);
+  RUN_TEST(test_finished_effects_are_released);
+  RUN_TEST(test_compositor_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,238 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Delta/TimeSource.hpp"
+#include "Protocol/LineReader.hpp"
+
+using namespace dps::protocol;
+
+// collects everything written to it
+class Capture : public Print
+{
+public:
+  size_t write(uint8_t c) override { Data.push_back(static_cast<char>(c)); return 1; }
+  using Print::write;
+
+  std::string Data;
+};
+
+static HardwareSerial Port;
+
+// heap allocations of the whole program
+static size_t Allocations = 0;
+
+void* operator new(size_t size)
+{
+  ++Allocations;
+  if (void* p = malloc(size ? size : 1))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)                 { return operator new(size); }
+void  operator delete(void* p) noexcept           { free(p); }
+void  operator delete[](void* p) noexcept         { free(p); }
+void  operator delete(void* p, size_t) noexcept   { free(p); }
+void  operator delete[](void* p, size_t) noexcept { free(p); }
+
+// the former handleUsart: byte by byte, each byte echoed on its own, the line collected in a std::string
+static void legacyPoll(Stream& stream, Print& echo, std::string& line, uint32_t& lines)
+{
+  while (stream.available())
+  {
+    auto c = stream.read();
+    echo.write(static_cast<uint8_t>(c));
+    if (c != '\n')
+    {
+      line += static_cast<char>(c);
+    }
+    else
+    {
+      ++lines;
+      line.clear();
+    }
+  }
+}
+
+
+void setUp()
+{
+  Port.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+void test_lines_and_echo()
+{
+  LineReader<32>           reader;
+  Capture                  echo;
+  std::vector<std::string> lines;
+
+  Port.inject("one\r\ntw");
+  reader.poll(Port, echo, [&](char* line, size_t length) { lines.emplace_back(line, length); }, [] {});
+  Port.inject("o\n");
+  reader.poll(Port, echo, [&](char* line, size_t length) { lines.emplace_back(line, length); }, [] {});
+
+  TEST_ASSERT_EQUAL(2, lines.size());
+  TEST_ASSERT_EQUAL_STRING("one", lines[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("two", lines[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("one\r\ntwo\n", echo.Data.c_str());
+  TEST_ASSERT_EQUAL(2, reader.lines());
+}
+
+//==============================================================================================================================================================
+// a mode command followed by frames in the same read: the handler switches to 0x00 and the echo off, the frames behind it are still
+// handed out, split by the new delimiter and not echoed
+void test_switch_keeps_pipelined_input()
+{
+  LineReader<64>           reader;
+  Capture                  echo;
+  std::vector<std::string> lines;
+
+  auto onLine = [&](char* line, size_t length)
+  {
+    lines.emplace_back(line, length);
+    if (lines.back() == "binary")
+    {
+      reader.setEcho(false);
+      reader.setDelimiter('\0');
+    }
+  };
+
+  char const input[] = "binary\n\x03" "ab\0\x02" "c\0\x02";   // a partial third frame
+  Port.inject(input, sizeof(input) - 1);
+  reader.poll(Port, echo, onLine, [] {});
+
+  TEST_ASSERT_EQUAL(3, lines.size());
+  TEST_ASSERT_EQUAL_STRING("binary", lines[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("\x03" "ab", lines[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("\x02" "c", lines[2].c_str());
+  TEST_ASSERT_EQUAL_STRING("binary\n", echo.Data.c_str());
+
+  // the rest of the partial frame
+  Port.inject("d\0", 2);
+  reader.poll(Port, echo, onLine, [] {});
+  TEST_ASSERT_EQUAL(4, lines.size());
+  TEST_ASSERT_EQUAL_STRING("\x02" "d", lines[3].c_str());
+  TEST_ASSERT_EQUAL_STRING("binary\n", echo.Data.c_str());
+}
+
+//==============================================================================================================================================================
+// switched between two polls: the buffered tail is searched again for the new delimiter
+void test_switch_between_polls()
+{
+  LineReader<32>           reader;
+  Capture                  echo;
+  std::vector<std::string> lines;
+  auto onLine = [&](char* line, size_t length) { lines.emplace_back(line, length); };
+
+  Port.inject("ab\0cd", 5);
+  reader.poll(Port, echo, onLine, [] {});
+  TEST_ASSERT_EQUAL(0, lines.size());
+
+  reader.setDelimiter('\0');
+  Port.inject("\0", 1);
+  reader.poll(Port, echo, onLine, [] {});
+  TEST_ASSERT_EQUAL(2, lines.size());
+  TEST_ASSERT_EQUAL_STRING("ab", lines[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("cd", lines[1].c_str());
+}
+
+//==============================================================================================================================================================
+// an over-long line is reported once and dropped up to its end, the next one is intact
+void test_overflow()
+{
+  LineReader<8>            reader;
+  Capture                  echo;
+  std::vector<std::string> lines;
+  int                      overflows = 0;
+
+  Port.inject("0123456789abcdef\nok\n");
+  reader.poll(Port, echo, [&](char* line, size_t length) { lines.emplace_back(line, length); }, [&] { ++overflows; });
+
+  TEST_ASSERT_EQUAL(1, overflows);
+  TEST_ASSERT_EQUAL(1, reader.overflows());
+  TEST_ASSERT_EQUAL(1, lines.size());
+  TEST_ASSERT_EQUAL_STRING("ok", lines[0].c_str());
+}
+
+//==============================================================================================================================================================
+// throughput and allocations per message of the line discipline alone (the JSON parse is the same in both), against the former byte loop
+void test_benchmark()
+{
+  enum : uint32_t { Messages = 50000, Batch = 100 };
+
+  char message[64];
+  int  size = snprintf(message, sizeof(message), "{\"action\":\"set\",\"fx\":\"pass\",\"seq\":%u}\n", 12345u);
+  std::string batch;
+  for (uint32_t i = 0; i < Batch; ++i)
+  {
+    batch.append(message, size);
+  }
+  Port.RxSize = batch.size();
+
+  auto run = [&](auto&& poll)
+  {
+    uint64_t busy_us = 0;
+    for (uint32_t i = 0; i < Messages / Batch; ++i)
+    {
+      Port.inject(batch.data(), batch.size());
+      uint64_t start = common::delta::MonotonicSource<1>::micros64();
+      poll();
+      busy_us += common::delta::MonotonicSource<1>::micros64() - start;
+    }
+    return busy_us ? busy_us : 1;
+  };
+
+  Capture     echo;
+  std::string line;
+  uint32_t    legacy = 0;
+  echo.Data.reserve(batch.size() * (Messages / Batch));
+  size_t   before            = Allocations;
+  uint64_t legacy_us         = run([&] { legacyPoll(Port, echo, line, legacy); });
+  size_t   legacyAllocations = Allocations - before;
+
+  LineReader<512> reader;
+  uint32_t        lines = 0;
+  reader.setEcho(false);
+  before                     = Allocations;
+  uint64_t reader_us         = run([&] { reader.poll(Port, echo, [&](char*, size_t) { ++lines; }, [] {}); });
+  size_t   readerAllocations = Allocations - before;
+
+  TEST_ASSERT_EQUAL(Messages, legacy);
+  TEST_ASSERT_EQUAL(Messages, lines);
+  TEST_ASSERT_EQUAL(0, readerAllocations);
+  TEST_ASSERT_LESS_THAN(legacy_us, reader_us);
+
+  uint64_t bytes = static_cast<uint64_t>(size) * Messages;
+  char     text[128];
+  snprintf(text, sizeof(text), "byte loop:  %7u kB/s, %u allocations for %u messages", static_cast<unsigned>(bytes * 1000 / legacy_us),
+           static_cast<unsigned>(legacyAllocations), static_cast<unsigned>(Messages));
+  TEST_MESSAGE(text);
+  snprintf(text, sizeof(text), "LineReader: %7u kB/s, %u allocations for %u messages", static_cast<unsigned>(bytes * 1000 / reader_us),
+           static_cast<unsigned>(readerAllocations), static_cast<unsigned>(Messages));
+  TEST_MESSAGE(text);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_and_echo);
+  RUN_TEST(test_switch_keeps_pipelined_input);
+  RUN_TEST(test_switch_between_polls);
+  RUN_TEST(test_overflow);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,199 @@
+#include <unity.h>
+#include <stdio.h>
+#include <random>
+#include <string>
+
+#include "Delta/TimeSource.hpp"
+#include "Protocol/NameMap.hpp"
+
+using namespace dps::protocol;
+
+enum class Action { Set, Mode, Reboot, Stats, Trace, Ping, Sync, Rtt, Allow, Delta };
+
+static constexpr auto Actions = makeNameMap<Action>({
+  { "set",    Action::Set    },
+  { "mode",   Action::Mode   },
+  { "reboot", Action::Reboot },
+  { "stats",  Action::Stats  },
+  { "trace",  Action::Trace  },
+  { "ping",   Action::Ping   },
+  { "sync",   Action::Sync   },
+  { "rtt",    Action::Rtt    },
+  { "allow",  Action::Allow  },
+  { "delta",  Action::Delta  },
+});
+
+// lookups are constant expressions as well
+static_assert(*Actions.find("trace") == Action::Trace, "");
+static_assert(Actions.find("tracE") == nullptr, "");
+
+
+// N generated names "n000", "n001", ... of similar shape, the hard case for a weak hash
+template <size_t N>
+struct Generated
+{
+  constexpr Generated() : Text{}, Entries{}
+  {
+    for (size_t i = 0; i < N; ++i)
+    {
+      Text[i][0] = 'n';
+      Text[i][1] = static_cast<char>('0' + i / 100);
+      Text[i][2] = static_cast<char>('0' + i / 10 % 10);
+      Text[i][3] = static_cast<char>('0' + i % 10);
+      Entries[i] = { std::string_view(Text[i], 4), static_cast<int>(i) };
+    }
+  }
+
+  char           Text[N][4];
+  NameEntry<int> Entries[N];
+};
+
+enum { NrGenerated = 100 };
+
+static constexpr Generated<NrGenerated> Names;
+static constexpr auto Large = makeNameMap<int>(Names.Entries);
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+void test_every_name_is_found()
+{
+  Action action = Action::Set;
+  TEST_ASSERT_TRUE(Actions.find("delta", action));
+  TEST_ASSERT_EQUAL(static_cast<int>(Action::Delta), static_cast<int>(action));
+  TEST_ASSERT_TRUE(Actions.find("set", action));
+  TEST_ASSERT_EQUAL(static_cast<int>(Action::Set), static_cast<int>(action));
+
+  for (size_t i = 0; i < NrGenerated; ++i)
+  {
+    char name[8];
+    snprintf(name, sizeof(name), "n%03zu", i);
+    int value = -1;
+    TEST_ASSERT_TRUE(Large.find(name, value));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(i), value);
+  }
+}
+
+
+//==============================================================================================================================================================
+// near misses: empty, prefixes, extensions, case and out of range numbers
+void test_unknown_names_are_rejected()
+{
+  char const* const misses[] = { "", "s", "se", "sett", "Set", "SET", "ping ", " ping", "allowed", "deltas", "stat" };
+  for (auto name : misses)
+  {
+    TEST_ASSERT_NULL(Actions.find(name));
+  }
+
+  Action unchanged = Action::Rtt;
+  TEST_ASSERT_FALSE(Actions.find("unknown", unchanged));
+  TEST_ASSERT_EQUAL(static_cast<int>(Action::Rtt), static_cast<int>(unchanged));
+
+  TEST_ASSERT_NULL(Large.find("n100"));
+  TEST_ASSERT_NULL(Large.find("n99"));
+  TEST_ASSERT_NULL(Large.find("n0000"));
+  TEST_ASSERT_NULL(Large.find(std::string_view("n000", 3)));
+}
+
+
+//==============================================================================================================================================================
+// random strings only ever hit on an exact match
+void test_random_strings()
+{
+  std::mt19937 rng(9);
+  int          hits = 0;
+
+  for (int run = 0; run < 200000; ++run)
+  {
+    std::string name(rng() % 6, ' ');
+    for (auto& c : name)
+    {
+      c = "n0123456789aelst"[rng() % 16];
+    }
+
+    auto found = Large.find(name);
+    if (found)
+    {
+      char expected[8];
+      snprintf(expected, sizeof(expected), "n%03d", *found);
+      TEST_ASSERT_EQUAL_STRING(expected, name.c_str());
+      ++hits;
+    }
+    TEST_ASSERT_TRUE((Actions.find(name) == nullptr) || (name == "set") || (name == "sync") || (name == "stats"));
+  }
+  TEST_ASSERT_GREATER_THAN(0, hits);
+}
+
+
+//==============================================================================================================================================================
+// lookup cost against the former dispatch: the name copied into a std::string and compared entry by entry, as the if/else chain did
+// (written as a loop over the same 100 names, which is what the chain amounts to)
+static int chain(char const* text)
+{
+  std::string name = text;
+  for (size_t i = 0; i < NrGenerated; ++i)
+  {
+    if (name == Names.Entries[i].Name)
+    {
+      return Names.Entries[i].Value;
+    }
+  }
+  return -1;
+}
+
+void test_benchmark()
+{
+  enum : uint32_t { Lookups = 2000000, Keys = 1024 };
+
+  // every name about equally often, one in ten unknown
+  static char  keys[Keys][8];
+  std::mt19937 rng(11);
+  for (auto& key : keys)
+  {
+    uint32_t n = rng() % (NrGenerated + NrGenerated / 10);
+    snprintf(key, sizeof(key), (n < NrGenerated) ? "n%03u" : "x%03u", static_cast<unsigned>(n));
+  }
+
+  auto time = [&](auto&& lookup)
+  {
+    int64_t  sum   = 0;
+    uint64_t start = common::delta::MonotonicSource<1>::micros64();
+    for (uint32_t i = 0; i < Lookups; ++i)
+    {
+      sum += lookup(keys[i % Keys]);
+    }
+    uint64_t elapsed_us = common::delta::MonotonicSource<1>::micros64() - start;
+    return std::make_pair(elapsed_us ? elapsed_us : 1, sum);
+  };
+
+  auto chained = time([](char const* key) { return chain(key); });
+  auto hashed  = time([](char const* key) { auto found = Large.find(key); return found ? *found : -1; });
+
+  TEST_ASSERT_EQUAL(chained.second, hashed.second);
+  TEST_ASSERT_LESS_THAN(chained.first, hashed.first);
+
+  char line[128];
+  snprintf(line, sizeof(line), "%u names: if/else chain %u ns, NameMap %u ns per lookup", static_cast<unsigned>(NrGenerated),
+           static_cast<unsigned>(chained.first * 1000 / Lookups), static_cast<unsigned>(hashed.first * 1000 / Lookups));
+  TEST_MESSAGE(line);
+}
+
+
+//==============================================================================================================================================================
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_every_name_is_found);
+  RUN_TEST(test_unknown_names_are_rejected);
+  RUN_TEST(test_random_strings);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
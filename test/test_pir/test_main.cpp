@@ -0,0 +1,199 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Input/Pir.hpp"
+
+using namespace dps;
+using input::Pir;
+
+enum : uint8_t { PirPin = 4 };
+
+enum : uint32_t
+{
+  Debounce_ms = 20,
+  Hold_ms     = 100,
+  Slack_ms    = 15,   // scheduling of the host threads
+  Tick_ms     = 1,    // a millisecond timer may expire up to one tick early
+};
+
+static uint64_t now_us()
+{
+  return common::delta::MonotonicSource<1>::micros64();
+}
+
+// the consuming task: sleeps until an edge or a pending decision, collects the events (and when they were handed out) for 'ms'
+struct Consumer
+{
+  Consumer() : Presence(PirPin, Wake)
+  {
+    Presence.configure(Debounce_ms, Hold_ms);
+  }
+
+  void run(uint32_t ms)
+  {
+    uint64_t end = now_us() + ms * 1000ull;
+    for (uint64_t t; (t = now_us()) < end; )
+    {
+      uint32_t left = static_cast<uint32_t>((end - t + 999) / 1000);
+      Wake.wait((Presence.due() < left) ? Presence.due() : left);
+
+      Pir::Event event;
+      while (Presence(event))
+      {
+        Events.push_back(event);
+        Reported_us.push_back(now_us());
+      }
+    }
+  }
+
+  rtos::Wakeup             Wake;
+  Pir                      Presence;
+  std::vector<Pir::Event>  Events;
+  std::vector<uint64_t>    Reported_us;
+};
+
+// sets the pin and returns the time of the edge
+static uint64_t edge(int level)
+{
+  uint64_t t = now_us();
+  mock::setPin(PirPin, level);
+  return t;
+}
+
+
+void setUp()
+{
+  mock::resetPins();
+  mock::setPin(PirPin, LOW);
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// pulses and gaps shorter than the settle time are counted as glitches and change nothing; a level that lasts is reported once, with the
+// time of its edge
+void test_glitches_rejected()
+{
+  Consumer pir;
+  pir.run(2 * Debounce_ms);
+  TEST_ASSERT_EQUAL(0, pir.Events.size());
+
+  // chatter: 2 ms pulses, 3 ms apart
+  for (int i = 0; i < 5; ++i)
+  {
+    edge(HIGH);
+    pir.run(2);
+    edge(LOW);
+    pir.run(3);
+  }
+  pir.run(2 * Debounce_ms);
+  TEST_ASSERT_EQUAL(0, pir.Events.size());
+  TEST_ASSERT_GREATER_OR_EQUAL(9, pir.Presence.glitches());
+  TEST_ASSERT_FALSE(pir.Presence.active());
+
+  // a bouncing rising edge: reported once, from the last bounce on
+  edge(HIGH);
+  pir.run(1);
+  edge(LOW);
+  pir.run(1);
+  uint64_t rise = edge(HIGH);
+  pir.run(2 * Debounce_ms);
+  TEST_ASSERT_EQUAL(1, pir.Events.size());
+  TEST_ASSERT_TRUE(pir.Events[0].Active);
+  TEST_ASSERT_TRUE(pir.Events[0].Time_us >= rise);
+  TEST_ASSERT_TRUE(pir.Events[0].Time_us - rise < 1000);
+  TEST_ASSERT_TRUE(pir.Presence.active());
+}
+
+//==============================================================================================================================================================
+// presence is released Hold_ms after the input went inactive; a short dropout within the hold does not release it
+void test_release_hold()
+{
+  Consumer pir;
+  edge(HIGH);
+  pir.run(2 * Debounce_ms);
+  TEST_ASSERT_EQUAL(1, pir.Events.size());
+
+  // inactive for half the hold time: no release
+  edge(LOW);
+  pir.run(Hold_ms / 2);
+  edge(HIGH);
+  pir.run(Hold_ms + Debounce_ms);
+  TEST_ASSERT_EQUAL(1, pir.Events.size());
+  TEST_ASSERT_TRUE(pir.Presence.active());
+
+  // inactive for good: released after debounce + hold, dated to the falling edge
+  uint64_t fall = edge(LOW);
+  pir.run(Debounce_ms + Hold_ms / 2);
+  TEST_ASSERT_EQUAL(1, pir.Events.size());
+  pir.run(Hold_ms / 2 + Slack_ms);
+  TEST_ASSERT_EQUAL(2, pir.Events.size());
+  TEST_ASSERT_FALSE(pir.Events[1].Active);
+  TEST_ASSERT_TRUE(pir.Events[1].Time_us - fall < 1000);
+  TEST_ASSERT_GREATER_OR_EQUAL((Debounce_ms + Hold_ms - 2 * Tick_ms) * 1000, pir.Reported_us[1] - fall);
+  TEST_ASSERT_LESS_THAN((Debounce_ms + Hold_ms + Slack_ms) * 1000, pir.Reported_us[1] - fall);
+}
+
+//==============================================================================================================================================================
+// more edges than the queue holds arrive before the task runs: the last ones are lost, the pin is read instead of trusting the queue
+void test_lost_edges_reread_pin()
+{
+  Consumer pir;
+  pir.run(2 * Debounce_ms);
+
+  // 21 edges: the queued 16 end LOW, the pin ends HIGH
+  for (int i = 1; i <= 21; ++i)
+  {
+    edge((i % 2) ? HIGH : LOW);
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(1, pir.Presence.lost());
+
+  pir.run(2 * Debounce_ms);
+  TEST_ASSERT_EQUAL(1, pir.Events.size());
+  TEST_ASSERT_TRUE(pir.Events[0].Active);
+  TEST_ASSERT_TRUE(pir.Presence.active());
+}
+
+//==============================================================================================================================================================
+// the edge wakes the task, which reports the presence once it settled: Debounce_ms after the edge, not a loop period or more later
+void test_edge_to_event_latency()
+{
+  Consumer pir;
+  pir.run(2 * Debounce_ms);
+
+  uint64_t    rise = 0;
+  std::thread sensor([&]
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    rise = edge(HIGH);
+  });
+  pir.run(30 + 2 * Debounce_ms + Slack_ms);
+  sensor.join();
+
+  TEST_ASSERT_EQUAL(1, pir.Events.size());
+  uint64_t latency_us = pir.Reported_us[0] - rise;
+  TEST_ASSERT_TRUE(pir.Events[0].Time_us - rise < 1000);
+  TEST_ASSERT_GREATER_OR_EQUAL((Debounce_ms - Tick_ms) * 1000, latency_us);
+  TEST_ASSERT_LESS_THAN((Debounce_ms + Slack_ms) * 1000, latency_us);
+
+  char line[96];
+  snprintf(line, sizeof(line), "edge to event: %u us (debounce %u ms)", static_cast<unsigned>(latency_us), static_cast<unsigned>(Debounce_ms));
+  TEST_MESSAGE(line);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_glitches_rejected);
+  RUN_TEST(test_release_hold);
+  RUN_TEST(test_lost_edges_reread_pin);
+  RUN_TEST(test_edge_to_event_latency);
+  return UNITY_END();
+}
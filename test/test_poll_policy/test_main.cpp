@@ -0,0 +1,273 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <ReaderBench.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include "Input/Pir.hpp"
+#include "Rfid/PollPolicy.hpp"
+#include "Rfid/ReaderSet.hpp"
+
+using namespace dps;
+using input::Pir;
+using rfid::PollPolicy;
+using mock::now_us;
+
+enum : uint8_t { PirPin = 4, Sck = 14, Miso = 12, Mosi = 13 };
+
+enum : uint32_t
+{
+  Slack_ms = 25,   // scheduling of the host: a sleep may overrun by a few ms now and then, more on a loaded machine
+};
+
+using TReaders = rfid::ReaderSet<rfid::SpiBus<Sck, Miso, Mosi>, rfid::Reader<5, 22, 21>>;
+
+// the reader task and the protocol task's presence part in one loop, with the default thresholds: PIR events drive the policy, whose
+// interval is handed to the readers for their next round (as App::applyPolling)
+struct Bench : mock::ReaderBench<Bench>
+{
+  mock::Chip       Chip{ 5, 22, 21 };
+  TReaders         Readers{ Waker };
+  Pir              Presence{ PirPin, Waker };
+  PollPolicy       Polling;
+  uint32_t         Arms = 0;
+
+  struct Poll
+  {
+    uint64_t Time_us;
+    bool     Present;   // the policy's view when the field was polled
+  };
+  std::vector<Poll> Polls;
+
+  Bench()
+  {
+    Readers.setRearm(Polling.interval());
+  }
+
+  auto& readers() { return Readers; }
+
+  void serviced()
+  {
+    if (Chip.Ops.Arms != Arms)
+    {
+      Arms = Chip.Ops.Arms;
+      Polls.push_back({ now_us(), Polling.present() });
+    }
+
+    bool       changed = false;
+    Pir::Event event;
+    while (Presence(event))
+    {
+      changed |= Polling.presence(event.Active);
+    }
+    changed |= Polling();
+
+    if (changed)
+    {
+      Readers.setRearm(Polling.interval());
+      Waker.notify();
+    }
+  }
+
+  uint32_t due()
+  {
+    common::delta::Deadline next(Readers.due());
+    next.at(Presence.due());
+    next.at(Polling.due());
+    return next.remaining();
+  }
+};
+
+// a recorded trace: PIR edges and cards held to the reader, in ms from the start
+struct Step
+{
+  enum class Kinds { Rise, Fall, Card, Leave };
+
+  uint32_t At_ms;
+  Kinds    Kind;
+};
+
+struct Card
+{
+  uint64_t Entered_us;
+  bool     Seen;       // by the PIR, i.e. someone is there as far as the policy knows
+};
+
+struct Replay
+{
+  uint64_t              Span_us;
+  uint32_t              Polls;
+  uint64_t              WorstActive_us;   // longest gap between two polls while someone is there, i.e. the worst case detection latency
+  uint64_t              WorstIdle_us;     // the same while nobody is
+  std::vector<Card>     Cards;
+  std::vector<uint64_t> Latency_us;       // card held to the reader until its arrival was delivered
+};
+
+// plays the trace in real time: every step is applied when it is due, the bench runs in between
+static Replay replay(Bench& bench, std::vector<Step> const& trace, uint32_t end_ms)
+{
+  Replay   result;
+  bool     seen   = false;
+  uint8_t  serial = 0;
+  auto     tag    = mock::Tag::ultralight(0);
+  uint64_t start  = now_us();
+  uint32_t arms   = bench.Chip.Ops.Arms;
+  bench.Polls.clear();
+
+  auto until = [&](uint32_t ms)
+  {
+    uint64_t at = start + ms * 1000ull;
+    uint64_t t  = now_us();
+    bench.run((at > t) ? static_cast<uint32_t>((at - t + 999) / 1000) : 0);
+  };
+
+  for (auto const& step : trace)
+  {
+    until(step.At_ms);
+    switch (step.Kind)
+    {
+    case Step::Kinds::Rise:  mock::setPin(PirPin, HIGH); break;
+    case Step::Kinds::Fall:  mock::setPin(PirPin, LOW);  break;
+    case Step::Kinds::Leave: bench.Chip.leave(tag.Uid);  break;
+    case Step::Kinds::Card:
+      seen = bench.Polling.present();
+      tag  = mock::Tag::ultralight(++serial);
+      result.Cards.push_back({ now_us(), seen });
+      bench.Chip.enter(tag);
+      break;
+    }
+  }
+  until(end_ms);
+
+  result.Span_us        = now_us() - start;
+  result.Polls          = bench.Chip.Ops.Arms - arms;
+  result.WorstActive_us = 0;
+  result.WorstIdle_us   = 0;
+  for (size_t i = 1; i < bench.Polls.size(); ++i)
+  {
+    auto const& previous = bench.Polls[i - 1];
+    auto const& poll     = bench.Polls[i];
+    uint64_t&   worst    = (previous.Present && poll.Present) ? result.WorstActive_us : result.WorstIdle_us;
+    worst                = std::max(worst, poll.Time_us - previous.Time_us);
+  }
+
+  auto arrivals = bench.arrivals();
+  for (size_t i = 0; (i < arrivals.size()) && (i < result.Cards.size()); ++i)
+  {
+    TEST_ASSERT_TRUE(mock::Tag::ultralight(static_cast<uint8_t>(i + 1)).is(bench.Events[arrivals[i]].Uid));
+    result.Latency_us.push_back(bench.Reported_us[arrivals[i]] - result.Cards[i].Entered_us);
+  }
+  TEST_ASSERT_EQUAL(result.Cards.size(), result.Latency_us.size());
+  return result;
+}
+
+
+void setUp()
+{
+  mock::resetPins();
+  mock::setPin(PirPin, LOW);
+  SPI.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// one visitor: a glitch, then someone walks up and badges right away, badges again while standing there and once more after walking out of
+// the PIR's view (policy hold); later a card is held to the idle reader. Cards are found within the active interval while someone is there,
+// within the idle interval otherwise, and the field is polled far less often than at the active interval all the time
+void test_visitor_trace()
+{
+  using K = Step::Kinds;
+  std::vector<Step> const trace =
+  {
+    {   300, K::Rise  }, {   330, K::Fall  },   // glitch, shorter than the debounce
+    {  1000, K::Rise  }, {  1020, K::Card  }, {  1520, K::Leave },
+    {  1900, K::Card  }, {  2400, K::Leave },
+    {  2600, K::Fall  },                        // PIR released 2 s later, active polling 5 s after that
+    {  6000, K::Card  }, {  6500, K::Leave },
+    { 11500, K::Card  }, { 12000, K::Leave },
+  };
+
+  Bench  bench;
+  Replay result = replay(bench, trace, 12600);
+
+  uint64_t worstSeen = 0, worstUnseen = 0;
+  for (size_t i = 0; i < result.Cards.size(); ++i)
+  {
+    uint64_t& worst = result.Cards[i].Seen ? worstSeen : worstUnseen;
+    worst           = (result.Latency_us[i] > worst) ? result.Latency_us[i] : worst;
+  }
+  TEST_ASSERT_FALSE(result.Cards[0].Seen);   // the first card was faster than the debounce
+  TEST_ASSERT_TRUE(result.Cards[1].Seen && result.Cards[2].Seen);
+  TEST_ASSERT_FALSE(result.Cards[3].Seen);
+
+  double rate   = result.Polls * 1e6 / result.Span_us;
+  double always = 1000.0 / PollPolicy::Active_ms;
+
+  char line[128];
+  snprintf(line, sizeof(line), "%u polls in %.1f s: %.1f /s (always active: %.1f /s, %.0f %%)", static_cast<unsigned>(result.Polls),
+           result.Span_us / 1e6, rate, always, 100.0 * rate / always);
+  TEST_MESSAGE(line);
+  snprintf(line, sizeof(line), "worst case detection latency: %u us while present, %u us idle", static_cast<unsigned>(result.WorstActive_us),
+           static_cast<unsigned>(result.WorstIdle_us));
+  TEST_MESSAGE(line);
+  for (size_t i = 0; i < result.Cards.size(); ++i)
+  {
+    snprintf(line, sizeof(line), "card %u (%s): detected after %u us", static_cast<unsigned>(i + 1), result.Cards[i].Seen ? "active" : "idle",
+             static_cast<unsigned>(result.Latency_us[i]));
+    TEST_MESSAGE(line);
+  }
+
+  // badged during the debounce: found once the PIR confirmed presence at the latest
+  TEST_ASSERT_LESS_THAN((Pir::Debounce_ms + PollPolicy::Active_ms + Slack_ms) * 1000, result.Latency_us[0]);
+  TEST_ASSERT_LESS_THAN((PollPolicy::Active_ms + Slack_ms) * 1000, worstSeen);
+  TEST_ASSERT_LESS_THAN((PollPolicy::Idle_ms + Slack_ms) * 1000, worstUnseen);
+  TEST_ASSERT_LESS_THAN((PollPolicy::Active_ms + Slack_ms) * 1000, result.WorstActive_us);
+  TEST_ASSERT_LESS_THAN((PollPolicy::Idle_ms + Slack_ms) * 1000, result.WorstIdle_us);
+
+  // active from the confirmed rise until PIR and policy hold ran out (1.05 .. 9.6 s), idle otherwise: ~70 /s
+  TEST_ASSERT_TRUE(rate < 0.8 * always);
+  TEST_ASSERT_TRUE(rate > 0.5 * always);
+  TEST_ASSERT_FALSE(bench.Polling.present());
+  TEST_ASSERT_EQUAL(1, bench.Presence.glitches());
+}
+
+//==============================================================================================================================================================
+// nobody there: polled at the idle interval (and after every presence check while the card is tracked), a card is still found within it
+void test_empty_trace()
+{
+  using K = Step::Kinds;
+  std::vector<Step> const trace =
+  {
+    { 1500, K::Card }, { 2000, K::Leave },
+  };
+
+  Bench  bench;
+  Replay result = replay(bench, trace, 3000);
+
+  double rate = result.Polls * 1e6 / result.Span_us;
+  char   line[128];
+  snprintf(line, sizeof(line), "%u polls in %.1f s: %.1f /s, worst case %u us, card detected after %u us", static_cast<unsigned>(result.Polls),
+           result.Span_us / 1e6, rate, static_cast<unsigned>(result.WorstIdle_us), static_cast<unsigned>(result.Latency_us[0]));
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_FALSE(result.Cards[0].Seen);
+  TEST_ASSERT_LESS_THAN((PollPolicy::Idle_ms + Slack_ms) * 1000, result.Latency_us[0]);
+  TEST_ASSERT_LESS_THAN((PollPolicy::Idle_ms + Slack_ms) * 1000, result.WorstIdle_us);
+  TEST_ASSERT_EQUAL(0, result.WorstActive_us);
+  TEST_ASSERT_TRUE(rate < 1.5 * 1000.0 / PollPolicy::Idle_ms);
+  TEST_ASSERT_TRUE(rate > 1000.0 / PollPolicy::Idle_ms - 1);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_visitor_trace);
+  RUN_TEST(test_empty_trace);
+  return UNITY_END();
+}
@@ -0,0 +1,166 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <ReaderBench.h>
+#include <vector>
+
+#include "Rfid/Reader.hpp"
+
+using namespace dps;
+using rfid::Presence;
+using rfid::TagEvent;
+
+enum : uint8_t { Ss = 5, Rst = 22, Irq = 21 };
+
+using mock::now_us;
+
+// one reader on a simulated chip
+struct Bench : mock::ReaderBench<Bench>
+{
+  mock::Chip                 Chip{ Ss, Rst, Irq };
+  rfid::Reader<Ss, Rst, Irq> Reader{ Waker };
+
+  auto& readers() { return Reader; }
+};
+
+
+void setUp()
+{
+  mock::resetPins();
+  SPI.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// the RX interrupt of the armed REQA finds a new tag: one arrival, however long the tag stays
+void test_single_arrival()
+{
+  Bench bench;
+  auto  tag = mock::Tag::ultralight(1);
+  bench.run(50);
+  TEST_ASSERT_TRUE(bench.Reader.available());
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader.state());
+  TEST_ASSERT_EQUAL(0, bench.Events.size());
+
+  bench.Chip.enter(tag);
+  bench.run(1000);
+
+  TEST_ASSERT_EQUAL(1, bench.Events.size());
+  TEST_ASSERT_TRUE(bench.Events[0].Kind == Presence::Arrived);
+  TEST_ASSERT_TRUE(tag.is(bench.Events[0].Uid));
+  TEST_ASSERT_EQUAL(1, bench.Inventories.size());
+  TEST_ASSERT_EQUAL(1, bench.Reader.reads());
+  TEST_ASSERT_EQUAL(1, bench.Reader.tracked());
+  TEST_ASSERT_EQUAL(0, SPI.Conflicts);
+
+  // presence is checked by WUPA every Check_ms, the tag is halted after each check
+  TEST_ASSERT_UINT32_WITHIN(3, 9, bench.Chip.Ops.Wupa);
+  TEST_ASSERT_TRUE(bench.Chip.Field[0].Now == mock::Tag::State::Halted);
+}
+
+//==============================================================================================================================================================
+// removal once the tag has not been seen for the dedup window, with its dwell time
+void test_removal_after_window()
+{
+  Bench bench;
+  auto  tag = mock::Tag::ultralight(2);
+  bench.Chip.enter(tag);
+  bench.run(700);
+  TEST_ASSERT_EQUAL(1, bench.Events.size());
+
+  uint64_t left = now_us();
+  bench.Chip.leave(tag.Uid);
+  bench.run(700);
+
+  TEST_ASSERT_EQUAL(2, bench.Events.size());
+  auto const& arrived = bench.Events[0];
+  auto const& removed = bench.Events[1];
+  TEST_ASSERT_TRUE(removed.Kind == Presence::Removed);
+  TEST_ASSERT_TRUE(tag.is(removed.Uid));
+  TEST_ASSERT_EQUAL(0, bench.Reader.tracked());
+
+  // last seen by the final presence check before leaving, reported a window later
+  TEST_ASSERT_TRUE(removed.Time_us <= left);
+  TEST_ASSERT_TRUE(left - removed.Time_us < 150000);
+  TEST_ASSERT_EQUAL_UINT64(removed.Time_us - arrived.Time_us, removed.Dwell_us);
+  TEST_ASSERT_TRUE((removed.Dwell_us > 550000) && (removed.Dwell_us <= 700000));
+
+  uint64_t delay = bench.Reported_us[1] - removed.Time_us;
+  TEST_ASSERT_TRUE(delay >= 299000);   // window counted in whole ms
+  TEST_ASSERT_TRUE(delay < 400000);
+}
+
+//==============================================================================================================================================================
+// a tag returning after its removal is a new arrival
+void test_reentry()
+{
+  Bench bench;
+  auto  tag = mock::Tag::ultralight(3);
+  for (int round = 0; round < 3; ++round)
+  {
+    bench.Chip.enter(tag);
+    bench.run(400);
+    bench.Chip.leave(tag.Uid);
+    bench.run(500);
+  }
+
+  TEST_ASSERT_EQUAL(6, bench.Events.size());
+  for (size_t i = 0; i < bench.Events.size(); ++i)
+  {
+    TEST_ASSERT_TRUE(bench.Events[i].Kind == ((i % 2) ? Presence::Removed : Presence::Arrived));
+  }
+  TEST_ASSERT_EQUAL(3, bench.Reader.reads());
+  TEST_ASSERT_EQUAL(0, bench.Reader.duplicates());
+}
+
+//==============================================================================================================================================================
+// a tracked tag that lost its HALT state (field dip) answers the REQA again: a duplicate read, no second arrival
+// (unless the periodic presence check happens to wake it first, so the dip is repeated)
+void test_duplicate_read()
+{
+  Bench bench;
+  auto  tag = mock::Tag::ultralight(4);
+  bench.Chip.enter(tag);
+  bench.run(300);
+
+  for (int dip = 0; dip < 8; ++dip)
+  {
+    bench.Chip.Field[0].Now = mock::Tag::State::Idle;
+    bench.run(150);
+  }
+
+  TEST_ASSERT_EQUAL(1, bench.Events.size());
+  TEST_ASSERT_EQUAL(1, bench.Inventories.size());
+  TEST_ASSERT_TRUE(bench.Reader.reads() > 1);
+  TEST_ASSERT_EQUAL(bench.Reader.reads() - 1, bench.Reader.duplicates());
+}
+
+//==============================================================================================================================================================
+// nothing in the field: the reader only re-arms and watches, the IRQ stays quiet
+void test_idle_field()
+{
+  Bench bench;
+  bench.run(1200);
+
+  TEST_ASSERT_EQUAL(0, bench.Events.size());
+  TEST_ASSERT_EQUAL(0, bench.Reader.irqs());
+  TEST_ASSERT_EQUAL(0, bench.Chip.Ops.Wupa);
+  TEST_ASSERT_TRUE(bench.Chip.Ops.Reqa > 50);
+  TEST_ASSERT_EQUAL(0, bench.Reader.faults(rfid::Fault::Version) + bench.Reader.faults(rfid::Fault::Config));
+  TEST_ASSERT_EQUAL(8000000, bench.Reader.registers().clock());
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_single_arrival);
+  RUN_TEST(test_removal_after_window);
+  RUN_TEST(test_reentry);
+  RUN_TEST(test_duplicate_read);
+  RUN_TEST(test_idle_field);
+  return UNITY_END();
+}
@@ -0,0 +1,221 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <ReaderBench.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Rfid/Reader.hpp"
+
+using namespace dps;
+using rfid::Fault;
+using rfid::Presence;
+
+enum : uint8_t { Ss = 5, Rst = 22, Irq = 21 };
+
+using mock::now_us;
+
+// one reader on a fault injecting chip; every state change is logged
+struct Bench : mock::ReaderBench<Bench>
+{
+  struct Change
+  {
+    uint64_t    Time_us;
+    std::string State;
+    uint32_t    Backoff;
+  };
+
+  using TReader = rfid::Reader<Ss, Rst, Irq>;
+
+  mock::Chip             Chip{ Ss, Rst, Irq };
+  std::optional<TReader> Reader;
+  std::vector<Change>    Changes;
+
+  // the reader is constructed by start(), so faults can be injected before its init
+  void start()
+  {
+    Reader.emplace(Waker);
+    log();
+  }
+
+  auto& readers()  { return *Reader; }
+  void  serviced() { log(); }
+
+  void log()
+  {
+    if (Changes.empty() || (Changes.back().State != Reader->state()))
+    {
+      Changes.push_back({ now_us(), Reader->state(), Reader->backoff() });
+    }
+  }
+
+  // the changes into 'state', in order
+  std::vector<Change> entries(char const* state) const
+  {
+    std::vector<Change> found;
+    for (auto const& change : Changes)
+    {
+      if (change.State == state)
+      {
+        found.push_back(change);
+      }
+    }
+    return found;
+  }
+};
+
+
+void setUp()
+{
+  mock::resetPins();
+  SPI.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// RF noise garbles VersionReg: the watchdog sees it within a period, the hard reset clears it, tags are read again afterwards
+void test_version_latch_recovers()
+{
+  Bench bench;
+  bench.start();
+  bench.run(100);
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader->state());
+
+  bench.Chip.latchUp();
+  bench.run(1300);
+
+  TEST_ASSERT_EQUAL(1, bench.Reader->faults(Fault::Version));
+  TEST_ASSERT_EQUAL(0, bench.Reader->faults(Fault::Init));
+  TEST_ASSERT_EQUAL(1, bench.Reader->reinits());
+  TEST_ASSERT_EQUAL(1, bench.entries("error").size());
+  TEST_ASSERT_EQUAL(1, bench.entries("reinit").size());
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader->state());
+  TEST_ASSERT_TRUE(bench.Reader->available());
+  TEST_ASSERT_EQUAL_HEX8(mock::Chip::Version, bench.Reader->version());
+
+  auto tag = mock::Tag::ultralight(1);
+  bench.Chip.enter(tag);
+  bench.run(200);
+  TEST_ASSERT_EQUAL(1, bench.Events.size());
+  TEST_ASSERT_TRUE(bench.Events[0].Kind == Presence::Arrived);
+  TEST_ASSERT_LESS_THAN(5000, bench.MaxService_us);
+}
+
+//==============================================================================================================================================================
+// a glitch clears ComIEnReg (no more RX interrupts): detected as a lost configuration, the reinit restores it
+void test_cleared_irq_enable_recovers()
+{
+  Bench bench;
+  bench.start();
+  bench.run(100);
+
+  bench.Chip.poke(MFRC522::ComIEnReg, 0x00);
+  bench.run(1300);
+
+  TEST_ASSERT_EQUAL(1, bench.Reader->faults(Fault::Config));
+  TEST_ASSERT_EQUAL(0, bench.Reader->faults(Fault::Version));
+  TEST_ASSERT_EQUAL(1, bench.Reader->reinits());
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader->state());
+  TEST_ASSERT_EQUAL_HEX8(0xA0, bench.Chip.reg(MFRC522::ComIEnReg));
+
+  // Error -> Reinit after the minimum backoff, Reinit -> Armed after power down and oscillator start
+  auto error  = bench.entries("error");
+  auto reinit = bench.entries("reinit");
+  auto armed  = bench.entries("armed");
+  TEST_ASSERT_EQUAL(1, error.size());
+  TEST_ASSERT_EQUAL(100, error[0].Backoff);
+  TEST_ASSERT_UINT32_WITHIN(15000, 100000, reinit[0].Time_us - error[0].Time_us);
+  TEST_ASSERT_UINT32_WITHIN(15000, 51000, armed.back().Time_us - reinit[0].Time_us);
+
+  auto tag = mock::Tag::classic(2);
+  bench.Chip.enter(tag);
+  bench.run(200);
+  TEST_ASSERT_EQUAL(1, bench.Events.size());
+}
+
+//==============================================================================================================================================================
+// the bus does not answer for 1.5 s from power on: every failed init doubles the backoff (100, 200, 400, 800 ms), the reinit after the stall
+// succeeds; after a good watchdog check the next fault starts over at the minimum backoff
+void test_backoff_schedule()
+{
+  Bench bench;
+  bench.Chip.stall(1500);
+  bench.start();
+  TEST_ASSERT_EQUAL(1, bench.Reader->faults(Fault::Init));
+  bench.run(20);
+  TEST_ASSERT_FALSE(bench.Reader->available());
+  TEST_ASSERT_EQUAL_STRING("error", bench.Reader->state());
+
+  bench.run(1980);
+  TEST_ASSERT_TRUE(bench.Chip.Ops.Timeouts > 0);
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader->state());
+  TEST_ASSERT_EQUAL(4, bench.Reader->faults(Fault::Init));
+  TEST_ASSERT_EQUAL(4, bench.Reader->reinits());
+
+  auto     error  = bench.entries("error");
+  auto     reinit = bench.entries("reinit");
+  uint32_t expect = 100;
+  TEST_ASSERT_EQUAL(4, error.size());
+  TEST_ASSERT_EQUAL(4, reinit.size());
+  for (size_t i = 0; i < error.size(); ++i, expect *= 2)
+  {
+    TEST_ASSERT_EQUAL(expect, error[i].Backoff);
+    TEST_ASSERT_UINT32_WITHIN(15000, 1000ull * expect, reinit[i].Time_us - error[i].Time_us);
+  }
+
+  // recovery never blocks the servicing task
+  TEST_ASSERT_LESS_THAN(5000, bench.MaxService_us);
+
+  // one good watchdog check resets the backoff
+  bench.run(1100);
+  bench.Chip.latchUp();
+  bench.run(1300);
+  error = bench.entries("error");
+  TEST_ASSERT_EQUAL(5, error.size());
+  TEST_ASSERT_EQUAL(100, error.back().Backoff);
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader->state());
+}
+
+//==============================================================================================================================================================
+// a run of failed selections (SPI/RF timeouts mid-exchange) is a fault, a single one is not
+void test_select_failures()
+{
+  Bench bench;
+  bench.start();
+  bench.run(50);
+
+  auto tag = mock::Tag::ultralight(3);
+  bench.Chip.FailSelects = 1;
+  bench.Chip.enter(tag);
+  bench.run(300);
+  TEST_ASSERT_EQUAL(1, bench.Reader->faults(Fault::Select));
+  TEST_ASSERT_EQUAL(0, bench.entries("error").size());
+  TEST_ASSERT_EQUAL(1, bench.Events.size());
+
+  bench.Chip.leave(tag.Uid);
+  bench.run(500);
+  bench.Chip.FailSelects = 3;
+  bench.Chip.enter(tag);
+  bench.run(100);
+  TEST_ASSERT_EQUAL(4, bench.Reader->faults(Fault::Select));
+  TEST_ASSERT_EQUAL(1, bench.entries("error").size());
+
+  bench.run(300);
+  TEST_ASSERT_EQUAL_STRING("armed", bench.Reader->state());
+  TEST_ASSERT_EQUAL(3, bench.Events.size());   // arrival, removal, arrival after the reinit
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_version_latch_recovers);
+  RUN_TEST(test_cleared_irq_enable_recovers);
+  RUN_TEST(test_backoff_schedule);
+  RUN_TEST(test_select_failures);
+  return UNITY_END();
+}
@@ -0,0 +1,179 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <ReaderBench.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Rfid/ReaderSet.hpp"
+
+using namespace dps;
+
+enum : uint8_t { Sck = 14, Miso = 12, Mosi = 13 };
+
+using TReaders = rfid::ReaderSet<rfid::SpiBus<Sck, Miso, Mosi>,
+                                 rfid::Reader<5,  22, 21>,
+                                 rfid::Reader<15, 16, 17>,
+                                 rfid::Reader<25, 26, 27>>;
+
+enum : size_t { N = TReaders::Count };
+
+using mock::now_us;
+
+// three readers on simulated chips
+struct Bench : mock::ReaderBench<Bench>
+{
+  mock::Chip Chips[N] = { { 5, 22, 21 }, { 15, 16, 17 }, { 25, 26, 27 } };
+  TReaders   Readers{ Waker };
+
+  auto& readers() { return Readers; }
+};
+
+
+void setUp()
+{
+  mock::resetPins();
+  SPI.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// every round services every reader once; the reader serviced first moves on by one each round, so tags detected by all readers in the same
+// round are reported starting with a different reader every time
+void test_rotation()
+{
+  for (size_t extra = 0; extra < N; ++extra)
+  {
+    Bench bench;
+    bench.round();                            // arms all receivers, the field is empty
+    for (size_t k = 0; k < extra; ++k)
+    {
+      bench.round();                          // nothing due
+    }
+    for (size_t r = 0; r < N; ++r)
+    {
+      bench.Chips[r].enter(mock::Tag::ultralight(static_cast<uint8_t>(r + 1)));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(12));
+    bench.round();                            // re-arm: every reader's REQA is answered, IRQ
+    TEST_ASSERT_EQUAL(0, bench.Events.size());
+    bench.round();                            // inventories in service order
+
+    TEST_ASSERT_EQUAL(N, bench.Events.size());
+    size_t first = (2 + extra) % N;
+    for (size_t k = 0; k < N; ++k)
+    {
+      TEST_ASSERT_EQUAL((first + k) % N, bench.Events[k].Source);
+      TEST_ASSERT_TRUE(bench.Chips[bench.Events[k].Source].Field[0].is(bench.Events[k].Uid));
+    }
+    for (size_t r = 0; r < N; ++r)
+    {
+      TEST_ASSERT_EQUAL(3 + extra, bench.Readers.service(r).Rounds);
+    }
+    TEST_ASSERT_EQUAL(0, SPI.Conflicts);
+  }
+}
+
+//==============================================================================================================================================================
+// tags arrive at every reader in turn: each reader reports its own tags within a re-arm interval plus one round, the latencies are alike
+void test_per_reader_latency()
+{
+  Bench bench;
+  bench.run(50);
+
+  std::vector<uint64_t> worst(N, 0);
+  for (int i = 0; i < 12; ++i)
+  {
+    size_t   r       = i % N;
+    auto     tag     = mock::Tag::classic(static_cast<uint8_t>(i + 1));
+    size_t   before  = bench.arrivals().size();
+    uint64_t entered = now_us();
+    bench.Chips[r].enter(tag);
+    bench.run(40 + 7 * i % 13);
+
+    auto arrivals = bench.arrivals();
+    TEST_ASSERT_EQUAL(before + 1, arrivals.size());
+    TEST_ASSERT_EQUAL(r, bench.Events[arrivals.back()].Source);
+    TEST_ASSERT_TRUE(tag.is(bench.Events[arrivals.back()].Uid));
+    worst[r] = std::max(worst[r], bench.Reported_us[arrivals.back()] - entered);
+    bench.Chips[r].leave(tag.Uid);
+  }
+
+  char line[128];
+  for (size_t r = 0; r < N; ++r)
+  {
+    TEST_ASSERT_LESS_THAN(20000, worst[r]);   // re-arm interval (10 ms) + service
+    snprintf(line, sizeof(line), "reader %zu: worst arrival latency %llu us, worst wait %u us", r, static_cast<unsigned long long>(worst[r]),
+             static_cast<unsigned>(bench.Readers.service(r).Wait_us));
+    TEST_MESSAGE(line);
+  }
+}
+
+//==============================================================================================================================================================
+// a dead reader cycles through Error/Reinit with its backoff without delaying the others: they keep their rounds and latencies
+void test_stuck_reader_does_not_starve_others()
+{
+  Bench bench;
+  bench.run(50);
+  bench.Chips[1].Dead = true;   // found by the watchdog check
+  bench.run(1300);
+
+  bool stuck = true;
+  bench.Readers.visit(1, [&](auto const& reader) { stuck = !reader.available(); });
+  TEST_ASSERT_TRUE(stuck);
+
+  for (int i = 0; i < 8; ++i)
+  {
+    size_t   r       = (i % 2) ? 2 : 0;
+    auto     tag     = mock::Tag::ultralight(static_cast<uint8_t>(i + 1));
+    size_t   before  = bench.arrivals().size();
+    uint64_t entered = now_us();
+    bench.Chips[r].enter(tag);
+    bench.run(60);
+
+    auto arrivals = bench.arrivals();
+    TEST_ASSERT_EQUAL(before + 1, arrivals.size());
+    TEST_ASSERT_EQUAL(r, bench.Events[arrivals.back()].Source);
+    TEST_ASSERT_LESS_THAN(20000, bench.Reported_us[arrivals.back()] - entered);
+    bench.Chips[r].leave(tag.Uid);
+  }
+
+  uint32_t reinits = 0;
+  bench.Readers.visit(1, [&](auto const& reader) { reinits = reader.reinits(); });
+  TEST_ASSERT_TRUE(reinits >= 2);
+
+  // the statistics copy as reported to the host
+  rfid::Report stuckReport, goodReport;
+  bench.Readers.report(1, stuckReport);
+  bench.Readers.report(2, goodReport);
+  TEST_ASSERT_EQUAL(1, stuckReport.Source);
+  TEST_ASSERT_EQUAL(reinits, stuckReport.Reinits);
+  TEST_ASSERT_EQUAL(1, stuckReport.Faults[static_cast<size_t>(rfid::Fault::Version)]);
+  TEST_ASSERT_EQUAL(bench.Readers.service(1).Rounds, stuckReport.Rounds);
+  TEST_ASSERT_TRUE(goodReport.Available);
+  TEST_ASSERT_EQUAL(0, goodReport.Reinits);
+  TEST_ASSERT_EQUAL(0, goodReport.Faults[static_cast<size_t>(rfid::Fault::Version)]);
+  TEST_ASSERT_TRUE(goodReport.SpiTransactions > 0);
+
+  for (size_t r = 0; r < N; ++r)
+  {
+    TEST_ASSERT_EQUAL(bench.Readers.service(0).Rounds, bench.Readers.service(r).Rounds);
+    TEST_ASSERT_LESS_THAN(5000, bench.Readers.service(r).Max_us);
+    TEST_ASSERT_LESS_THAN(5000, bench.Readers.service(r).Wait_us);
+  }
+  TEST_ASSERT_EQUAL(0, SPI.Conflicts);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_rotation);
+  RUN_TEST(test_per_reader_latency);
+  RUN_TEST(test_stuck_reader_does_not_starve_others);
+  return UNITY_END();
+}
@@ -0,0 +1,252 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Rfid/Reader.hpp"
+
+using namespace dps;
+
+enum : uint8_t { Ss = 5, Rst = 22, Irq = 21 };
+
+// one register access of a sequence
+struct Access
+{
+  MFRC522::PCD_Register Reg;
+  uint8_t               Value;
+  bool                  Read;
+};
+
+struct Traffic
+{
+  uint32_t Transactions;
+  uint32_t Frames;
+  uint32_t Bytes;
+};
+
+static Traffic traffic()
+{
+  return { SPI.Transactions, SPI.Frames, SPI.Bytes };
+}
+
+static Traffic since(Traffic const& start)
+{
+  return { SPI.Transactions - start.Transactions, SPI.Frames - start.Frames, SPI.Bytes - start.Bytes };
+}
+
+// as the library's PCD_WriteRegister/PCD_ReadRegister: a transaction and a frame per register
+static std::vector<uint8_t> unbatched(std::vector<Access> const& sequence)
+{
+  std::vector<uint8_t> results;
+  for (auto const& access : sequence)
+  {
+    SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+    digitalWrite(Ss, LOW);
+    if (access.Read)
+    {
+      SPI.transfer(0x80 | (access.Reg & 0x7E));
+      results.push_back(SPI.transfer(0x00));
+    }
+    else
+    {
+      SPI.transfer(access.Reg & 0x7E);
+      SPI.transfer(access.Value);
+    }
+    digitalWrite(Ss, HIGH);
+    SPI.endTransaction();
+  }
+  return results;
+}
+
+static std::vector<uint8_t> batched(std::vector<Access> const& sequence)
+{
+  rfid::RegisterBatch<> batch(Ss);
+  std::vector<uint8_t>  results(sequence.size());
+  for (size_t i = 0; i < sequence.size(); ++i)
+  {
+    if (sequence[i].Read)
+    {
+      batch.read(sequence[i].Reg, &results[i]);
+    }
+    else
+    {
+      batch.write(sequence[i].Reg, sequence[i].Value);
+    }
+  }
+  batch.flush();
+
+  // the batch counts what the bus saw
+  TEST_ASSERT_EQUAL(SPI.Transactions, batch.transactions());
+  TEST_ASSERT_EQUAL(SPI.Frames, batch.frames());
+  TEST_ASSERT_EQUAL(SPI.Bytes, batch.bytes());
+
+  std::vector<uint8_t> reads;
+  for (size_t i = 0; i < sequence.size(); ++i)
+  {
+    if (sequence[i].Read)
+    {
+      reads.push_back(results[i]);
+    }
+  }
+  return reads;
+}
+
+static std::vector<uint8_t> registers(mock::Chip const& chip)
+{
+  std::vector<uint8_t> regs;
+  for (uint8_t reg = 0; reg < 0x40; ++reg)
+  {
+    regs.push_back(chip.reg(static_cast<MFRC522::PCD_Register>(reg << 1)));
+  }
+  return regs;
+}
+
+
+void setUp()
+{
+  mock::resetPins();
+  SPI.reset();
+  pinMode(Ss, OUTPUT);
+  digitalWrite(Ss, HIGH);
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// the register sequences of the reader, each run unbatched (library style) and batched on a fresh chip: the same values are read and written,
+// the batch needs one transaction per sequence and never more frames or bytes
+void test_batching_cuts_traffic()
+{
+  struct Sequence
+  {
+    char const*         Name;
+    std::vector<Access> Accesses;
+    Traffic             Expect;   // batched
+  };
+
+  std::vector<Access> fifo;
+  for (uint8_t i = 0; i < 16; ++i)
+  {
+    fifo.push_back({ MFRC522::FIFODataReg, i, false });
+  }
+
+  Sequence const sequences[] =
+  {
+    { "setup", { { MFRC522::TxModeReg, 0x00, false },   { MFRC522::RxModeReg, 0x00, false },    { MFRC522::ModWidthReg, 0x26, false },
+                 { MFRC522::TModeReg, 0x80, false },    { MFRC522::TPrescalerReg, 0xA9, false }, { MFRC522::TReloadRegH, 0x03, false },
+                 { MFRC522::TReloadRegL, 0xE8, false }, { MFRC522::TxASKReg, 0x40, false },     { MFRC522::ModeReg, 0x3D, false },
+                 { MFRC522::TxControlReg, 0x83, false }, { MFRC522::ComIEnReg, 0xA0, false },   { MFRC522::ComIrqReg, 0x7F, false } },
+      { 1, 12, 24 } },
+    { "watchdog", { { MFRC522::VersionReg, 0, true }, { MFRC522::ComIEnReg, 0, true } }, { 1, 1, 3 } },
+    { "re-arm", { { MFRC522::ComIrqReg, 0x7F, false }, { MFRC522::FIFODataReg, MFRC522::PICC_CMD_REQA, false },
+                  { MFRC522::CommandReg, MFRC522::PCD_Transceive, false }, { MFRC522::BitFramingReg, 0x87, false } },
+      { 1, 4, 8 } },
+    { "fifo", fifo, { 1, 1, 17 } },
+    { "status", { { MFRC522::ComIrqReg, 0, true }, { MFRC522::DivIrqReg, 0, true }, { MFRC522::ErrorReg, 0, true },
+                  { MFRC522::Status1Reg, 0, true }, { MFRC522::Status2Reg, 0, true }, { MFRC522::FIFOLevelReg, 0, true },
+                  { MFRC522::ControlReg, 0, true }, { MFRC522::VersionReg, 0, true } },
+      { 1, 1, 9 } },
+  };
+
+  for (auto const& sequence : sequences)
+  {
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> state;
+    Traffic              plain;
+    {
+      mock::Chip chip{ Ss, Rst, Irq };
+      SPI.reset();
+      expected = unbatched(sequence.Accesses);
+      plain    = since({});
+      state    = registers(chip);
+    }
+
+    mock::Chip chip{ Ss, Rst, Irq };
+    SPI.reset();
+    auto    reads = batched(sequence.Accesses);
+    Traffic batch = since({});
+
+    TEST_ASSERT_EQUAL_MESSAGE(0, SPI.Conflicts, sequence.Name);
+    TEST_ASSERT_TRUE_MESSAGE(expected == reads, sequence.Name);
+    TEST_ASSERT_TRUE_MESSAGE(state == registers(chip), sequence.Name);
+
+    TEST_ASSERT_EQUAL_MESSAGE(sequence.Accesses.size(), plain.Transactions, sequence.Name);
+    TEST_ASSERT_EQUAL_MESSAGE(sequence.Expect.Transactions, batch.Transactions, sequence.Name);
+    TEST_ASSERT_EQUAL_MESSAGE(sequence.Expect.Frames, batch.Frames, sequence.Name);
+    TEST_ASSERT_EQUAL_MESSAGE(sequence.Expect.Bytes, batch.Bytes, sequence.Name);
+    TEST_ASSERT_TRUE_MESSAGE(batch.Frames <= plain.Frames, sequence.Name);
+    TEST_ASSERT_TRUE_MESSAGE(batch.Bytes <= plain.Bytes, sequence.Name);
+
+    char line[128];
+    snprintf(line, sizeof(line), "%-8s unbatched %2u transactions %2u frames %2u bytes, batched %u / %2u / %2u", sequence.Name,
+             static_cast<unsigned>(plain.Transactions), static_cast<unsigned>(plain.Frames), static_cast<unsigned>(plain.Bytes),
+             static_cast<unsigned>(batch.Transactions), static_cast<unsigned>(batch.Frames), static_cast<unsigned>(batch.Bytes));
+    TEST_MESSAGE(line);
+  }
+}
+
+//==============================================================================================================================================================
+// a full queue flushes by itself: 20 reads are two transactions (16 + 4), still pipelined per transaction
+void test_full_batch_flushes()
+{
+  mock::Chip            chip{ Ss, Rst, Irq };
+  rfid::RegisterBatch<> batch(Ss);
+  uint8_t               version[20] = {};
+
+  for (auto& value : version)
+  {
+    batch.read(MFRC522::VersionReg, &value);
+  }
+  TEST_ASSERT_EQUAL(1, SPI.Transactions);
+  batch.flush();
+
+  TEST_ASSERT_EQUAL(2, SPI.Transactions);
+  TEST_ASSERT_EQUAL(2, SPI.Frames);
+  TEST_ASSERT_EQUAL(17 + 5, SPI.Bytes);
+  for (uint8_t value : version)
+  {
+    TEST_ASSERT_EQUAL_HEX8(mock::Chip::Version, value);
+  }
+}
+
+//==============================================================================================================================================================
+// an idle armed reader: all its bus traffic goes through the batch, one transaction per re-arm (10 ms) and per watchdog check (1 s)
+void test_reader_idle_traffic()
+{
+  rtos::Wakeup               waker;
+  mock::Chip                 chip{ Ss, Rst, Irq };
+  rfid::Reader<Ss, Rst, Irq> reader{ waker };
+
+  Traffic  start = traffic();
+  uint32_t t0    = reader.registers().transactions();
+  uint32_t end   = millis() + 1100;
+  while (static_cast<int32_t>(end - millis()) > 0)
+  {
+    reader([](rfid::TagEvent const&) {}, [](rfid::Inventory const&) {});
+    waker.wait(std::min<uint32_t>(reader.due(), 10));
+  }
+
+  Traffic used = since(start);
+  TEST_ASSERT_EQUAL(reader.registers().transactions() - t0, used.Transactions);
+  TEST_ASSERT_UINT32_WITHIN(20, 110, used.Transactions);
+  TEST_ASSERT_TRUE(used.Frames <= 4 * used.Transactions);
+  TEST_ASSERT_EQUAL(0, SPI.Conflicts);
+
+  char line[128];
+  snprintf(line, sizeof(line), "idle reader, 1.1 s: %u transactions, %u frames, %u bytes", static_cast<unsigned>(used.Transactions),
+           static_cast<unsigned>(used.Frames), static_cast<unsigned>(used.Bytes));
+  TEST_MESSAGE(line);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_batching_cuts_traffic);
+  RUN_TEST(test_full_batch_flushes);
+  RUN_TEST(test_reader_idle_traffic);
+  return UNITY_END();
+}
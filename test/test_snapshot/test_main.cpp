@@ -0,0 +1,295 @@
+#include <unity.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+// host stand-in for the partition, removed again by the tests
+#define DPS_CREDENTIALS_FILE "test_credentials.bin"
+
+#include "Access/Snapshot.hpp"
+
+using namespace dps::access;
+
+enum : size_t
+{
+  RegionSize = DPS_CREDENTIALS_FILE_SIZE,
+  SlotSize   = RegionSize / 2,
+};
+
+// keys of one generation, sorted and unique like Allowlist::commit() leaves them
+struct Keys
+{
+  std::vector<uint32_t> Short;
+  std::vector<uint64_t> Long;
+
+  KeySet view() const { return {Short.data(), Short.size(), Long.data(), Long.size()}; }
+};
+
+static std::mt19937 Rng;
+
+static Keys randomKeys(size_t nShort, size_t nLong)
+{
+  std::set<uint32_t> s;
+  std::set<uint64_t> l;
+  while (s.size() < nShort) s.insert(Rng() % 50000);
+  while (l.size() < nLong)  l.insert((uint64_t(7) << 56) | (Rng() % 50000));
+  return {{s.begin(), s.end()}, {l.begin(), l.end()}};
+}
+
+template <typename TKey>
+static std::vector<TKey> apply(std::vector<TKey> const& base, std::vector<TKey> const& add, std::vector<TKey> const& remove)
+{
+  std::set<TKey> result(base.begin(), base.end());
+  result.insert(add.begin(), add.end());
+  for (auto key : remove)
+  {
+    result.erase(key);
+  }
+  return {result.begin(), result.end()};
+}
+
+static void assertKeys(Keys const& expected, KeySet const& keys)
+{
+  TEST_ASSERT_EQUAL_size_t(expected.Short.size(), keys.ShortSize);
+  TEST_ASSERT_EQUAL_size_t(expected.Long.size(),  keys.LongSize);
+  TEST_ASSERT_TRUE(std::equal(expected.Short.begin(), expected.Short.end(), keys.Short));
+  TEST_ASSERT_TRUE(std::equal(expected.Long.begin(),  expected.Long.end(),  keys.Long));
+}
+
+// direct access to the file behind the region, e.g. to leave the state a crash would
+static void patch(size_t offset, void const* data, size_t size)
+{
+  int file = ::open(DPS_CREDENTIALS_FILE, O_RDWR);
+  TEST_ASSERT_TRUE(file >= 0);
+  TEST_ASSERT_EQUAL(static_cast<ssize_t>(size), pwrite(file, data, size, offset));
+  ::close(file);
+}
+
+static void fill(size_t offset, uint8_t value, size_t size)
+{
+  std::vector<uint8_t> bytes(size, value);
+  patch(offset, bytes.data(), size);
+}
+
+static uint8_t peek(size_t offset)
+{
+  uint8_t value = 0;
+  int     file  = ::open(DPS_CREDENTIALS_FILE, O_RDONLY);
+  TEST_ASSERT_EQUAL(1, pread(file, &value, 1, offset));
+  ::close(file);
+  return value;
+}
+
+
+void setUp()
+{
+  ::unlink(DPS_CREDENTIALS_FILE);
+  Rng.seed(15);
+}
+
+void tearDown()
+{
+  ::unlink(DPS_CREDENTIALS_FILE);
+}
+
+
+//==============================================================================================================================================================
+void test_empty_region_has_no_generation()
+{
+  Snapshot snapshot;
+  TEST_ASSERT_FALSE(snapshot.open());
+  TEST_ASSERT_FALSE(snapshot.valid());
+  TEST_ASSERT_EQUAL_UINT32(0, snapshot.generation());
+  TEST_ASSERT_TRUE(snapshot.keys().empty());
+  TEST_ASSERT_EQUAL_size_t(SlotSize - 64, snapshot.capacity());
+}
+
+
+//==============================================================================================================================================================
+// a full load followed by random deltas; every generation survives a reopen and alternates between the slots
+void test_incremental_updates_persist()
+{
+  Keys expected = randomKeys(3000, 300);
+  {
+    Snapshot snapshot;
+    snapshot.open();
+    TEST_ASSERT_TRUE(snapshot.write(1, KeySet(), expected.view(), KeySet()));
+    assertKeys(expected, snapshot.keys());
+  }
+
+  for (uint32_t generation = 2; generation < 30; ++generation)
+  {
+    Snapshot snapshot;
+    TEST_ASSERT_TRUE(snapshot.open());
+    TEST_ASSERT_EQUAL_UINT32(generation - 1, snapshot.generation());
+    assertKeys(expected, snapshot.keys());
+
+    Keys add    = randomKeys(Rng() % 200, Rng() % 20);
+    Keys remove = randomKeys(Rng() % 2000, Rng() % 200);   // partly present, partly not
+    int  before = snapshot.slot();
+
+    TEST_ASSERT_TRUE(snapshot.write(generation, snapshot.keys(), add.view(), remove.view()));
+    expected = {apply(expected.Short, add.Short, remove.Short), apply(expected.Long, add.Long, remove.Long)};
+
+    assertKeys(expected, snapshot.keys());
+    TEST_ASSERT_EQUAL_UINT32(generation, snapshot.generation());
+    TEST_ASSERT_EQUAL(1 - before, snapshot.slot());
+  }
+}
+
+
+//==============================================================================================================================================================
+// whatever an interrupted write leaves in the inactive slot, the previous generation stays active
+void test_crash_leaves_previous_generation()
+{
+  Keys first  = randomKeys(500, 50);
+  Keys second = randomKeys(800, 10);
+  {
+    Snapshot snapshot;
+    snapshot.open();
+    TEST_ASSERT_TRUE(snapshot.write(1, KeySet(), first.view(), KeySet()));
+    TEST_ASSERT_TRUE(snapshot.write(2, KeySet(), second.view(), KeySet()));
+    TEST_ASSERT_EQUAL(1, snapshot.slot());
+  }
+
+  struct { size_t Offset; uint8_t Value; size_t Size; } const crashes[] =
+  {
+    { SlotSize,        0xFF, 64   },   // erased, header not yet written
+    { SlotSize + 100,  0xFF, 1000 },   // keys partly written
+    { SlotSize + 2000, 0x00, 1    },   // payload corrupted after the commit
+    { SlotSize + 8,    0x00, 1    },   // header torn (generation)
+    { SlotSize + 28,   0xFF, 4    },   // header torn (payload CRC)
+  };
+
+  uint32_t generation = 2;
+  for (auto const& crash : crashes)
+  {
+    {
+      Snapshot snapshot;
+      TEST_ASSERT_TRUE(snapshot.open());
+      TEST_ASSERT_EQUAL(1, snapshot.slot());
+      TEST_ASSERT_TRUE(snapshot.write(++generation, snapshot.keys(), KeySet(), KeySet()));
+      TEST_ASSERT_EQUAL(0, snapshot.slot());
+      TEST_ASSERT_TRUE(snapshot.write(++generation, KeySet(), first.view(), KeySet()));
+      TEST_ASSERT_EQUAL(1, snapshot.slot());
+    }
+    fill(crash.Offset, crash.Value, crash.Size);
+
+    Snapshot snapshot;
+    TEST_ASSERT_TRUE(snapshot.open());
+    TEST_ASSERT_EQUAL(0, snapshot.slot());
+    TEST_ASSERT_EQUAL_UINT32(generation - 1, snapshot.generation());
+    assertKeys(second, snapshot.keys());
+
+    // the next write goes to the damaged slot and wins again
+    TEST_ASSERT_TRUE(snapshot.write(++generation, KeySet(), second.view(), KeySet()));
+    Snapshot reopened;
+    TEST_ASSERT_TRUE(reopened.open());
+    TEST_ASSERT_EQUAL(1, reopened.slot());
+    TEST_ASSERT_EQUAL_UINT32(generation, reopened.generation());
+    assertKeys(second, reopened.keys());
+  }
+}
+
+
+//==============================================================================================================================================================
+// only the sectors the new generation occupies are erased, a set that does not fit leaves everything unchanged
+void test_erase_and_capacity()
+{
+  Snapshot snapshot;
+  snapshot.open();
+  fill(0, 0xA5, RegionSize);
+
+  Keys keys = randomKeys(2000, 0);   // 64 + 8000 bytes: two sectors
+  TEST_ASSERT_TRUE(snapshot.write(1, KeySet(), keys.view(), KeySet()));
+  TEST_ASSERT_EQUAL(0, snapshot.slot());
+  TEST_ASSERT_EQUAL_HEX8(0xFF, peek(64 + 8000));
+  TEST_ASSERT_EQUAL_HEX8(0xFF, peek(2 * FlashRegion::SectorSize - 1));
+  TEST_ASSERT_EQUAL_HEX8(0xA5, peek(2 * FlashRegion::SectorSize));
+  TEST_ASSERT_EQUAL_HEX8(0xA5, peek(SlotSize - 1));
+
+  std::vector<uint32_t> many(snapshot.capacity() / 4 + 1);
+  for (size_t i = 0; i < many.size(); ++i)
+  {
+    many[i] = static_cast<uint32_t>(i);
+  }
+  TEST_ASSERT_FALSE(snapshot.write(2, KeySet(), KeySet{many.data(), many.size(), nullptr, 0}, KeySet()));
+  TEST_ASSERT_TRUE(snapshot.write(2, KeySet(), KeySet{many.data(), many.size() - 1, nullptr, 0}, KeySet()));
+  TEST_ASSERT_EQUAL_size_t(many.size() - 1, snapshot.keys().size());
+
+  Snapshot reopened;
+  TEST_ASSERT_TRUE(reopened.open());
+  TEST_ASSERT_EQUAL_UINT32(2, reopened.generation());
+  TEST_ASSERT_TRUE(reopened.keys().contains(reinterpret_cast<uint8_t const*>("\x00\x00\x10\x00"), 4));
+}
+
+
+//==============================================================================================================================================================
+// a generation that is not newer than the active one is refused: taking effect now, it would be replaced by the older list after a reboot
+void test_stale_generation_rejected()
+{
+  Keys current = randomKeys(500, 20);
+  Keys revoked = randomKeys(600, 30);
+  {
+    Snapshot snapshot;
+    snapshot.open();
+    TEST_ASSERT_TRUE(snapshot.write(6, KeySet(), revoked.view(), KeySet()));
+    TEST_ASSERT_TRUE(snapshot.write(7, KeySet(), current.view(), KeySet()));
+
+    TEST_ASSERT_FALSE(snapshot.write(7, KeySet(), revoked.view(), KeySet()));
+    TEST_ASSERT_FALSE(snapshot.write(5, KeySet(), revoked.view(), KeySet()));
+    TEST_ASSERT_EQUAL_UINT32(7, snapshot.generation());
+    assertKeys(current, snapshot.keys());
+  }
+
+  Snapshot reopened;
+  TEST_ASSERT_TRUE(reopened.open());
+  TEST_ASSERT_EQUAL_UINT32(7, reopened.generation());
+  assertKeys(current, reopened.keys());
+
+  TEST_ASSERT_TRUE(reopened.write(8, KeySet(), revoked.view(), KeySet()));
+  Snapshot newer;
+  TEST_ASSERT_TRUE(newer.open());
+  TEST_ASSERT_EQUAL_UINT32(8, newer.generation());
+  assertKeys(revoked, newer.keys());
+}
+
+
+//==============================================================================================================================================================
+// every snapshot unmaps and closes its region again
+void test_region_released()
+{
+  auto descriptors = []
+  {
+    size_t count = 0;
+    for (int fd = 0; fd < 1024; ++fd)
+    {
+      count += (fcntl(fd, F_GETFD) != -1);
+    }
+    return count;
+  };
+
+  size_t before = descriptors();
+  for (uint32_t generation = 1; generation <= 200; ++generation)
+  {
+    Snapshot snapshot;
+    TEST_ASSERT_EQUAL(generation > 1, snapshot.open());
+    TEST_ASSERT_TRUE(snapshot.write(generation, KeySet(), KeySet(), KeySet()));
+  }
+  TEST_ASSERT_EQUAL_size_t(before, descriptors());
+}
+
+
+//==============================================================================================================================================================
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_region_has_no_generation);
+  RUN_TEST(test_incremental_updates_persist);
+  RUN_TEST(test_crash_leaves_previous_generation);
+  RUN_TEST(test_erase_and_capacity);
+  RUN_TEST(test_stale_generation_rejected);
+  RUN_TEST(test_region_released);
+  return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+#include "Delta/TimeSource.hpp"
+#include "Rtos/SpscQueue.hpp"
+#include "Rtos/Wakeup.hpp"
+#include "Stats/Histogram.hpp"
+
+using namespace dps;
+
+enum : uint32_t
+{
+  Items = 1000000,
+};
+
+static uint64_t now_us()
+{
+  return common::delta::MonotonicSource<1>::micros64();
+}
+
+// larger than a word, so a torn copy shows as fields that disagree
+struct Item
+{
+  uint32_t Seq;
+  uint32_t Check;
+  uint64_t Sent_us;
+};
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+void test_fill_and_overflow()
+{
+  rtos::SpscQueue<uint32_t, 4> queue;
+  uint32_t                     v;
+
+  TEST_ASSERT_FALSE(queue.pop(v));
+  for (uint32_t round = 0; round < 3; ++round)   // wraps around the ring
+  {
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+      TEST_ASSERT_TRUE(queue.push(10 * round + i));
+    }
+    TEST_ASSERT_FALSE(queue.push(99));
+    TEST_ASSERT_EQUAL(4, queue.size());
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+      TEST_ASSERT_TRUE(queue.pop(v));
+      TEST_ASSERT_EQUAL(10 * round + i, v);
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+  }
+  TEST_ASSERT_EQUAL(3, queue.overflows());
+}
+
+//==============================================================================================================================================================
+// two threads at full speed: every item arrives once, in order and intact; the producer retries on full, so nothing is dropped
+void test_threads_order_no_loss()
+{
+  rtos::SpscQueue<Item, 64> queue;
+  uint32_t                  retries = 0;
+
+  uint64_t    start = now_us();
+  std::thread producer([&]
+  {
+    for (uint32_t seq = 0; seq < Items; ++seq)
+    {
+      while (!queue.push({seq, ~seq, 0}))
+      {
+        ++retries;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t bad      = 0;
+  Item     item;
+  while (expected < Items)
+  {
+    if (!queue.pop(item))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    bad += (item.Seq != expected) || (item.Check != ~expected);
+    ++expected;
+  }
+  producer.join();
+  uint64_t elapsed_us = now_us() - start;
+
+  TEST_ASSERT_EQUAL(0, bad);
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_EQUAL(retries, queue.overflows());
+
+  char line[96];
+  snprintf(line, sizeof(line), "%u items in %u ms: %u items/s", static_cast<unsigned>(Items), static_cast<unsigned>(elapsed_us / 1000),
+           static_cast<unsigned>(Items * 1000000ull / (elapsed_us ? elapsed_us : 1)));
+  TEST_MESSAGE(line);
+}
+
+//==============================================================================================================================================================
+// producer -> sleeping consumer as in the firmware (push, then notify the Wakeup): time from push to pop, none lost
+void test_wakeup_latency()
+{
+  rtos::SpscQueue<Item, 16> queue;
+  rtos::Wakeup              wake;
+  stats::Histogram          latency;
+  std::atomic<bool>         done{false};
+
+  enum : uint32_t { Count = 2000 };
+
+  std::thread producer([&]
+  {
+    for (uint32_t seq = 0; seq < Count; ++seq)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      queue.push({seq, ~seq, now_us()});
+      wake.notify();
+    }
+    done = true;
+    wake.notify();
+  });
+
+  uint32_t expected = 0;
+  uint32_t bad      = 0;
+  while (!done || !queue.empty())
+  {
+    wake.wait(100);
+    Item item;
+    while (queue.pop(item))
+    {
+      latency.record(static_cast<uint32_t>(now_us() - item.Sent_us));
+      bad += (item.Seq != expected) || (item.Check != ~expected);
+      ++expected;
+    }
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL(Count, expected);
+  TEST_ASSERT_EQUAL(0, bad);
+  TEST_ASSERT_EQUAL(0, queue.overflows());
+
+  char line[96];
+  snprintf(line, sizeof(line), "push to pop: p50 %u us, p99 %u us, max %u us", static_cast<unsigned>(latency.percentile(500)),
+           static_cast<unsigned>(latency.percentile(990)), static_cast<unsigned>(latency.max()));
+  TEST_MESSAGE(line);
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_fill_and_overflow);
+  RUN_TEST(test_threads_order_no_loss);
+  RUN_TEST(test_wakeup_latency);
+  return UNITY_END();
+}
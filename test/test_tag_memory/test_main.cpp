@@ -0,0 +1,216 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Rfid/TagMemory.hpp"
+
+using namespace dps;
+using rfid::MemoryConfig;
+using rfid::Payload;
+
+enum : uint8_t { Ss = 5, Rst = 22, Irq = 21 };
+
+enum : uint32_t
+{
+  Exchange_us = 500,   // simulated air time per RF exchange ...
+  Byte_us     = 10,    // ... and per byte answered
+};
+
+static uint64_t now_us()
+{
+  return common::delta::MonotonicSource<1>::micros64();
+}
+
+// the tag selected as after its inventory
+static void select(MFRC522& pcd, mock::Tag const& tag)
+{
+  MFRC522::Uid uid = tag.Uid;
+  byte         atqa[2];
+  byte         size = sizeof(atqa);
+  TEST_ASSERT_EQUAL(MFRC522::STATUS_OK, pcd.PICC_WakeupA(atqa, &size));
+  TEST_ASSERT_EQUAL(MFRC522::STATUS_OK, pcd.PICC_Select(&uid, 8 * uid.size));
+}
+
+static MemoryConfig pages(uint8_t first, uint8_t count)
+{
+  return { first, count, MemoryConfig::NoSector, 0, {} };
+}
+
+static MemoryConfig sector(uint8_t number, std::initializer_list<uint8_t> keys)
+{
+  MemoryConfig config = { 0, 0, number, 0, {} };
+  for (uint8_t key : keys)
+  {
+    memset(config.Keys[config.NrKeys++].keyByte, key, MFRC522::MF_KEY_SIZE);
+  }
+  return config;
+}
+
+
+void setUp()
+{
+  mock::resetPins();
+  SPI.reset();
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// 15 pages: one FAST_READ exchange against four READs of 4 pages each; same data, the single exchange takes less air time
+void test_fast_read_vs_page_read()
+{
+  mock::Chip chip{ Ss, Rst, Irq };
+  MFRC522    pcd(Ss, Rst);
+  pcd.PCD_Init();
+  auto       tag = mock::Tag::ultralight(7);
+  chip.enter(tag);
+  chip.Exchange_us = Exchange_us;
+  chip.Byte_us     = Byte_us;
+
+  rfid::TagMemory<> memory;
+  memory.configure(pages(4, MemoryConfig::MaxPages));
+  select(pcd, tag);
+
+  Payload fast;
+  chip.Ops = {};
+  TEST_ASSERT_TRUE(memory.read(pcd, tag.Uid, fast));
+  TEST_ASSERT_EQUAL(4 * MemoryConfig::MaxPages, fast.Size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(tag.Memory.data() + 4 * 4, fast.Data, fast.Size);
+  TEST_ASSERT_EQUAL(1, chip.Ops.FastReads);
+  TEST_ASSERT_EQUAL(0, chip.Ops.Reads);
+
+  // the same pages by READ, 16 bytes each (the last one reads a page beyond the range)
+  uint8_t  data[4 * MemoryConfig::MaxPages + 12];
+  uint64_t start = now_us();
+  for (uint8_t page = 4, offset = 0; offset < 4 * MemoryConfig::MaxPages; page += 4, offset += 16)
+  {
+    byte buffer[18];
+    byte size = sizeof(buffer);
+    TEST_ASSERT_EQUAL(MFRC522::STATUS_OK, pcd.MIFARE_Read(page, buffer, &size));
+    memcpy(data + offset, buffer, 16);
+  }
+  uint32_t paged_us = static_cast<uint32_t>(now_us() - start);
+  TEST_ASSERT_EQUAL(4, chip.Ops.Reads);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(fast.Data, data, fast.Size);
+
+  TEST_ASSERT_GREATER_OR_EQUAL(Exchange_us + (fast.Size + 2) * Byte_us, fast.Read_us);
+  TEST_ASSERT_GREATER_OR_EQUAL(4 * (Exchange_us + 18 * Byte_us), paged_us);
+  TEST_ASSERT_LESS_THAN(paged_us, fast.Read_us);
+
+  char line[128];
+  snprintf(line, sizeof(line), "%u bytes: FAST_READ %u us (1 exchange), READ %u us (4 exchanges)", static_cast<unsigned>(fast.Size),
+           static_cast<unsigned>(fast.Read_us), static_cast<unsigned>(paged_us));
+  TEST_MESSAGE(line);
+}
+
+//==============================================================================================================================================================
+// an Ultralight without FAST_READ NAKs: nothing is read, the tag is selected again so it can still be halted
+void test_fast_read_unsupported()
+{
+  mock::Chip chip{ Ss, Rst, Irq };
+  MFRC522    pcd(Ss, Rst);
+  pcd.PCD_Init();
+  auto       tag = mock::Tag::ultralight(8);
+  tag.FastRead = false;
+  chip.enter(tag);
+
+  rfid::TagMemory<> memory;
+  memory.configure(pages(4, 4));
+  select(pcd, tag);
+
+  Payload payload;
+  TEST_ASSERT_TRUE(memory.read(pcd, tag.Uid, payload));
+  TEST_ASSERT_EQUAL(0, payload.Size);
+  TEST_ASSERT_EQUAL(1, memory.failed());
+  TEST_ASSERT_TRUE(chip.find(tag.Uid)->Now == mock::Tag::State::Active);
+}
+
+//==============================================================================================================================================================
+// the right key is the third candidate: the first read tries all three (two failed authentications, each with a reselection), the cache
+// makes every further read of the tag a single authentication
+void test_key_cache_single_auth()
+{
+  mock::Chip chip{ Ss, Rst, Irq };
+  MFRC522    pcd(Ss, Rst);
+  pcd.PCD_Init();
+  auto       tag = mock::Tag::classic(9);
+  chip.enter(tag);
+  chip.Exchange_us = Exchange_us;
+
+  rfid::TagMemory<> memory;
+  memory.configure(sector(2, { 0x11, 0x22, 0xFF }));
+
+  Payload first;
+  select(pcd, tag);
+  TEST_ASSERT_TRUE(memory.read(pcd, tag.Uid, first));
+  TEST_ASSERT_EQUAL(48, first.Size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(tag.Memory.data() + 8 * 16, first.Data, 48);
+  TEST_ASSERT_EQUAL(3, chip.Ops.Auths);
+  TEST_ASSERT_EQUAL(2, chip.Ops.AuthFailures);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    pcd.PICC_HaltA();
+    chip.Ops = {};
+    select(pcd, tag);
+
+    Payload again;
+    TEST_ASSERT_TRUE(memory.read(pcd, tag.Uid, again));
+    TEST_ASSERT_EQUAL(48, again.Size);
+    TEST_ASSERT_EQUAL(1, chip.Ops.Auths);
+    TEST_ASSERT_EQUAL(0, chip.Ops.AuthFailures);
+    TEST_ASSERT_EQUAL(3, chip.Ops.Reads);
+    TEST_ASSERT_LESS_THAN(first.Read_us, again.Read_us);
+  }
+}
+
+//==============================================================================================================================================================
+// the cache keeps the latest tags: with room for two, the first of three tags needs all candidates again
+void test_key_cache_eviction()
+{
+  mock::Chip chip{ Ss, Rst, Irq };
+  MFRC522    pcd(Ss, Rst);
+  pcd.PCD_Init();
+  mock::Tag  tags[] = { mock::Tag::classic(1), mock::Tag::classic(2), mock::Tag::classic(3) };
+
+  rfid::TagMemory<2> memory;
+  memory.configure(sector(1, { 0x11, 0xFF }));
+
+  auto auths = [&](mock::Tag const& tag)
+  {
+    chip.Field.clear();
+    chip.enter(tag);
+    chip.Ops = {};
+    select(pcd, tag);
+    Payload payload;
+    TEST_ASSERT_TRUE(memory.read(pcd, tag.Uid, payload));
+    TEST_ASSERT_EQUAL(48, payload.Size);
+    return chip.Ops.Auths;
+  };
+
+  TEST_ASSERT_EQUAL(2, auths(tags[0]));
+  TEST_ASSERT_EQUAL(2, auths(tags[1]));
+  TEST_ASSERT_EQUAL(1, auths(tags[0]));
+  TEST_ASSERT_EQUAL(2, auths(tags[2]));   // replaces tags[0]
+  TEST_ASSERT_EQUAL(1, auths(tags[1]));
+  TEST_ASSERT_EQUAL(2, auths(tags[0]));
+
+  // a new configuration drops the cache
+  memory.configure(sector(1, { 0x11, 0xFF }));
+  TEST_ASSERT_EQUAL(2, auths(tags[1]));
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_fast_read_vs_page_read);
+  RUN_TEST(test_fast_read_unsupported);
+  RUN_TEST(test_key_cache_single_auth);
+  RUN_TEST(test_key_cache_eviction);
+  return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <stdint.h>
+#include <random>
+#include <thread>
+#include <chrono>
+
+#include "Delta/TimeSource.hpp"
+
+// simulated hardware clock: free running µs counter, read in ms like MonotonicSource<1000>
+struct SimClock
+{
+  static inline uint64_t Us = 0;
+
+  static uint64_t now() { return Us / 1000; }
+};
+
+namespace common { namespace delta {
+template <>
+struct TimeBase<7>
+{
+  using TSource = SimClock;
+};
+} }
+
+#include "Delta/TimeDelta.hpp"
+#include "Delta/PeriodicTimer.hpp"
+#include "Delta/StartStopTimer.hpp"
+
+using namespace common::delta;
+
+enum : uint64_t
+{
+  Day_ms = 24ull * 3600 * 1000,
+};
+
+
+void setUp()
+{
+  SimClock::Us = 0;
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// loops of random length (1..45 ms, µs granularity) for three days, starting one day before the 32 bit ms counter wraps
+void test_periodic_timer_no_drift_over_days()
+{
+  const uint64_t start_ms = (1ull << 32) - Day_ms;
+  SimClock::Us = start_ms * 1000;
+
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<uint32_t> loop_us(1000, 45000);
+
+  PeriodicTimer<7> second(1000);
+  uint64_t fired = 0;
+  while (SimClock::now() - start_ms < 3 * Day_ms)
+  {
+    SimClock::Us += loop_us(rng);
+    if (second())
+    {
+      ++fired;
+      TEST_ASSERT_LESS_THAN_UINT64(45, SimClock::now() - start_ms - fired * 1000);   // at most one loop late, no lag builds up
+    }
+  }
+
+  TEST_ASSERT_EQUAL_UINT64((SimClock::now() - start_ms) / 1000, fired);
+}
+
+
+//==============================================================================================================================================================
+// a ticked base fed with the real elapsed time is just as drift free, and its 64 bit counter does not wrap
+void test_tick_source_no_drift_over_days()
+{
+  using Clock = TimeDelta<8>;
+  const uint64_t start = Clock::now();
+
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<uint32_t> loop_ms(1, 45);
+
+  PeriodicTimer<8> minute(60000);
+  uint64_t fired = 0, elapsed = 0;
+  while (elapsed < 60 * Day_ms)
+  {
+    auto step = loop_ms(rng);
+    Clock::tick(step);
+    elapsed += step;
+    if (minute())
+      ++fired;
+  }
+
+  TEST_ASSERT_EQUAL_UINT64(start + elapsed, Clock::now());
+  TEST_ASSERT_GREATER_THAN_UINT64(1ull << 32, Clock::now());
+  TEST_ASSERT_EQUAL_UINT64(elapsed / 60000, fired);
+}
+
+
+//==============================================================================================================================================================
+// tick() from two threads at once loses no increments
+void test_tick_source_concurrent_ticks()
+{
+  using Clock = TimeDelta<9>;
+  enum { Ticks = 1000000 };
+  const uint64_t start = Clock::now();
+
+  auto ticker = [] { for (int i = 0; i < Ticks; ++i) Clock::tick(1); };
+  std::thread a(ticker), b(ticker);
+  a.join();
+  b.join();
+
+  TEST_ASSERT_EQUAL_UINT64(start + 2 * Ticks, Clock::now());
+}
+
+
+//==============================================================================================================================================================
+// a late call restarts the next interval in phase, skipped intervals are not caught up
+void test_periodic_timer_late_call_keeps_phase()
+{
+  PeriodicTimer<7> timer(100);
+
+  SimClock::Us = 130 * 1000;
+  TEST_ASSERT_TRUE(timer());
+  TEST_ASSERT_EQUAL_UINT32(70, timer.remaining());
+
+  SimClock::Us = 450 * 1000;
+  TEST_ASSERT_TRUE(timer());
+  TEST_ASSERT_FALSE(timer());
+  TEST_ASSERT_EQUAL_UINT32(50, timer.remaining());
+}
+
+
+//==============================================================================================================================================================
+void test_start_stop_timer_one_shot()
+{
+  StartStopTimer<7> timer;
+  TEST_ASSERT_FALSE(timer.running());
+
+  timer.start(250);
+  SimClock::Us = 249 * 1000;
+  TEST_ASSERT_FALSE(timer());
+  SimClock::Us = 250 * 1000;
+  TEST_ASSERT_TRUE(timer());
+  TEST_ASSERT_FALSE(timer.running());
+  SimClock::Us = 1000 * 1000;
+  TEST_ASSERT_TRUE(timer());   // stays expired until restarted
+  TEST_ASSERT_EQUAL_UINT32(Deadline::Never, timer.remaining());
+}
+
+
+//==============================================================================================================================================================
+// the default base runs on the real monotonic clock, no tick() needed
+void test_monotonic_base_measures_real_time()
+{
+  TimeDelta<> delta;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  TEST_ASSERT_UINT32_WITHIN(50, 100, *delta);
+}
+
+
+//==============================================================================================================================================================
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_periodic_timer_no_drift_over_days);
+  RUN_TEST(test_tick_source_no_drift_over_days);
+  RUN_TEST(test_tick_source_concurrent_ticks);
+  RUN_TEST(test_periodic_timer_late_call_keeps_phase);
+  RUN_TEST(test_start_stop_timer_one_shot);
+  RUN_TEST(test_monotonic_base_measures_real_time);
+  return UNITY_END();
+}
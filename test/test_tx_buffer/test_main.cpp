@@ -0,0 +1,97 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+
+#include "Protocol/TxBuffer.hpp"
+
+using namespace dps::protocol;
+
+static HardwareSerial Port;
+
+
+void setUp()
+{
+  Port.reset();
+  Port.TxSize = 128;
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// whole messages only: a message without room is dropped and counted, the committed ones are kept; once drained there is room again
+void test_dropped_when_full()
+{
+  TxBuffer<16> tx;
+
+  tx.write("0123456789");
+  TEST_ASSERT_TRUE(tx.commit());
+  tx.write("abcdefgh");
+  TEST_ASSERT_FALSE(tx.commit());
+  TEST_ASSERT_EQUAL(1, tx.dropped());
+  TEST_ASSERT_EQUAL(0, tx.oversized());
+  TEST_ASSERT_EQUAL(10, tx.size());
+
+  tx.drain(Port);
+  TEST_ASSERT_EQUAL_STRING("0123456789", Port.take().c_str());
+  tx.write("abcdefgh");
+  TEST_ASSERT_TRUE(tx.commit());
+  tx.drain(Port);
+  TEST_ASSERT_EQUAL_STRING("abcdefgh", Port.take().c_str());
+  TEST_ASSERT_EQUAL(10, tx.peak());
+}
+
+//==============================================================================================================================================================
+// a message larger than the buffer can never be sent: counted apart, also when written in pieces or rejected by its writer
+void test_oversized()
+{
+  TxBuffer<16> tx;
+
+  tx.write("0123456789abcdefg");
+  TEST_ASSERT_FALSE(tx.commit());
+  for (int i = 0; i < 5; ++i)
+  {
+    tx.write("0123");
+  }
+  TEST_ASSERT_FALSE(tx.commit());
+  TEST_ASSERT_EQUAL(2, tx.oversized());
+  TEST_ASSERT_EQUAL(0, tx.dropped());
+  TEST_ASSERT_TRUE(tx.empty());
+
+  tx.write("ab");
+  tx.reject();
+  TEST_ASSERT_EQUAL(3, tx.oversized());
+  TEST_ASSERT_TRUE(tx.empty());
+
+  tx.write("ok");
+  TEST_ASSERT_TRUE(tx.commit());
+  TEST_ASSERT_EQUAL(2, tx.size());
+}
+
+//==============================================================================================================================================================
+// the echo committed on its own: a full buffer costs the reply, the echo before it is still sent
+void test_echo_and_reply_apart()
+{
+  TxBuffer<16> tx;
+
+  tx.write("cmd\n");
+  TEST_ASSERT_TRUE(tx.commit());
+  tx.write("a reply too long\n");
+  TEST_ASSERT_FALSE(tx.commit());
+  TEST_ASSERT_EQUAL(1, tx.oversized());
+
+  tx.drain(Port);
+  TEST_ASSERT_EQUAL_STRING("cmd\n", Port.take().c_str());
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_dropped_when_full);
+  RUN_TEST(test_oversized);
+  RUN_TEST(test_echo_and_reply_apart);
+  return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <atomic>
+#include <random>
+#include <thread>
+
+#include "Delta/Deadline.hpp"
+#include "Delta/PeriodicTimer.hpp"
+#include "Delta/TimeSource.hpp"
+#include "Rtos/SpscQueue.hpp"
+#include "Rtos/Wakeup.hpp"
+#include "Stats/Histogram.hpp"
+
+using namespace dps;
+using common::delta::Deadline;
+
+enum : uint32_t
+{
+  Events      = 100,
+  Polling_ms  = 10,    // the former fixed loop delay
+  MaxSleep_ms = 1000,
+  Frame_ms    = 50,    // something periodic in the loop, e.g. an LED effect
+};
+
+static uint64_t now_us()
+{
+  return common::delta::MonotonicSource<1>::micros64();
+}
+
+// events (UART RX, tag, PIR edge) at random times, stamped when they happen
+struct Source
+{
+  void run(rtos::Wakeup& wake)
+  {
+    std::mt19937 rng(7);
+    for (uint32_t i = 0; i < Events; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(3000 + rng() % 47000));
+      Stamps.push(now_us());
+      wake.notify();
+    }
+    Done = true;
+    wake.notify();
+  }
+
+  rtos::SpscQueue<uint64_t, 64> Stamps;
+  std::atomic<bool>             Done{false};
+};
+
+struct Result
+{
+  stats::Histogram Latency;
+  uint32_t         Wakeups = 0;
+  uint32_t         Frames  = 0;
+};
+
+static void report(char const* name, Result const& r)
+{
+  char line[128];
+  snprintf(line, sizeof(line), "%-8s event to response: p50 %5u us, p99 %5u us, max %5u us; %u wakeups for %u events", name,
+           static_cast<unsigned>(r.Latency.percentile(500)), static_cast<unsigned>(r.Latency.percentile(990)),
+           static_cast<unsigned>(r.Latency.max()), static_cast<unsigned>(r.Wakeups), static_cast<unsigned>(Events));
+  TEST_MESSAGE(line);
+}
+
+static void respond(Source& source, Result& r)
+{
+  uint64_t stamp;
+  while (source.Stamps.pop(stamp))
+  {
+    r.Latency.record(static_cast<uint32_t>(now_us() - stamp));
+  }
+}
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// the same events answered by the former loop (work, then delay(Polling_ms)) and by the deadline loop (sleep until the next due time or an
+// event): the deadline loop answers within scheduling latency instead of half a poll period on average, and wakes up only when needed
+void test_deadline_vs_fixed_poll()
+{
+  Result polled;
+  {
+    rtos::Wakeup wake;
+    Source       source;
+    std::thread  events([&] { source.run(wake); });
+    common::delta::PeriodicTimer<> frame(Frame_ms);
+
+    while (!source.Done || !source.Stamps.empty())
+    {
+      ++polled.Wakeups;
+      respond(source, polled);
+      polled.Frames += frame();
+      delay(Polling_ms);
+    }
+    events.join();
+  }
+
+  Result scheduled;
+  {
+    rtos::Wakeup wake;
+    Source       source;
+    std::thread  events([&] { source.run(wake); });
+    common::delta::PeriodicTimer<> frame(Frame_ms);
+
+    while (!source.Done || !source.Stamps.empty())
+    {
+      respond(source, scheduled);
+      scheduled.Frames += frame();
+
+      Deadline next(MaxSleep_ms);
+      next.at(frame.remaining());
+      wake.wait(next.remaining());
+      ++scheduled.Wakeups;
+    }
+    events.join();
+  }
+
+  report("poll", polled);
+  report("deadline", scheduled);
+
+  TEST_ASSERT_EQUAL(Events, polled.Latency.count());
+  TEST_ASSERT_EQUAL(Events, scheduled.Latency.count());
+  TEST_ASSERT_LESS_THAN(polled.Latency.percentile(500), scheduled.Latency.percentile(990));
+  TEST_ASSERT_LESS_THAN(polled.Wakeups, scheduled.Wakeups);
+  TEST_ASSERT_TRUE(scheduled.Frames + 2 >= polled.Frames);   // periodic work keeps its pace
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_deadline_vs_fixed_poll);
+  return UNITY_END();
+}
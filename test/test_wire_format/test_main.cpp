@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Delta/TimeSource.hpp"
+#include "Protocol/Frame.hpp"
+#include "Protocol/Hex.hpp"
+
+using namespace dps;
+
+using JsonDoc = ArduinoJson::StaticJsonDocument<512>;
+
+enum : uint32_t
+{
+  Rounds     = 20000,
+  LineLength = 512,
+  Baud       = 115200,
+};
+
+static uint64_t now_us()
+{
+  return common::delta::MonotonicSource<1>::micros64();
+}
+
+// a message as written to the TX buffer
+class Sink : public Print
+{
+public:
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(uint8_t const* data, size_t size) override
+  {
+    size = (size < sizeof(Data) - Size) ? size : (sizeof(Data) - Size);
+    memcpy(Data + Size, data, size);
+    Size += size;
+    return size;
+  }
+  using Print::write;
+
+  uint8_t Data[LineLength];
+  size_t  Size = 0;
+};
+
+static uint8_t const Uid[] = { 0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6 };
+static uint8_t const Sak   = 0x08;
+
+// an arrival as App::handleUid builds it: hex strings in JSON mode, sak as number and uid as bin8 in binary mode
+static void event(JsonDoc& doc, bool binary)
+{
+  doc.clear();
+  doc["action"]   = "event";
+  doc["state"]    = "arrived";
+  doc["decision"] = "pass";
+  doc["reader"]   = "inside";
+  doc["dt"]       = 1234567890ull;
+  doc["t"]        = 1700000000123456ull;
+
+  auto tag = doc.createNestedObject("tag");
+  if (binary)
+  {
+    char bin[2 + sizeof(Uid)] = { static_cast<char>(0xC4), static_cast<char>(sizeof(Uid)) };
+    memcpy(bin + 2, Uid, sizeof(Uid));
+    tag["sak"] = Sak;
+    tag["uid"] = ArduinoJson::serialized(static_cast<char*>(bin), sizeof(bin));
+  }
+  else
+  {
+    char sak[protocol::hex::encodedSize(sizeof(Sak))];
+    char uid[protocol::hex::encodedSize(sizeof(Uid))];
+    protocol::hex::encode(&Sak, sizeof(Sak), sak);
+    protocol::hex::encode(Uid, sizeof(Uid), uid);
+    tag["sak"] = static_cast<char*>(sak);
+    tag["uid"] = static_cast<char*>(uid);
+  }
+}
+
+// as App::send: JSON line or MessagePack frame
+static void encode(JsonDoc const& doc, bool binary, protocol::FrameWriter<LineLength>& frames, Sink& out)
+{
+  out.Size = 0;
+  if (binary)
+  {
+    frames.send(serializeMsgPack(doc, frames.payload(), frames.capacity()), out);
+  }
+  else
+  {
+    out.Size  = serializeJson(doc, reinterpret_cast<char*>(out.Data), sizeof(out.Data) - 1);
+    out.Data[out.Size++] = '\n';
+  }
+}
+
+static void report(char const* what, char const* mode, size_t bytes, uint64_t elapsed_us)
+{
+  char line[128];
+  snprintf(line, sizeof(line), "%-6s %-7s %3u bytes (%5u us at %u baud), %6u ns each", what, mode, static_cast<unsigned>(bytes),
+           static_cast<unsigned>(bytes * 10 * 1000000ull / Baud), static_cast<unsigned>(Baud),
+           static_cast<unsigned>(elapsed_us * 1000 / Rounds));
+  TEST_MESSAGE(line);
+}
+
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+
+//==============================================================================================================================================================
+// a tag event built and encoded as the device sends it: bytes on the wire and encode time per mode
+void test_event_encode()
+{
+  static protocol::FrameWriter<LineLength> frames;
+  JsonDoc doc;
+  Sink    out;
+  size_t  bytes[2];
+
+  for (int binary = 0; binary < 2; ++binary)
+  {
+    uint64_t start = now_us();
+    for (uint32_t i = 0; i < Rounds; ++i)
+    {
+      event(doc, binary);
+      encode(doc, binary, frames, out);
+    }
+    uint64_t elapsed_us = now_us() - start;
+    bytes[binary]       = out.Size;
+    report("event", binary ? "binary" : "json", out.Size, elapsed_us);
+  }
+
+  // the frame checks out and holds the raw UID
+  TEST_ASSERT_EQUAL(0, out.Data[out.Size - 1]);
+  size_t payload = protocol::unframe(out.Data, out.Size - 1);
+  TEST_ASSERT_TRUE(payload > 0);
+  uint8_t const bin[] = { 0xC4, sizeof(Uid) };
+  uint8_t const* at   = static_cast<uint8_t const*>(memmem(out.Data, payload, bin, sizeof(bin)));
+  TEST_ASSERT_NOT_NULL(at);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(Uid, at + 2, sizeof(Uid));
+
+  TEST_ASSERT_LESS_THAN(bytes[0], bytes[1]);
+}
+
+//==============================================================================================================================================================
+// a command as the device receives it: decode time per mode (the line/frame is parsed in place, so it is restored for every round)
+void test_command_decode()
+{
+  static protocol::FrameWriter<LineLength> frames;
+  JsonDoc doc;
+  doc["action"] = "set";
+  doc["fx"]     = "pass";
+  doc["seq"]    = 17;
+
+  for (int binary = 0; binary < 2; ++binary)
+  {
+    Sink wire;
+    encode(doc, binary, frames, wire);
+    size_t length = wire.Size - 1;   // without the delimiter, as LineReader hands it out
+
+    char     line[LineLength];
+    JsonDoc  msg;
+    uint32_t ok    = 0;
+    uint64_t start = now_us();
+    for (uint32_t i = 0; i < Rounds; ++i)
+    {
+      memcpy(line, wire.Data, length);
+      ArduinoJson::DeserializationError error;
+      if (binary)
+      {
+        size_t payload = protocol::unframe(reinterpret_cast<uint8_t*>(line), length);
+        error          = deserializeMsgPack(msg, line, payload);
+      }
+      else
+      {
+        error = deserializeJson(msg, line, length);
+      }
+      ok += (error == ArduinoJson::DeserializationError::Ok) && (msg["seq"] == 17);
+    }
+    uint64_t elapsed_us = now_us() - start;
+
+    TEST_ASSERT_EQUAL(Rounds, ok);
+    report("set", binary ? "binary" : "json", wire.Size, elapsed_us);
+  }
+}
+
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_event_encode);
+  RUN_TEST(test_command_decode);
+  return UNITY_END();
+}
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Pipeline numbered commands to a DoorPiSupport device and check the acks.
+
+Sends `count` {"action":"set",...,"seq":n} commands in JSON mode, keeping as many in flight as the advertised
+credit allows, and verifies that every seq is acknowledged exactly once and in order. Echo is switched off first.
+
+    python3 tools/pipeline.py /dev/ttyUSB0 -n 5000
+
+The same check runs against the firmware on the host, over a pty, in test/test_pipeline.
+"""
+
+import argparse
+import json
+import os
+import termios
+import time
+import tty
+
+# before the first ack arrives: UART RX buffer of the firmware defaults
+INITIAL_CREDIT = 1024
+
+
+def open_port(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud)
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def lines(fd):
+    """Yield complete lines as JSON objects; skips anything else (e.g. a partial line received before the port was opened)."""
+    pending = b""
+    while True:
+        chunk = os.read(fd, 4096)
+        pending += chunk
+        while b"\n" in pending:
+            line, pending = pending.split(b"\n", 1)
+            start = line.find(b"{")
+            if start < 0:
+                continue
+            try:
+                yield json.loads(line[start:])
+            except ValueError:
+                continue
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial port or pty of the device")
+    parser.add_argument("-n", "--count", type=int, default=1000, help="number of commands (default: 1000)")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    fd = open_port(args.port, args.baud)
+    os.write(fd, b'{"action":"set","echo":false}\n')
+    time.sleep(0.2)
+    termios.tcflush(fd, termios.TCIFLUSH)
+
+    commands = [(json.dumps({"action": "set", "bright": n % 256, "seq": n}, separators=(",", ":")) + "\n").encode()
+                for n in range(args.count)]
+    sizes = {}
+    credit = INITIAL_CREDIT
+    in_flight = 0
+    sent = 0
+    expected = 0
+    nacks = 0
+    worst_us = 0
+    replies = lines(fd)
+    start = time.monotonic()
+
+    while expected < args.count:
+        # bytes after the last acknowledged command must stay within the credit
+        while sent < args.count and in_flight + len(commands[sent]) <= credit:
+            os.write(fd, commands[sent])
+            sizes[sent] = len(commands[sent])
+            in_flight += len(commands[sent])
+            sent += 1
+
+        reply = next(replies)
+        if reply.get("action") not in ("ack", "nack"):
+            continue
+        seq = reply["seq"]
+        if seq != expected:
+            raise SystemExit("out of order: expected seq %d, got %d" % (expected, seq))
+        if reply["action"] == "nack":
+            nacks += 1
+        in_flight -= sizes.pop(seq)
+        credit = reply["credit"]
+        worst_us = max(worst_us, reply["us"])
+        expected += 1
+
+    elapsed = time.monotonic() - start
+    print("%d commands in %.2f s: %.0f cmd/s, %d nacks, worst processing time %d us"
+          % (args.count, elapsed, args.count / elapsed, nacks, worst_us))
+
+
+if __name__ == "__main__":
+    main()
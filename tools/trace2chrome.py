@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Convert a DoorPiSupport trace dump into Chrome/Perfetto trace-event JSON.
+
+Capture the serial output after sending {"action":"trace"} (build the firmware with -D DPS_TRACE=1), e.g.
+
+    python3 tools/trace2chrome.py capture.bin -o trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+PHASES = {0: "B", 1: "E", 2: "i"}
+ISR = 0x7F
+
+
+def find_dump(data):
+    """Return (header, records) of the last trace dump in a raw serial capture."""
+    start = data.rfind(b'{"action":"trace"')
+    if start < 0:
+        raise SystemExit("no trace header found in capture")
+    end = data.index(b"\n", start)
+    header = json.loads(data[start:end].decode("ascii"))
+    if not header.get("enabled", False):
+        raise SystemExit("firmware was built without DPS_TRACE")
+    size = header["size"]
+    payload = data[end + 1:end + 1 + header["n"] * size]
+    if len(payload) != header["n"] * size:
+        raise SystemExit("capture is truncated: expected %d record bytes, got %d" % (header["n"] * size, len(payload)))
+    return header, payload
+
+
+def task_names(header):
+    """Track names by task index: the tasks announced in the header, interrupts and the shared index of surplus tasks."""
+    names = {index: name for index, name in enumerate(header.get("tasks", []))}
+    names[ISR] = "isr"
+    names.setdefault(len(header.get("tasks", [])), "other")
+    return names
+
+
+def convert(header, payload):
+    ids = header["ids"]
+    size = header["size"]
+    names = task_names(header)
+    events = []
+    tasks = set()
+    offset = 0
+    previous = None
+    for pos in range(0, len(payload), size):
+        time_us, ident, kind, task, arg = struct.unpack_from("<IBBBB", payload, pos)
+        core, task = task >> 7, task & 0x7F
+        # unwrap the 32 bit microsecond clock (~71 min period)
+        if previous is not None and time_us + offset < previous - (1 << 31):
+            offset += 1 << 32
+        time_us += offset
+        previous = time_us
+
+        event = {
+            "name": ids[ident] if ident < len(ids) else "id%d" % ident,
+            "ph": PHASES.get(kind, "i"),
+            "ts": time_us,
+            "pid": 0,
+            "tid": task,
+            "args": {"core": core},
+        }
+        if event["ph"] == "i":
+            event["s"] = "t"
+        if arg:
+            event["args"]["arg"] = arg
+        events.append(event)
+        tasks.add(task)
+
+    events.sort(key=lambda e: e["ts"])
+    # one track per task: tasks sharing a core are time-sliced, their spans must not interleave on one track
+    for task in sorted(tasks):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": task, "args": {"name": names.get(task, "task%d" % task)}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="raw serial capture containing a trace dump ('-' for stdin)")
+    parser.add_argument("-o", "--output", help="output file (default: stdout)")
+    args = parser.parse_args()
+
+    data = sys.stdin.buffer.read() if args.capture == "-" else open(args.capture, "rb").read()
+    trace = convert(*find_dump(data))
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out)
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()